@@ -0,0 +1,93 @@
+#ifndef RDEBUG_BENCH_H
+#define RDEBUG_BENCH_H
+/**
+ * Project "rDebug"
+ *
+ * rDebug_Bench.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QDateTime>
+#include <stdint.h>
+
+#include <benchmark/benchmark.h>
+
+#include "../src/rDebug.h"
+
+
+// -----------------------
+// helpers shared by the rDebug_*Bench.cpp files.
+// usage:
+//    rDebug_BenchAllocs Allocs( state );   // before the timing loop
+//    for( auto _ : state ) { ... }
+//    Allocs.report();                      // adds the "allocs/line" counter
+// note:
+//    the allocations are counted by rDebug_BenchMain.cpp. With glibc, malloc() itself is counted, so
+//    QString/QByteArray buffers are part of it. Elsewhere, only operator new is seen.
+// -----------------------
+quint64 benchAllocations();
+
+class rDebug_BenchAllocs
+{
+public:
+  explicit rDebug_BenchAllocs( benchmark::State& State ) : mState(State), mStart( benchAllocations() ) {}
+  void report()
+  {
+    if( mState.thread_index() != 0 ) // the counter is process wide, so thread 0 reports for all
+      return;
+    mState.counters["allocs/line"] = benchmark::Counter( static_cast<double>( benchAllocations() - mStart ),
+                                                         benchmark::Counter::kAvgIterations );
+  }
+private:
+  benchmark::State& mState;
+  const quint64     mStart;
+};
+
+
+
+// -----------------------
+// a slot, just counting the lines it got from rDebug_Signaller
+// -----------------------
+class rDebug_BenchReceiver : public QObject
+{
+  Q_OBJECT
+public:
+  rDebug_BenchReceiver() : mLines(0) {}
+  int lines() { return mLines.fetchAndAddOrdered(0); }
+
+public slots:
+  void on_logline( const FileLineFunc_t& CodeLocation, const QDateTime& Time, int Level, uint64_t LogId, const QString& line )
+  {
+    Q_UNUSED(CodeLocation); Q_UNUSED(Time); Q_UNUSED(Level); Q_UNUSED(LogId); Q_UNUSED(line);
+    mLines.ref();
+  }
+
+private:
+  QAtomicInt mLines;
+};
+
+#endif // RDEBUG_BENCH_H
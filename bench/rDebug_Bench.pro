@@ -0,0 +1,57 @@
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which as been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# Google Benchmark, https://github.com/google/benchmark (Debian/Ubuntu: libbenchmark-dev)
+# results as JSON: ./rDebug_Bench --benchmark_out=rDebug_Bench.json --benchmark_out_format=json
+# see about_this_bench.txt
+LIBS += -lbenchmark -lpthread
+
+include( ../src/rDebugZlib.pri ) # gzip frames of the file sink, "qmake CONFIG+=nozlib" builds without
+
+SOURCES += rDebug_BenchMain.cpp \
+    rDebug_LineBench.cpp \
+    rDebug_FormatBench.cpp \
+    rDebug_Utf8Bench.cpp \
+    rDebug_TraceBench.cpp \
+    rDebug_FileIoBench.cpp \
+    ../src/rDebug.cpp \
+    ../src/rDebugPattern.cpp \
+    ../src/rDebugRecord.cpp \
+    ../src/rDebugRecordQt.cpp \
+    ../src/rDebugStats.cpp \
+    ../src/rDebugMetrics.cpp \
+    ../src/rDebugTrace.cpp \
+    ../src/rDebugConfig.cpp \
+    ../src/rDebugFileIo.cpp \
+    ../src/rDebugRetention.cpp \
+    ../src/rDebugSeekIndex.cpp \
+    ../src/rDebugCore.cpp
+
+HEADERS += \
+    rDebug_Bench.h \
+    ../src/rDebug.h \
+    ../src/rDebugCodeloc.h \
+    ../src/rDebugLevel.h \
+    ../src/rDebugJson.h \
+    ../src/rDebugPattern.h \
+    ../src/rDebugRecord.h \
+    ../src/rDebugFormat.h \
+    ../src/rDebugUtf8.h \
+    ../src/rDebugStats.h \
+    ../src/rDebugMetrics.h \
+    ../src/rDebugTrace.h \
+    ../src/rDebugConfig.h \
+    ../src/rDebugRing.h \
+    ../src/rDebugFileIo.h \
+    ../src/rDebugRetention.h \
+    ../src/rDebugSeekIndex.h \
+    ../src/rDebugCore.h \
+    ../src/rDebugFmt.h
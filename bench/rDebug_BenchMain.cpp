@@ -0,0 +1,101 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_BenchMain.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// main() of rDebug_Bench, instead of the one from libbenchmark_main, because the Signaller
+// benchmarks need a QCoreApplication. Also the process wide allocation counter lives here.
+//    ./rDebug_Bench --benchmark_out=rDebug_Bench.json --benchmark_out_format=json
+
+#include <QCoreApplication>
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+#include <benchmark/benchmark.h>
+
+#include "rDebug_Bench.h"
+
+
+static std::atomic<unsigned long long> Allocations( 0 );
+
+quint64 benchAllocations()
+{
+  return Allocations.load( std::memory_order_relaxed );
+}
+
+
+#if defined(__GLIBC__)
+// count every malloc() of the process, Qt's containers don't use operator new
+extern "C" void* __libc_malloc( size_t size );
+extern "C" void* __libc_calloc( size_t count, size_t size );
+extern "C" void* __libc_realloc( void* ptr, size_t size );
+
+extern "C" void* malloc( size_t size )
+{
+  Allocations.fetch_add( 1, std::memory_order_relaxed );
+  return __libc_malloc( size );
+}
+
+extern "C" void* calloc( size_t count, size_t size )
+{
+  Allocations.fetch_add( 1, std::memory_order_relaxed );
+  return __libc_calloc( count, size );
+}
+
+extern "C" void* realloc( void* ptr, size_t size )
+{
+  Allocations.fetch_add( 1, std::memory_order_relaxed );
+  return __libc_realloc( ptr, size );
+}
+#else
+void* operator new( size_t size )
+{
+  Allocations.fetch_add( 1, std::memory_order_relaxed );
+  if( void* ptr = malloc( size ? size : 1 ) )
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  free( ptr );
+}
+#endif
+
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+
+  benchmark::Initialize( &argc, argv );
+  if( benchmark::ReportUnrecognizedArguments( argc, argv ) )
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
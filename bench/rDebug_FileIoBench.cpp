@@ -0,0 +1,222 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_FileIoBench.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// the file back-ends of rDebugFileIo against each other: QFile, pwritev and io_uring.
+//    ./rDebug_Bench --benchmark_filter=FileIo
+// FileIo_Append       : rDebugFileIo alone, lines of 100 bytes, submitted per line (Arg 1) or per 256 lines
+// FileIo_LineAsync    : whole log statements into rDebug_Filewriter via rDebug_AsyncWriter, as the sink is used
+// FileIo_Durability   : whole statements written directly, with each rDebug_Filewriter::Durability
+// FileIo_GroupCommit  : Synced lines from 1..16 threads, the fdatasync() calls are shared
+// FileIo_Compression  : rDebugFileIo with and without gzip frames, lines like the classic layout
+// FileIo_DSyncOrder   : a Flushed and a DSynced line in turn, checks that nothing is left unsynced in front of the DSynced one
+
+#include <QString>
+#include <QDir>
+#include <QFile>
+
+#include <benchmark/benchmark.h>
+
+#include "rDebug_Bench.h"
+#include "../src/rDebugFileIo.h"
+#include "../src/rDebugStats.h"
+
+
+static QString benchIoFile()
+{
+  return QDir::tempPath() + "/rDebug_Bench.io.log";
+}
+
+
+static void BM_FileIo_Append( benchmark::State& state )
+{
+  const rDebugFileIo::Backend Wanted = static_cast<rDebugFileIo::Backend>( state.range(0) );
+  const int LinesPerSubmit = static_cast<int>( state.range(1) );
+  QByteArray Line( 99, 'x' );
+  Line += '\n';
+
+  QFile::remove( benchIoFile() );
+  rDebugFileIo File;
+  File.open( benchIoFile(), Wanted );
+  int n = 0;
+  for( auto _ : state )
+  {
+    File.append( Line );
+    if( ++n == LinesPerSubmit )
+    { File.submit();
+      n = 0;
+    }
+  }
+  File.close(); // waits for the writes in flight, part of the work
+  state.SetBytesProcessed( state.iterations() * Line.size() );
+  state.SetLabel( rDebugFileIo::name( File.backend() ) );
+  QFile::remove( benchIoFile() );
+}
+BENCHMARK( BM_FileIo_Append )->ArgsProduct( { { rDebugFileIo::QtFile, rDebugFileIo::Pwritev, rDebugFileIo::IoUring }, { 1, 256 } } );
+
+
+static void BM_FileIo_Compression( benchmark::State& state )
+{
+  const rDebugFileIo::Compression Mode = static_cast<rDebugFileIo::Compression>( state.range(0) );
+  QFile::remove( benchIoFile() );
+  rDebugFileIo File;
+  File.setCompression( Mode );
+  File.open( benchIoFile(), rDebugFileIo::Pwritev );
+  qint64 Bytes = 0;
+  int n = 0;
+  for( auto _ : state )
+  {
+    const QByteArray Line = "2026-10-18 14:03:12," + QByteArray::number( n % 1000 ).rightJustified( 3, '0' )
+                          + " [Info] 4711 [worker:" + QByteArray::number( n % 7 ) + " #" + QByteArray::number( n )
+                          + "], order " + QByteArray::number( n * 31 ) + " accepted {from submit in shop.cpp:" + QByteArray::number( 100 + n % 50 ) + "}\n";
+    File.append( Line );
+    Bytes += Line.size();
+    if( ++n % 256 == 0 )
+      File.submit();
+  }
+  File.close(); // the last frame
+  state.SetBytesProcessed( Bytes );
+  state.counters["ratio"] = File.size() ? static_cast<double>( Bytes ) / static_cast<double>( File.size() ) : 0.0;
+  state.SetLabel( ( File.compression() == rDebugFileIo::Gzip ) ? "gzip" : "plain" );
+  QFile::remove( benchIoFile() );
+}
+BENCHMARK( BM_FileIo_Compression )->Arg( rDebugFileIo::Plain )->Arg( rDebugFileIo::Gzip );
+
+
+static void BM_FileIo_LineAsync( benchmark::State& state )
+{
+  const rDebugFileIo::Backend Wanted = static_cast<rDebugFileIo::Backend>( state.range(0) );
+  rDebug_GlobalLevel::set( rDebugLevel::rMsgType::All );
+  rDebugBase::setMaxLevel( rDebugLevel::rMsgType::Silent );
+  QFile::remove( benchIoFile() );
+  {
+    rDebug_Filewriter  rLogFile( benchIoFile(), rDebugLevel::rMsgType::All, 1, 0x40000000 );
+    rLogFile.setIoBackend( Wanted );
+    rDebug_AsyncWriter rLogAsync;
+
+    int i = 0;
+    for( auto _ : state )
+    {
+      rInfo() << "file line" << ++i << "of" << 2.5;
+    }
+    rLogAsync.flush();
+    state.SetLabel( rDebugFileIo::name( rLogFile.ioBackend() ) );
+  }
+  state.SetItemsProcessed( state.iterations() );
+  QFile::remove( benchIoFile() );
+}
+BENCHMARK( BM_FileIo_LineAsync )->Arg( rDebugFileIo::QtFile )->Arg( rDebugFileIo::Pwritev )->Arg( rDebugFileIo::IoUring )->UseRealTime();
+
+
+static void BM_FileIo_Durability( benchmark::State& state )
+{
+  const rDebug_Filewriter::Durability D = static_cast<rDebug_Filewriter::Durability>( state.range(0) );
+  rDebug_GlobalLevel::set( rDebugLevel::rMsgType::All );
+  rDebugBase::setMaxLevel( rDebugLevel::rMsgType::Silent );
+  rDebug_Filewriter::setDurability( rDebugLevel::rMsgType::Debug, D );
+  QFile::remove( benchIoFile() );
+  {
+    rDebug_Filewriter rLogFile( benchIoFile(), rDebugLevel::rMsgType::All, 1, 0x40000000 );
+    rLogFile.setIoBackend( rDebugFileIo::Pwritev );
+
+    int i = 0;
+    for( auto _ : state )
+    {
+      rInfo() << "file line" << ++i << "of" << 2.5;
+    }
+  }
+  rDebug_Filewriter::setDurability( rDebugLevel::rMsgType::Debug, rDebug_Filewriter::Flushed );
+  state.SetItemsProcessed( state.iterations() );
+  QFile::remove( benchIoFile() );
+}
+BENCHMARK( BM_FileIo_Durability )->Arg( rDebug_Filewriter::Buffered )->Arg( rDebug_Filewriter::Flushed )
+                                 ->Arg( rDebug_Filewriter::Synced )->Arg( rDebug_Filewriter::DSynced )->UseRealTime();
+
+
+// a DSynced line must not be on the disk behind a hole: the Flushed one before has to be synced first
+static void BM_FileIo_DSyncOrder( benchmark::State& state )
+{
+  const rDebugFileIo::Backend Wanted = static_cast<rDebugFileIo::Backend>( state.range(0) );
+  QByteArray Line( 99, 'x' );
+  Line += '\n';
+
+  QFile::remove( benchIoFile() );
+  rDebugFileIo File;
+  File.open( benchIoFile(), Wanted );
+  for( auto _ : state )
+  {
+    File.append( Line );
+    File.submit();      // Flushed
+    File.append( Line );
+    File.submitDSync(); // DSynced
+    if( File.unsynced() )
+    { state.SkipWithError( "bytes in front of a DSynced line are not synced" );
+      break;
+    }
+  }
+  File.close();
+  state.SetLabel( rDebugFileIo::name( File.backend() ) );
+  state.SetItemsProcessed( state.iterations() * 2 );
+  QFile::remove( benchIoFile() );
+}
+BENCHMARK( BM_FileIo_DSyncOrder )->Arg( rDebugFileIo::Pwritev )->Arg( rDebugFileIo::IoUring )->UseRealTime();
+
+
+static rDebug_Filewriter* pGroupFile = nullptr;
+
+static void BM_FileIo_GroupCommit( benchmark::State& state )
+{
+  if( state.thread_index() == 0 )
+  {
+    rDebug_GlobalLevel::set( rDebugLevel::rMsgType::All );
+    rDebugBase::setMaxLevel( rDebugLevel::rMsgType::Silent );
+    rDebug_Filewriter::setDurability( rDebugLevel::rMsgType::Debug, rDebug_Filewriter::Synced );
+    QFile::remove( benchIoFile() );
+    pGroupFile = new rDebug_Filewriter( benchIoFile(), rDebugLevel::rMsgType::All, 1, 0x40000000 );
+    pGroupFile->setIoBackend( rDebugFileIo::Pwritev );
+    rDebugStats::setEnabled( true ); // for syncs/line
+  }
+  const quint64 SyncsBefore = rDebugStats::snapshot().mSyncs;
+  int i = 0;
+  for( auto _ : state )
+  {
+    rInfo() << "thread" << state.thread_index() << "line" << ++i;
+  }
+  state.SetItemsProcessed( state.iterations() );
+
+  if( state.thread_index() == 0 )
+  {
+    state.counters["syncs/line"] = benchmark::Counter( static_cast<double>( rDebugStats::snapshot().mSyncs - SyncsBefore ) / ( state.iterations() * state.threads() ) );
+    delete pGroupFile;
+    pGroupFile = nullptr;
+    rDebugStats::setEnabled( false );
+    rDebug_Filewriter::setDurability( rDebugLevel::rMsgType::Debug, rDebug_Filewriter::Flushed );
+    QFile::remove( benchIoFile() );
+  }
+}
+BENCHMARK( BM_FileIo_GroupCommit )->ThreadRange( 1, 16 )->UseRealTime();
@@ -0,0 +1,207 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_FormatBench.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// number formatting of the operator<< overloads: the former QTextStream path
+// against the rDebugFormat based one, which is in use now.
+// And the time stamp of each line: QDateTime::toString() against rDebugCore::formatTime().
+//    ./rDebug_Bench --benchmark_filter=Format
+
+#include <QString>
+#include <QByteArray>
+#include <QTextStream>
+#include <QPoint>
+
+#include <benchmark/benchmark.h>
+
+#include "../src/rDebugRecord.h"
+#include "../src/rDebugFormat.h"
+#include "../src/rDebugCore.h"
+
+
+static const qint64 IntValues[8] = { 0, 7, -42, 1234, 65535, -1000000, 4294967296LL, 9007199254740993LL };
+static const double DblValues[8] = { 0.0, 1.0, -2.5, 3.141592653589793, 0.1, 1e-7, 6.02214076e23, -1234.5678 };
+
+
+static void BM_FormatInt_QTextStream( benchmark::State& state )
+{
+  const int base = static_cast<int>( state.range(0) );
+  QString     Msg;
+  QTextStream Stream( &Msg );
+  unsigned    idx = 0;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    Stream.setIntegerBase( base );
+    Stream << IntValues[ idx++ & 7 ];
+    benchmark::DoNotOptimize( Msg.constData() );
+  }
+}
+BENCHMARK( BM_FormatInt_QTextStream )->Arg(10)->Arg(16)->Arg(2);
+
+
+static void BM_FormatInt_rDebugFormat( benchmark::State& state )
+{
+  const int base = static_cast<int>( state.range(0) );
+  std::string Msg;
+  unsigned  idx = 0;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    rDebugArgs::appendInt( Msg, IntValues[ idx++ & 7 ], base );
+    benchmark::DoNotOptimize( Msg.data() );
+  }
+}
+BENCHMARK( BM_FormatInt_rDebugFormat )->Arg(10)->Arg(16)->Arg(2);
+
+
+static void BM_FormatInt_CharsOnly( benchmark::State& state ) // lower bound, without the append to the message
+{
+  const int base = static_cast<int>( state.range(0) );
+  char      Text[rDebugFormat::MaxChars];
+  unsigned  idx = 0;
+  for( auto _ : state )
+  {
+    benchmark::DoNotOptimize( rDebugFormat::formatSigned( Text, IntValues[ idx++ & 7 ], base ) );
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK( BM_FormatInt_CharsOnly )->Arg(10)->Arg(16)->Arg(2);
+
+
+static void BM_FormatDouble_QTextStream( benchmark::State& state ) // note: only 6 significant digits
+{
+  QString     Msg;
+  QTextStream Stream( &Msg );
+  unsigned    idx = 0;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    Stream << DblValues[ idx++ & 7 ];
+    benchmark::DoNotOptimize( Msg.constData() );
+  }
+}
+BENCHMARK( BM_FormatDouble_QTextStream );
+
+
+static void BM_FormatDouble_rDebugFormat( benchmark::State& state ) // shortest round-trip
+{
+  std::string Msg;
+  unsigned idx = 0;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    rDebugArgs::appendDouble( Msg, DblValues[ idx++ & 7 ] );
+    benchmark::DoNotOptimize( Msg.data() );
+  }
+}
+BENCHMARK( BM_FormatDouble_rDebugFormat );
+
+
+static void BM_FormatPointer_QTextStream( benchmark::State& state )
+{
+  QString     Msg;
+  QTextStream Stream( &Msg );
+  for( auto _ : state )
+  {
+    Msg.clear();
+    Stream << "0x" << hex << static_cast<const void*>( &Msg );
+    benchmark::DoNotOptimize( Msg.constData() );
+  }
+}
+BENCHMARK( BM_FormatPointer_QTextStream );
+
+
+static void BM_FormatPointer_rDebugFormat( benchmark::State& state )
+{
+  std::string Msg;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    rDebugArgs::appendPointer( Msg, &Msg );
+    benchmark::DoNotOptimize( Msg.data() );
+  }
+}
+BENCHMARK( BM_FormatPointer_rDebugFormat );
+
+
+static void BM_FormatPoint_QTextStream( benchmark::State& state )
+{
+  QString     Msg;
+  QTextStream Stream( &Msg );
+  const QPoint d( 640, -480 );
+  for( auto _ : state )
+  {
+    Msg.clear();
+    Stream << "@(" << d.x() << "," << d.y() << ")";
+    benchmark::DoNotOptimize( Msg.constData() );
+  }
+}
+BENCHMARK( BM_FormatPoint_QTextStream );
+
+
+static void BM_FormatPoint_rDebugFormat( benchmark::State& state )
+{
+  std::string Msg;
+  const QPoint d( 640, -480 );
+  for( auto _ : state )
+  {
+    Msg.clear();
+    rDebugArgs::appendPoint( Msg, d );
+    benchmark::DoNotOptimize( Msg.data() );
+  }
+}
+BENCHMARK( BM_FormatPoint_rDebugFormat );
+
+
+// the former per line path: take a local QDateTime and let it write the stamp
+static void BM_FormatTime_QDateTime( benchmark::State& state )
+{
+  QByteArray Msg;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    const QDateTime Now( QDate::currentDate(), QTime::currentTime(), Qt::LocalTime );
+    Msg += Now.toString( "yyyy-MM-dd HH:mm:ss,zzz" ).toUtf8();
+    benchmark::DoNotOptimize( Msg.constData() );
+  }
+}
+BENCHMARK( BM_FormatTime_QDateTime );
+
+
+static void BM_FormatTime_rDebugCore( benchmark::State& state )
+{
+  QByteArray Msg;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    rDebugCore::appendTime( Msg, rDebugCore::now() );
+    benchmark::DoNotOptimize( Msg.constData() );
+  }
+}
+BENCHMARK( BM_FormatTime_rDebugCore );
@@ -0,0 +1,302 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_LineBench.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// ns/line and allocs/line of whole log statements, from the macro down to the sinks.
+//    ./rDebug_Bench --benchmark_filter=Line
+// all benchmarks here mute the qDebug() sink (rDebugBase::setMaxLevel), so the console
+// is not part of the measurement, only the sink under test gets the lines.
+
+#include <QString>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QObject>
+
+#include <benchmark/benchmark.h>
+
+#include "rDebug_Bench.h"
+
+
+static QString benchLogfile()
+{
+  return QDir::tempPath() + "/rDebug_Bench.log";
+}
+
+
+// all levels pass the global filter, qDebug() sink is silent
+static void benchLevels( rDebugLevel::rMsgType Global )
+{
+  rDebug_GlobalLevel::set( Global );
+  rDebugBase::setMaxLevel( rDebugLevel::rMsgType::Silent );
+}
+
+
+
+// -----------------------
+// statements below the global level: the cost of a rDebug() line, which is switched off
+// -----------------------
+static void BM_Line_FilteredStream( benchmark::State& state )
+{
+  benchLevels( rDebugLevel::rMsgType::Warning );
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rDebug() << "filtered" << ++i << "stream";
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Line_FilteredStream );
+
+
+static void BM_Line_FilteredPrintf( benchmark::State& state )
+{
+  benchLevels( rDebugLevel::rMsgType::Warning );
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rDebug( "filtered %d printf", ++i );
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Line_FilteredPrintf );
+
+
+
+// -----------------------
+// passing statements without any sink: building the line is all what is measured
+// -----------------------
+static void BM_Line_Printf( benchmark::State& state )
+{
+  benchLevels( rDebugLevel::rMsgType::All );
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rInfo( "value %d of %s", ++i, "printf" );
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Line_Printf );
+
+
+static void BM_Line_Formatted( benchmark::State& state )
+{
+  benchLevels( rDebugLevel::rMsgType::All );
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rInfo_f( "value {} of {}", ++i, "format" );
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Line_Formatted );
+
+
+static void BM_Line_StreamMixed( benchmark::State& state )
+{
+  benchLevels( rDebugLevel::rMsgType::All );
+  const QString Text( "text" );
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rInfo() << "mixed" << ++i << 3.25 << Text << true << hex << 0xBEEF << static_cast<const void*>( &i );
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Line_StreamMixed );
+
+
+
+// -----------------------
+// the file sink, by the way the lines get to the disk
+//    0 : written and flushed by the logging thread, line by line
+//    1 : rDebug_AsyncWriter, written in batches by the background thread
+//    2 : like 1, with deferred formatting
+// -----------------------
+static void BM_Line_File( benchmark::State& state )
+{
+  static const char* Policies[] = { "sync flush per line", "async", "async deferred" };
+  const int Policy = static_cast<int>( state.range(0) );
+  benchLevels( rDebugLevel::rMsgType::All );
+  QFile::remove( benchLogfile() );
+  {
+    rDebug_Filewriter  rLogFile( benchLogfile(), rDebugLevel::rMsgType::All, 1, 0x4000000 );
+    rDebug_AsyncWriter* pAsync = ( Policy > 0 ) ? new rDebug_AsyncWriter() : nullptr;
+    rDebug_AsyncWriter::setDeferredFormatting( Policy == 2 );
+
+    rDebug_BenchAllocs Allocs( state );
+    int i = 0;
+    for( auto _ : state )
+    {
+      rInfo() << "file line" << ++i << "of" << 2.5 << "policy" << Policy;
+    }
+    if( pAsync )
+      pAsync->flush(); // part of the work, but outside of the timing
+
+    Allocs.report();
+    rDebug_AsyncWriter::setDeferredFormatting( false );
+    delete pAsync;
+  }
+  state.SetLabel( Policies[Policy] );
+}
+BENCHMARK( BM_Line_File )->Arg(0)->Arg(1)->Arg(2);
+
+
+
+// -----------------------
+// rDebug_Signaller, the slot in the same thread (direct) or in an own one (queued)
+// -----------------------
+static void benchSignaller( benchmark::State& state, bool Queued )
+{
+  benchLevels( rDebugLevel::rMsgType::All );
+  rDebug_Signaller     rLogSignalSlot( rDebugLevel::rMsgType::All );
+  rDebug_BenchReceiver Receiver;
+  QThread              ReceiverThread;
+  if( Queued )
+  { Receiver.moveToThread( &ReceiverThread );
+    ReceiverThread.start(); // runs an event loop
+  }
+  QObject::connect( &rLogSignalSlot, SIGNAL(sig_logline(const FileLineFunc_t&,const QDateTime&,int,uint64_t,const QString&)),
+                    &Receiver,       SLOT(   on_logline(const FileLineFunc_t&,const QDateTime&,int,uint64_t,const QString&)),
+                    (Queued) ? Qt::QueuedConnection : Qt::DirectConnection );
+
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rInfo() << "signalled" << ++i;
+    if( Queued && !(i & 0x3FF) ) // let the receiver catch up, so delivery is part of the timing
+      while( Receiver.lines() < i )
+        QThread::yieldCurrentThread();
+  }
+  Allocs.report();
+
+  if( Queued )
+  { while( Receiver.lines() < i )
+      QThread::yieldCurrentThread();
+    ReceiverThread.quit();
+    ReceiverThread.wait();
+  }
+}
+
+
+static void BM_Line_SignalDirect( benchmark::State& state )
+{
+  benchSignaller( state, false );
+}
+BENCHMARK( BM_Line_SignalDirect );
+
+
+static void BM_Line_SignalQueued( benchmark::State& state )
+{
+  benchSignaller( state, true );
+}
+BENCHMARK( BM_Line_SignalQueued )->UseRealTime();
+
+
+
+// -----------------------
+// contention: 1..32 threads logging at the same time.
+// Thread 0 sets up the sinks before the timing loop, the others wait for it at the loop start.
+// -----------------------
+static void BM_Line_ThreadsFiltered( benchmark::State& state )
+{
+  if( state.thread_index() == 0 )
+    benchLevels( rDebugLevel::rMsgType::Warning );
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rDebug() << "filtered" << ++i;
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Line_ThreadsFiltered )->ThreadRange( 1, 32 )->UseRealTime();
+
+
+static rDebug_Filewriter*  pThreadsFile  = nullptr;
+static rDebug_AsyncWriter* pThreadsAsync = nullptr;
+
+static void BM_Line_ThreadsAsyncFile( benchmark::State& state )
+{
+  if( state.thread_index() == 0 )
+  {
+    benchLevels( rDebugLevel::rMsgType::All );
+    QFile::remove( benchLogfile() );
+    pThreadsFile  = new rDebug_Filewriter( benchLogfile(), rDebugLevel::rMsgType::All, 1, 0x4000000 );
+    pThreadsAsync = new rDebug_AsyncWriter();
+  }
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rInfo() << "thread" << state.thread_index() << "line" << ++i;
+  }
+  Allocs.report();
+
+  if( state.thread_index() == 0 )
+  {
+    delete pThreadsAsync; // drains the queue
+    delete pThreadsFile;
+    pThreadsAsync = nullptr;
+    pThreadsFile  = nullptr;
+  }
+}
+BENCHMARK( BM_Line_ThreadsAsyncFile )->ThreadRange( 1, 32 )->UseRealTime();
+
+
+// the queueing alone, no file sink: Arg 0 = one shared queue, 1 = per thread rings
+static void BM_Line_ThreadsQueued( benchmark::State& state )
+{
+  if( state.thread_index() == 0 )
+  {
+    benchLevels( rDebugLevel::rMsgType::All );
+    pThreadsAsync = state.range(0) ? new rDebug_AsyncWriter( 0x1000, rDebug_AsyncWriter::Block, rDebug_AsyncWriter::PerThreadRings )
+                                   : new rDebug_AsyncWriter( 0x4000, rDebug_AsyncWriter::Block, rDebug_AsyncWriter::SharedQueue );
+  }
+  rDebug_BenchAllocs Allocs( state );
+  int i = 0;
+  for( auto _ : state )
+  {
+    rInfo() << "thread" << state.thread_index() << "line" << ++i;
+  }
+  state.SetItemsProcessed( state.iterations() );
+  Allocs.report();
+
+  if( state.thread_index() == 0 )
+  {
+    delete pThreadsAsync; // drains the queue or the rings
+    pThreadsAsync = nullptr;
+  }
+}
+BENCHMARK( BM_Line_ThreadsQueued )->Arg( 0 )->Arg( 1 )->ThreadRange( 1, 64 )->UseRealTime();
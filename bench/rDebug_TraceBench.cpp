@@ -0,0 +1,86 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_TraceBench.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// the cost of rTraceScope()/rTimed(): switched off, filtered, and recorded.
+//    ./rDebug_Bench --benchmark_filter=Trace
+
+#include <QString>
+#include <QDir>
+
+#include <benchmark/benchmark.h>
+
+#include "rDebug_Bench.h"
+#include "../src/rDebugTrace.h"
+
+
+// no rDebug_TraceRecorder: one atomic load
+static void BM_Trace_ScopeOff( benchmark::State& state )
+{
+  rDebug_BenchAllocs Allocs( state );
+  for( auto _ : state )
+  {
+    rTraceScope( "off" );
+    benchmark::ClobberMemory();
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Trace_ScopeOff );
+
+
+// level below the global one, no recorder
+static void BM_Trace_TimedFiltered( benchmark::State& state )
+{
+  rDebug_GlobalLevel::set( rDebugLevel::rMsgType::Warning );
+  rDebug_BenchAllocs Allocs( state );
+  for( auto _ : state )
+  {
+    rTimed( rDebugLevel::rMsgType::Debug );
+    benchmark::ClobberMemory();
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Trace_TimedFiltered );
+
+
+// two nested spans into the recorder, per iteration
+static void BM_Trace_ScopeRecorded( benchmark::State& state )
+{
+  rDebug_TraceRecorder Recorder( QDir::tempPath() + "/rDebug_Bench.trace.json", 0x10000 );
+  rDebug_BenchAllocs Allocs( state );
+  for( auto _ : state )
+  {
+    rTraceScope( "outer" );
+    {
+      rTraceScope( "inner" );
+      benchmark::ClobberMemory();
+    }
+  }
+  Allocs.report();
+}
+BENCHMARK( BM_Trace_ScopeRecorded );
@@ -0,0 +1,108 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_Utf8Bench.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// the way of a QString argument into the file: before, into the QString message, then
+// QTextStream with UTF-8 codec. Now, encoded once into the UTF-8 message.
+//    ./rDebug_Bench --benchmark_filter=Utf8
+
+#include <QString>
+#include <QByteArray>
+#include <QBuffer>
+#include <QTextStream>
+
+#include <benchmark/benchmark.h>
+
+#include "../src/rDebugRecord.h"
+
+
+static QString sampleText( int kind, int len )
+{
+  static const char*  Ascii  = "request done for user admin, elapsed ms ";
+  static const ushort Umlaut[] = { 0x00E4, 0x00F6, 0x00FC, 0x00DF, 0x20AC, 'x', 'y', ' ' };
+  QString Text;
+  for( int i=0 ; Text.size() < len ; ++i )
+  {
+    if( kind == 0 )
+      Text += QChar( Ascii[ i % 40 ] );
+    else
+      Text += QChar( ( i % 16 ) ? Ascii[ i % 40 ] : Umlaut[ (i/16) % 8 ] );
+  }
+  return Text;
+}
+
+
+static void BM_Utf8_QTextStreamCodec( benchmark::State& state )
+{
+  const QString Arg( sampleText( static_cast<int>( state.range(0) ), static_cast<int>( state.range(1) ) ) );
+  QByteArray File;
+  QBuffer    Device( &File );
+  Device.open( QIODevice::WriteOnly );
+  for( auto _ : state )
+  {
+    QString Msg;
+    QTextStream( &Msg ) << Arg;            // operator<< into the QString message
+    QTextStream Stream( &Device );         // the file sink
+    Stream.setCodec( "UTF-8" );
+    Stream << Msg << "\n";
+    Stream.flush();
+    Device.seek( 0 );
+  }
+  state.SetBytesProcessed( static_cast<int64_t>( state.iterations() ) * Arg.size() * 2 );
+}
+BENCHMARK( BM_Utf8_QTextStreamCodec )->Args({0,64})->Args({0,1024})->Args({1,64})->Args({1,1024});
+
+
+static void BM_Utf8_QStringToUtf8( benchmark::State& state )
+{
+  const QString Arg( sampleText( static_cast<int>( state.range(0) ), static_cast<int>( state.range(1) ) ) );
+  QByteArray Msg;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    Msg += Arg.toUtf8();
+    benchmark::DoNotOptimize( Msg.constData() );
+  }
+  state.SetBytesProcessed( static_cast<int64_t>( state.iterations() ) * Arg.size() * 2 );
+}
+BENCHMARK( BM_Utf8_QStringToUtf8 )->Args({0,64})->Args({0,1024})->Args({1,64})->Args({1,1024});
+
+
+static void BM_Utf8_rDebugUtf8( benchmark::State& state )
+{
+  const QString Arg( sampleText( static_cast<int>( state.range(0) ), static_cast<int>( state.range(1) ) ) );
+  std::string Msg;
+  for( auto _ : state )
+  {
+    Msg.clear();
+    rDebugArgs::appendString( Msg, Arg );
+    benchmark::DoNotOptimize( Msg.data() );
+  }
+  state.SetBytesProcessed( static_cast<int64_t>( state.iterations() ) * Arg.size() * 2 );
+}
+BENCHMARK( BM_Utf8_rDebugUtf8 )->Args({0,64})->Args({0,1024})->Args({1,64})->Args({1,1024});
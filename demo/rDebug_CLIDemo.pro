@@ -14,11 +14,39 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include( ../src/rDebugZlib.pri ) # gzip frames of the file sink, "qmake CONFIG+=nozlib" builds without
+
 SOURCES += rDebug_CLIDemo.cpp \
-    ../src/rDebug.cpp
+    ../src/rDebug.cpp \
+    ../src/rDebugPattern.cpp \
+    ../src/rDebugRecord.cpp \
+    ../src/rDebugRecordQt.cpp \
+    ../src/rDebugStats.cpp \
+    ../src/rDebugMetrics.cpp \
+    ../src/rDebugTrace.cpp \
+    ../src/rDebugConfig.cpp \
+    ../src/rDebugFileIo.cpp \
+    ../src/rDebugRetention.cpp \
+    ../src/rDebugSeekIndex.cpp \
+    ../src/rDebugCore.cpp
 
 HEADERS += \
     rDebug_CLIDemo.h \
     ../src/rDebug.h \
     ../src/rDebugCodeloc.h \
-    ../src/rDebugLevel.h
+    ../src/rDebugLevel.h \
+    ../src/rDebugJson.h \
+    ../src/rDebugPattern.h \
+    ../src/rDebugRecord.h \
+    ../src/rDebugFormat.h \
+    ../src/rDebugUtf8.h \
+    ../src/rDebugStats.h \
+    ../src/rDebugMetrics.h \
+    ../src/rDebugTrace.h \
+    ../src/rDebugConfig.h \
+    ../src/rDebugRing.h \
+    ../src/rDebugFileIo.h \
+    ../src/rDebugRetention.h \
+    ../src/rDebugSeekIndex.h \
+    ../src/rDebugCore.h \
+    ../src/rDebugFmt.h
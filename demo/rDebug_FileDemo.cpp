@@ -15,6 +15,9 @@
 //#include <QDebug>
 #include "../src/rDebug.h"
 #include "../src/rDebugLevel.h"
+#include "../src/rDebugMetrics.h"
+#include "../src/rDebugTrace.h"
+#include "../src/rDebugConfig.h"
 
 
 QString getDataLocation( void )
@@ -57,6 +60,31 @@ int main(int argc, char *argv[])
                                 3/*Max Backups of full logfiles*/,
                                 4096 /*4k per file would be nice for the demo, but internally we use at least 64k, sorry*/ );
 
+    /* let a background thread format and write the lines, the jobs just queue them.
+     * it must be created after the sinks, so it is drained and destroyed before them.
+     * deferred formatting: the main thread only captures the raw operator<< values.
+     */
+    rDebug_AsyncWriter rLogAsync;
+    rDebug_AsyncWriter::setDeferredFormatting( true );
+
+    /* the logging metrics in Prometheus format, try
+     *   curl http://127.0.0.1:9464/metrics
+     * while the demo runs. without QT += network, the file next to the logfile is the only one.
+     */
+    rDebug_MetricsExporter rLogMetricsFile( rDebug_MetricsExporter::File, QString( getHomeLocation() + '/' + APPLICATION_NAME ".prom" ), 1000 );
+    rDebug_MetricsExporter rLogMetricsHttp( rDebug_MetricsExporter::Http, "9464" );
+
+    /* levels can be changed while the demo runs, by writing rules into this file, f.i.
+     *   global = Debug
+     *   sink.file = Warning
+     *   category.*FileDemo* = Informational
+     * see rDebug_FileDemo.levels
+     */
+    rDebug_LevelWatcher rLogLevels( QString( getHomeLocation() + '/' + APPLICATION_NAME ".levels" ) );
+
+    // the rTraceScope()/rTimed() spans of the jobs, load the file into ui.perfetto.dev
+    rDebug_TraceRecorder rLogTrace( QString( getHomeLocation() + '/' + APPLICATION_NAME ".trace.json" ) );
+
 
   //QObject::connect( simple_job, SIGNAL(done()), &a,         SLOT(quit())    );
     QObject::connect( simple_job, SIGNAL(done()), simple_job, SLOT(on_done()) );
@@ -6,6 +6,7 @@
 
 //#include <QDebug>
 #include "../src/rDebug.h"
+#include "../src/rDebugTrace.h"
 
 
 
@@ -30,6 +31,7 @@ signals:
 public slots:
     void on_run(void)
     {   // Do processing here
+        rTimed( rDebugLevel::rMsgType::Informational ); // a line with the duration of the job, at its end
         qDebug() << __PRETTY_FUNCTION__ << "running...";
 
 
@@ -38,7 +40,7 @@ public slots:
 
         uint i=8;
         do
-        {
+        {   rTraceScope( "qDebug loop" );
             qDebug() << "qDebug loop" << i <<"performed";
         } while( --i >0 );
 
@@ -48,40 +48,61 @@
 #include <QTextStream>
 #include <stdio.h>
 #include <stdarg.h>  // va_list
+#include <cmath>     // std::isfinite
+#include <string.h>  // strlen
+#include <string>
+#include <chrono>
+#include <thread>     // std::this_thread::sleep_for
+#include <algorithm>  // std::push_heap
+#include <functional> // std::greater
 
 #include "rDebugLevel.h"
+#include "rDebugJson.h"
+#include "rDebugStats.h"
+#include "rDebugConfig.h"
+#include "rDebugRing.h"
 
 
 
-void to_xDebug( rDebugLevel::rMsgType Level, const QString& msg )
+/* msg is UTF-8. Qt5 takes the "%s" argument as UTF-8 as well, so it is passed through as it is.
+ * Qt4 writes the bytes unchanged to the console, there we still need the local 8 bit encoding.
+ */
+void to_xDebug( rDebugLevel::rMsgType Level, const std::string& msg )
 {
+  #if defined(QT_VERSION) && (QT_VERSION>=0x050000)
+  const char* const text = msg.c_str();
+  #elif defined(QT_VERSION) && (QT_VERSION>=0x040000)
+  const QByteArray local( QString::fromUtf8( msg.data(), static_cast<int>( msg.size() ) ).toLocal8Bit() );
+  const char* const text = local.constData();
+  #endif
+
   #pragma GCC diagnostic push
   switch(Level)
   {
     #pragma GCC diagnostic ignored "-Wimplicit-fallthrough=2"
     case rDebugLevel::rMsgType::Emergency    : /*0*/ // intentionally fallthrough
-    case rDebugLevel::rMsgType::Alert        : /*1*/ qFatal( "%s", msg.toLocal8Bit().constData() ); //break; Will and shall break the app via abort()
+    case rDebugLevel::rMsgType::Alert        : /*1*/ qFatal( "%s", text ); //break; Will and shall break the app via abort()
     case rDebugLevel::rMsgType::Critical     : /*2*/ // intentionally fallthrough
-    case rDebugLevel::rMsgType::Error        : /*3*/ qCritical( "%s", msg.toLocal8Bit().constData() ); break;
+    case rDebugLevel::rMsgType::Error        : /*3*/ qCritical( "%s", text ); break;
 #if !defined( QT_NO_WARNING_OUTPUT ) // suppression of WARNING and HIGHER
-    case rDebugLevel::rMsgType::Warning      : /*4*/ qWarning( "%s", msg.toLocal8Bit().constData() ); break;
+    case rDebugLevel::rMsgType::Warning      : /*4*/ qWarning( "%s", text ); break;
     #if defined(QT_VERSION) && (QT_VERSION>=0x050000)
-    case rDebugLevel::rMsgType::Notice       : /*5*/ qDebug().noquote() << msg; break;
+    case rDebugLevel::rMsgType::Notice       : /*5*/ qDebug( "%s", text ); break; // same as qDebug().noquote() << msg, without a QString
     #elif defined(QT_VERSION) && (QT_VERSION>=0x040000)
-    case rDebugLevel::rMsgType::Notice       : /*5*/ qDebug() << msg; break;
+    case rDebugLevel::rMsgType::Notice       : /*5*/ qDebug() << QString::fromUtf8( msg.data(), static_cast<int>( msg.size() ) ); break;
     #endif
 # if !defined( QT_NO_INFO_OUTPUT ) // suppression of INFO and HIGHER
     #if defined(QT_VERSION) && (QT_VERSION>=0x050000)
-    case rDebugLevel::rMsgType::Informational: /*6*/ qDebug().noquote() << msg; break;
+    case rDebugLevel::rMsgType::Informational: /*6*/ qDebug( "%s", text ); break;
     #elif defined(QT_VERSION) && (QT_VERSION>=0x040000)
-    case rDebugLevel::rMsgType::Informational: /*6*/ qDebug() << msg; break;
+    case rDebugLevel::rMsgType::Informational: /*6*/ qDebug() << QString::fromUtf8( msg.data(), static_cast<int>( msg.size() ) ); break;
     #endif
 # if !defined( QT_NO_DEBUG_OUTPUT ) // suppression of DEBUG (and higher, but there is no higher)
 #  if !defined( QT_NO_DEBUG ) // in release builds, we always suppress DEBUG type messages
     #if defined(QT_VERSION) && (QT_VERSION>=0x050000)
-    case rDebugLevel::rMsgType::Debug        : /*7*/ qDebug().noquote() << msg; break;
+    case rDebugLevel::rMsgType::Debug        : /*7*/ qDebug( "%s", text ); break;
     #elif defined(QT_VERSION) && (QT_VERSION>=0x040000)
-    case rDebugLevel::rMsgType::Debug        : /*7*/ qDebug() << msg; break;
+    case rDebugLevel::rMsgType::Debug        : /*7*/ qDebug() << QString::fromUtf8( msg.data(), static_cast<int>( msg.size() ) ); break;
     #endif
 #  endif // !defined( QT_NO_DEBUG ) // in release builds, we always suppress DEBUG type messages
 # endif // !defined( QT_NO_DEBUG_OUTPUT ) // suppression of DEBUG (and higher, but there is no higher)
@@ -136,56 +157,72 @@ static bool SkipOutputByPreprocessor( rDebugLevel::rMsgType
     return false;
 }
 
+
+// the global level, or the one of a category/site rule for this line (see rDebugLevelRules)
+static bool PassesGlobalLevel( const FileLineFunc_t& CodeLocation, rDebugLevel::rMsgType Level )
+{
+  return rDebug_GlobalLevel::passes( CodeLocation.mFile, CodeLocation.mLine, Level );
+}
+
 /* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
 
-rDebugLevel::rMsgType rDebug_GlobalLevel::mMaxLevel = SYSLOG_LEVEL_MAX;
+std::atomic<rDebugLevel::rMsgType> rDebug_GlobalLevel::mMaxLevel( SYSLOG_LEVEL_MAX );
 
 
 rDebug_GlobalLevel::rDebug_GlobalLevel(rDebugLevel::rMsgType MaxLevel)
 {
-  rDebug_GlobalLevel::mMaxLevel = MaxLevel;
+  rDebug_GlobalLevel::mMaxLevel.store( MaxLevel, std::memory_order_relaxed );
 }
 
 void rDebug_GlobalLevel::set(rDebugLevel::rMsgType MaxLevel)
 {
-  rDebug_GlobalLevel::mMaxLevel = MaxLevel;
+  rDebug_GlobalLevel::mMaxLevel.store( MaxLevel, std::memory_order_relaxed );
 }
 
 rDebugLevel::rMsgType rDebug_GlobalLevel::get(void)
 {
-  return rDebug_GlobalLevel::mMaxLevel;
+  return rDebug_GlobalLevel::mMaxLevel.load( std::memory_order_relaxed );
+}
+
+bool rDebug_GlobalLevel::passes( const char* File, int Line, rDebugLevel::rMsgType Level )
+{
+  if( !rDebugLevelRules::hasLocalRules() )
+    return rDebug_GlobalLevel::get() >= Level;
+  return rDebugLevelRules::maxLevelFor( File, Line, rDebug_GlobalLevel::get() ) >= Level;
 }
 
 /* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
 
-rDebugLevel::rMsgType rDebug_Signaller::mMaxLevel = SYSLOG_LEVEL_MAX;
-rDebug_Signaller*     rDebug_Signaller::pSignaller = nullptr;
+std::atomic<rDebugLevel::rMsgType> rDebug_Signaller::mMaxLevel( SYSLOG_LEVEL_MAX );
+rDebug_SinkSlot<rDebug_Signaller>  rDebug_Signaller::pSignaller;
 
 
 rDebug_Signaller::rDebug_Signaller(rDebugLevel::rMsgType MaxLevel)
 {
-  rDebug_Signaller::mMaxLevel = MaxLevel;
+  qRegisterMetaType<FileLineFunc_t>( "FileLineFunc_t" ); // for queued connections, f.i. from rDebug_AsyncWriter
+  qRegisterMetaType<uint64_t>( "uint64_t" );
+  rDebug_Signaller::mMaxLevel.store( MaxLevel, std::memory_order_relaxed );
   if( MaxLevel <= rDebugLevel::rMsgType::Silent )
-  { rDebug_Signaller::pSignaller = nullptr;
+  { rDebug_Signaller::pSignaller.set( nullptr );
     return;
   }
-  rDebug_Signaller::pSignaller = this;
+  rDebug_Signaller::pSignaller.set( this );
 }
 
 
 rDebug_Signaller::~rDebug_Signaller()
 {
-  rDebug_Signaller::pSignaller = nullptr;
+  rDebug_Signaller::pSignaller.reset( this );
 }
 
 void rDebug_Signaller::setMaxLevel(rDebugLevel::rMsgType MaxLevel)
 {
-  rDebug_Signaller::mMaxLevel = MaxLevel;
+  rDebug_Signaller::mMaxLevel.store( MaxLevel, std::memory_order_relaxed );
 }
 
 void rDebug_Signaller::signal_line( const FileLineFunc_t& CodeLocation, const QDateTime& Time, rDebugLevel::rMsgType Level, uint64_t LogId, const QString& line )
 {
-  if( rDebug_Signaller::mMaxLevel >= Level)
+  if( rDebug_Signaller::mMaxLevel.load( std::memory_order_relaxed ) >= Level)
   {
     int lvl = static_cast<int>(Level);
     emit sig_logline( CodeLocation, Time, lvl, LogId, line );
@@ -195,139 +232,508 @@ void rDebug_Signaller::signal_line( const FileLineFunc_t& CodeLocation, const QD
 
 /* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
 
-rDebugLevel::rMsgType rDebug_Filewriter::mMaxLevel = SYSLOG_LEVEL_MAX;
-bool                  rDebug_Filewriter::mDumpCodeLocation = false;
-rDebug_Filewriter*    rDebug_Filewriter::pFilewriter = nullptr;
+std::atomic<rDebugLevel::rMsgType> rDebug_Filewriter::mMaxLevel( SYSLOG_LEVEL_MAX );
+std::atomic<bool>                  rDebug_Filewriter::mDumpCodeLocation( false );
+rDebug_SinkSlot<rDebug_Filewriter> rDebug_Filewriter::pFilewriter;
+thread_local bool                  rDebug_Filewriter::mBatchThisThread = false;
+std::atomic<quint32>               rDebug_Filewriter::mDurability( 0x5555 ); // all levels Flushed
 
-rDebug_Filewriter::rDebug_Filewriter(const QString& fileName, rDebugLevel::rMsgType MaxLevel, qint16 MaxBackups, qint64 MaxSize)
+rDebug_Filewriter::rDebug_Filewriter(const QString& fileName, rDebugLevel::rMsgType MaxLevel, qint16 MaxBackups, qint64 MaxSize, OutputFormat Format)
   : mFileName(fileName)
   , mMaxSize( qMax( MaxSize, static_cast<qint64>(0x10000) ) )
   , mMaxBackups(MaxBackups)
-  , mpLogfile(nullptr)
-{
-  rDebug_Filewriter::mMaxLevel = MaxLevel;
+  , mFormat(Format)
+  , mPattern( rDebugPattern::fromEnvironment() )
+  , mIoBackend( rDebugFileIo::QtFile )
+  , mWrittenTotal(0)
+  , mSyncTicket(0)
+  , mSyncAtBatchEnd(false)
+  , mSyncing(false)
+  , mSyncedUpTo(0)
+  , mRotation( rDebugRetention::Numbered )
+  , mRetentionBudget(0)
+  , mPeriodEndMs(0)
+  , mIndexBlock(0)
+{
+  mScratch.reserve( 0x400 ); // reserved, so resize(0) keeps it
+  rDebug_Filewriter::mMaxLevel.store( MaxLevel, std::memory_order_relaxed );
   if( MaxLevel <= rDebugLevel::rMsgType::Silent )
-  { rDebug_Filewriter::pFilewriter = nullptr;
+  { rDebug_Filewriter::pFilewriter.set( nullptr );
     return;
   }
 
-  rDebug_Filewriter::pFilewriter = this;
-
   if( mFileName.isEmpty() )
   { mFileName = QDir::tempPath() + '/' + QFileInfo( QCoreApplication::applicationFilePath() ).fileName() + ".log";
   }
 
   if (!mFileName.isEmpty())
   {
+      mBackups.scan( mFileName ); // the one look at the directory
       if( oversized(mFileName) )
-      { rotate();
+      { rotate( QString(), QFileInfo( mFileName ).size() );
       }
       open( mFileName, "CTor", "========== logfile opened ==========" );
   }
+
+  rDebug_Filewriter::pFilewriter.set( this ); // last, the file is ready now
 }
 
 
 rDebug_Filewriter::~rDebug_Filewriter()
 {
-  close( "DTor", "========== logfile closed ==========" );
-  rDebug_Filewriter::pFilewriter = nullptr;
+  rDebug_Filewriter::pFilewriter.reset( this ); // first, so no other thread is writing anymore
+  if( mFile.isOpen() )
+    close( "DTor", "========== logfile closed ==========" );
 }
 
 
 void rDebug_Filewriter::setMaxLevel(rDebugLevel::rMsgType MaxLevel)
 {
-  rDebug_Filewriter::mMaxLevel = MaxLevel;
+  rDebug_Filewriter::mMaxLevel.store( MaxLevel, std::memory_order_relaxed );
 }
 
 
 void rDebug_Filewriter::setMaxSize(qint64 MaxSize)
 {
+  std::lock_guard<std::mutex> Lock( mLock );
   mMaxSize = MaxSize;
 }
 
 
 void rDebug_Filewriter::setMaxBackups( qint16 MaxBackups )
 {
+  std::lock_guard<std::mutex> Lock( mLock );
   mMaxBackups = MaxBackups;
 }
 
 
+void rDebug_Filewriter::setOutputFormat( OutputFormat Format )
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  mFormat = Format;
+}
+
+
+void rDebug_Filewriter::setMessagePattern( const QString& Pattern )
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  mPattern.compile( Pattern );
+}
+
+
+void rDebug_Filewriter::setIoBackend( rDebugFileIo::Backend Backend )
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  mIoBackend = Backend;
+  if( mFile.isOpen() && mFile.backend() != Backend )
+  { mFile.close(); // waits for the writes in flight
+    mFile.open( mFileName, mIoBackend );
+  }
+}
+
+
+rDebugFileIo::Backend rDebug_Filewriter::ioBackend() const
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  return mFile.isOpen() ? mFile.backend() : mIoBackend;
+}
+
+
+// a file left from an earlier period is rotated right away
+void rDebug_Filewriter::setRotation( rDebugRetention::Rotation Mode )
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  mRotation = Mode;
+  if( Mode == rDebugRetention::Numbered )
+    return;
+  next_period( mFileTime.isValid() ? mFileTime : QDateTime::currentDateTime() );
+  if( mFile.isOpen() )
+    rotate_ondemand();
+}
+
+
+rDebugRetention::Rotation rDebug_Filewriter::rotation() const
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  return mRotation;
+}
+
+
+void rDebug_Filewriter::setRetentionBudget( qint64 Bytes )
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  mRetentionBudget = Bytes;
+  enforce_retention();
+}
+
+
+// the lines written before are not indexed, rDebugSeekIndex::ranges() returns them always
+void rDebug_Filewriter::setSeekIndex( int BlockSize )
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  mIndexBlock = qMax( BlockSize, 0 );
+  if( !mFile.isOpen() )
+    return;
+  if( mIndexBlock && mFile.compression() == rDebugFileIo::Plain )
+    mIndex.open( mFile.fileName(), mFile.size(), mIndexBlock );
+  else
+    mIndex.close();
+}
+
+
+// plain lines and gzip frames must not share a file, so a change rotates the open one
+void rDebug_Filewriter::setCompression( rDebugFileIo::Compression Mode, int FrameBytes, int FrameMs )
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  const rDebugFileIo::Compression Old = mFile.compression();
+  mFile.setCompression( Mode, FrameBytes, FrameMs );
+  if( !mFile.isOpen() || mFile.compression() == Old )
+    return;
+
+  const char *Who = "Compression";
+  const char *Reason = "~~~~~~~~~~ logfile rotated for the new compression ~~~~~~~~~~";
+  close( Who, Reason ); // the open file keeps its form, the new one comes with the next open()
+  rotate( mPeriodStamp, mFile.size() );
+  open( mFileName, Who, Reason );
+  enforce_retention();
+}
+
+
 void rDebug_Filewriter::enableCodeLocations( bool enable )
 {
-    rDebug_Filewriter::mDumpCodeLocation = enable;
+    rDebug_Filewriter::mDumpCodeLocation.store( enable, std::memory_order_relaxed );
+}
+
+
+static const int DurableLevels = static_cast<int>( rDebugLevel::rMsgType::Debug ) + 1;
+
+static unsigned durabilitySlot( rDebugLevel::rMsgType Level )
+{
+  const int L = static_cast<int>( Level );
+  return static_cast<unsigned>( ( L < 0 ) ? 0 : qMin( L, DurableLevels-1 ) ) * 2;
+}
+
+
+void rDebug_Filewriter::setDurability( rDebugLevel::rMsgType Level, Durability D )
+{
+  quint32 Mask = 0, Bits = 0;
+  for( int L=0 ; L<=static_cast<int>( Level ) && L<DurableLevels ; ++L )
+  { Mask |= 3u << ( L * 2 );
+    Bits |= static_cast<quint32>( D ) << ( L * 2 );
+  }
+  quint32 Old = rDebug_Filewriter::mDurability.load( std::memory_order_relaxed );
+  while( !rDebug_Filewriter::mDurability.compare_exchange_weak( Old, ( Old & ~Mask ) | Bits, std::memory_order_relaxed ) )
+    ;
+}
+
+
+rDebug_Filewriter::Durability rDebug_Filewriter::durability( rDebugLevel::rMsgType Level )
+{
+  return static_cast<Durability>( ( rDebug_Filewriter::mDurability.load( std::memory_order_relaxed ) >> durabilitySlot( Level ) ) & 3u );
+}
+
+
+bool rDebug_Filewriter::anyDurable()
+{
+  const quint32 All = rDebug_Filewriter::mDurability.load( std::memory_order_relaxed );
+  return ( All & 0xAAAA ) != 0; // the high bit of a level is set for Synced and DSynced
 }
 
 
 
-void rDebug_Filewriter::write_file(const FileLineFunc_t& CodeLocation, const QDateTime& Time, rDebugLevel::rMsgType Level, uint64_t LogId, const QString& line)
+void rDebug_Filewriter::write_file(const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields,
+                                   rDebugRendered* Heads)
 {
-  if( rDebug_Filewriter::mMaxLevel < Level )
+  if( rDebug_Filewriter::mMaxLevel.load( std::memory_order_relaxed ) < Level )
+  { rDebugStats::countSink( rDebugStats::SinkFile, true );
+    return;
+  }
+  if( SkipOutputByPreprocessor( Level ) )
     return;
+
+  qint64 Ticket;
+  {
+    std::lock_guard<std::mutex> Lock( mLock );
+    if( !mFile.isOpen() )
+      return;
+
+    rotate_ondemand();
+    rDebugStats::countSink( rDebugStats::SinkFile, false );
+
+    write_line( CodeLocation, Time, Level, LogId, line, Fields, Heads );
+    Ticket = mSyncTicket;
+    mSyncTicket = 0;
+  }
+  if( Ticket )
+    sync_up_to( Ticket );
+}
+
+
+void rDebug_Filewriter::write_file_raw(const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields)
+{
+  qint64 Ticket;
+  {
+    std::lock_guard<std::mutex> Lock( mLock );
+    if( !mFile.isOpen() )
+      return;
+
+    write_line( CodeLocation, Time, Level, LogId, line, Fields );
+    Ticket = mSyncTicket;
+    mSyncTicket = 0;
+  }
+  if( Ticket )
+    sync_up_to( Ticket );
+}
+
+
+// mLock is held by the caller
+void rDebug_Filewriter::write_line(const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields,
+                                   rDebugRendered* Heads)
+{
   if( SkipOutputByPreprocessor( Level ) )
     return;
 
-  rotate_ondemand();
+  if( mFormat == JsonLines )
+    write_json_line( CodeLocation, Time, Level, LogId, line, Fields );
+  else if( Heads )
+    write_text_line( CodeLocation, Time, Level, LogId, line, Fields, *Heads );
+  else
+  { rDebugRendered Own; // a line not coming from rDebugBase::output(), like the one of write_wrap()
+    write_text_line( CodeLocation, Time, Level, LogId, line, Fields, Own );
+  }
 
-  write_file_raw( CodeLocation, Time, Level, LogId, line );
+  if( mIndex.isOpen() )
+    mIndex.line( mFile.size(), Time, static_cast<int>( Level ), LogId );
 }
 
 
-/* ToDo:
- * support QT_MESSAGE_PATTERN environment variable.
+/* with a message pattern (setMessagePattern() or QT_MESSAGE_PATTERN environment variable),
+ * the layout is fully given by the pattern, else the classic one.
  * For example: QT_MESSAGE_PATTERN="[%{type}] %{appname} (%{file}:%{line}) - %{message}"
  */
-void rDebug_Filewriter::write_file_raw(const FileLineFunc_t& CodeLocation, const QDateTime& Time, rDebugLevel::rMsgType Level, uint64_t LogId, const QString& line)
+void rDebug_Filewriter::write_text_line(const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields,
+                                        rDebugRendered& Heads)
 {
-  if( SkipOutputByPreprocessor( Level ) )
+  std::string& Line = mScratch; // UTF-8, goes as it is into the file
+  Line.clear();
+
+  if( !mPattern.isEmpty() )
+  {
+    mPattern.render( Line, CodeLocation, Time, Level, LogId, line );
+    rDebugBase::appendFieldsText( Line, Fields );
+    Line += '\n';
+    mFile.append( Line );
+    line_written( static_cast<int>( Line.size() ), Level );
     return;
+  }
+
+  // classic layout: header, message and tail go as segments into the file buffers,
+  // the message is not copied into a line first, the header is the one shared with qDebug()
+  rDebugBase::renderClassicHead( Heads, rDebugRendered::LogIdPlain, CodeLocation, Time, Level, LogId );
+  const rDebugCore::Span Stem( Heads.part( rDebugRendered::Stem ) );
+  const rDebugCore::Span Head( Heads.part( rDebugRendered::LogIdPlain ) );
+  rDebugCore::append( mFile, Stem );
+  rDebugCore::append( mFile, Head );
+  int Bytes = static_cast<int>( Stem.size() + Head.size() );
+
+  rDebugCore::append( mFile, line );
+  Bytes += static_cast<int>( line.size() );
+
+  rDebugBase::appendFieldsText( Line, Fields );
+  if( rDebug_Filewriter::mDumpCodeLocation.load( std::memory_order_relaxed ) )
+  {
+    Line += " {from ";
+    Line += ( CodeLocation.mFunc ? CodeLocation.mFunc : "func" );
+    Line += " in ";
+    Line += ( CodeLocation.mFile ? CodeLocation.mFile : "file" );
+    Line += ':';
+    rDebugArgs::appendInt( Line, CodeLocation.mLine, 10 );
+    Line += '}';
+  }
+  Line += '\n';
+  mFile.append( Line );
+  Bytes += static_cast<int>( Line.size() );
+
+  line_written( Bytes, Level );
+}
+
+
+// one JSON object per line, written as UTF-8 bytes without any QTextStream/QJsonDocument in between.
+// file, line and func are always part of the record, regardless of enableCodeLocations().
+void rDebug_Filewriter::write_json_line(const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields)
+{
+  std::string& Json = mScratch;
+  Json.clear();
+
+  Json.append( "{\"ts\":\"" );
+  rDebugCore::appendTime( Json, Time, true );
+  Json.append( "\",\"level\":\"" );
+  Json.append( rDebugBase::getLevelKey( Level ) );
+  Json.append( "\",\"logid\":" );
+  rDebugCore::appendUInt( Json, LogId );
+  Json.append( ",\"file\":" );
+  if( CodeLocation.mFile )
+    rDebugJson::appendString( Json, CodeLocation.mFile, strlen( CodeLocation.mFile ) );
+  else
+    Json.append( "null" );
+  Json.append( ",\"line\":" );
+  rDebugArgs::appendInt( Json, CodeLocation.mLine, 10 );
+  Json.append( ",\"func\":" );
+  if( CodeLocation.mFunc )
+    rDebugJson::appendString( Json, CodeLocation.mFunc, strlen( CodeLocation.mFunc ) );
+  else
+    Json.append( "null" );
+  Json.append( ",\"tid\":" );
+  rDebugCore::appendUInt( Json, CodeLocation.mThreadId );
+  Json.append( ",\"thread\":" );
+  char Tmp[rDebugThread::NameChars];
+  const rDebugCore::Span Name( rDebugThread::nameOf( CodeLocation.mThreadName, CodeLocation.mThreadId, Tmp ) );
+  rDebugJson::appendString( Json, Name.data(), Name.size() );
+  Json.append( ",\"seq\":" );
+  rDebugCore::appendUInt( Json, CodeLocation.mSeq );
+  Json.append( ",\"msg\":" );
+  rDebugJson::appendString( Json, line.data(), line.size() );
+
+  for( size_t i=0 ; i<Fields.size() ; ++i )
+  {
+    const std::string& Key   = Fields[i].mKey;
+    const std::string& Value = Fields[i].mValue;
+    Json += ',';
+    rDebugJson::appendString( Json, Key.data(), Key.size() );
+    Json += ':';
+    if( Fields[i].mNumeric )
+      Json += Value;
+    else
+      rDebugJson::appendString( Json, Value.data(), Value.size() );
+  }
+  Json.append( "}\n" );
+
+  mFile.append( Json );
+  line_written( static_cast<int>( Json.size() ), Level );
+}
+
+
+// mLock is held by the caller. A line written directly goes to the kernel now (or later, if Buffered),
+// the lines of the rDebug_AsyncWriter worker stay in the buffers until endBatch().
+// A Synced line leaves a ticket in mSyncTicket, the caller waits for it by sync_up_to() after unlocking.
+void rDebug_Filewriter::line_written( int Bytes, rDebugLevel::rMsgType Level )
+{
+  mWrittenTotal += Bytes;
+  const Durability D = durability( Level );
+  bool Submit = false;
+  if( rDebug_Filewriter::mBatchThisThread )
+  {
+    if( D >= Synced )
+      mSyncAtBatchEnd = true;
+  }
+  else if( D == DSynced )
+  {
+    mFile.submitDSync();
+    rDebugStats::countSync();
+    Submit = true;
+  }
+  else if( D != Buffered )
+  {
+    mFile.submit( true );
+    Submit = true;
+    if( D == Synced )
+      mSyncTicket = mWrittenTotal;
+  }
+  rDebugStats::countFileWrite( static_cast<quint64>( Bytes ), Submit );
+}
 
-  QTextStream WholeMsg( mpLogfile );
-  WholeMsg.setCodec("UTF-8");
-  WholeMsg.setAutoDetectUnicode(true);
-
-  WholeMsg << QString("%1 [%2] %3, %4") \
-                  .arg( rDebugBase::getDateTimeStr( Time ) ) \
-                  .arg( rDebugBase::getLevelName( Level ) ) \
-                  .arg( rDebugBase::getLogIdStr( LogId, 0 ) ) \
-                  .arg( line ) \
-                  ;
-  if( rDebug_Filewriter::mDumpCodeLocation )
+
+// group commit: the first thread in does the fdatasync() for all bytes written up to then,
+// the threads coming in meanwhile wait for it and then are done, or do the next one together.
+// mLock is held only to submit and to take the descriptor, not during the fdatasync().
+void rDebug_Filewriter::sync_up_to( qint64 Ticket )
+{
+  std::unique_lock<std::mutex> Lock( mSyncLock );
+  while( mSyncedUpTo < Ticket )
+  {
+    if( mSyncing )
+    { mSyncDone.wait( Lock );
+      continue;
+    }
+    mSyncing = true;
+    Lock.unlock();
+
+    qint64 UpTo;
+    std::shared_ptr<const int> pFd;
+    {
+      std::lock_guard<std::mutex> FileLock( mLock );
+      mFile.submit( true );
+      UpTo = mWrittenTotal;
+      pFd  = mFile.syncHandle(); // stays valid, even if the file is rotated meanwhile
+    }
+    if( pFd )
+      rDebugFileIo::datasync( *pFd );
+    rDebugStats::countSync();
+
+    Lock.lock();
+    mSyncing = false;
+    mSyncedUpTo = qMax( mSyncedUpTo, UpTo );
+    mSyncDone.notify_all();
+  }
+}
+
+
+void rDebug_Filewriter::endBatch()
+{
+  rDebug_SinkSlot<rDebug_Filewriter>::Use pFile( rDebug_Filewriter::pFilewriter );
+  if( !pFile )
+    return;
+  std::lock_guard<std::mutex> Lock( pFile->mLock );
+  if( pFile->mSyncAtBatchEnd )
   {
-    WholeMsg << QString(" {from %1 in %2:%3}") \
-                  .arg( CodeLocation.mFunc ? CodeLocation.mFunc : "func" ) \
-                  .arg( CodeLocation.mFile ? CodeLocation.mFile : "file" ) \
-                  .arg( CodeLocation.mLine ) \
-                  ;
+    pFile->mSyncAtBatchEnd = false;
+    pFile->mFile.sync();
+    rDebugStats::countSync();
+    rDebugStats::countFileWrite( 0, true );
+    return;
   }
-  WholeMsg << QString("\n");
-  WholeMsg.flush();
+  if( !pFile->mFile.pending() )
+    return;
+  pFile->mFile.submit();
+  rDebugStats::countFileWrite( 0, true );
+}
+
+
+void rDebug_Filewriter::idle()
+{
+  rDebug_SinkSlot<rDebug_Filewriter>::Use pFile( rDebug_Filewriter::pFilewriter );
+  if( !pFile )
+    return;
+  std::lock_guard<std::mutex> Lock( pFile->mLock );
+  if( pFile->mFile.frameDue() )
+    pFile->mFile.submit(); // closes the frame first
 }
 
 
 void rDebug_Filewriter::write_wrap(const char* Location, const char* Reason)
 {
   FileLineFunc_t here(__FILE__, __LINE__, Location);
-  QDateTime Now( QDate::currentDate(), QTime::currentTime(), Qt::LocalTime );
-  write_file_raw( here, Now, rDebugLevel::rMsgType::Notice, 0, Reason );
+  here.mThreadId   = rDebugThread::id();
+  here.mThreadName = rDebugThread::name();
+  write_line( here, rDebugCore::now(), rDebugLevel::rMsgType::Notice, 0, rDebugCore::Span::of( Reason ), rDebugFields() );
 }
 
 
 void rDebug_Filewriter::write_BOM()
 {
-  QTextStream Header( mpLogfile );
-  Header.setCodec("UTF-8");
-  Header.setGenerateByteOrderMark(true);
-  Header << QString("\n"); // without this, we don't get the BOM and would need to refactor write_wrap() to write the BOM in case of opening wrap only ...
-  Header.flush();
+  mFile.append( "\xEF\xBB\xBF\n", 4 ); // the UTF-8 BOM, and a newline, so the opening wrap gets an own line
 }
 
 
 void rDebug_Filewriter::open(const QString& fileName, const char* Location, const char* Reason)
 {
-  mpLogfile = new QFile(fileName);
-  bool newFile = ( 0==mpLogfile->size() );
-  mpLogfile->open(QIODevice::Append | QIODevice::Text);
-  if(newFile)
+  if( !mFile.open( fileName, mIoBackend ) )
+    return;
+  bool newFile = ( 0==mFile.size() );
+  mFileTime = newFile ? QDateTime::currentDateTime() : QFileInfo( fileName ).lastModified();
+  if( mIndexBlock && mFile.compression() == rDebugFileIo::Plain )
+    mIndex.open( fileName, mFile.size(), mIndexBlock );
+  if( newFile && mFormat==PlainText ) // a BOM in front of the first JSON object would break most JSONL readers
     write_BOM();
   write_wrap( Location, Reason );
 }
@@ -336,8 +742,10 @@ void rDebug_Filewriter::open(const QString& fileName, const char* Location, cons
 void rDebug_Filewriter::close(const char* Location, const char* Reason)
 {
   write_wrap( Location, Reason );
-  mpLogfile->close();
-  mpLogfile = nullptr;
+  if( anyDurable() ) // the last Synced line must not wait for the next one
+    mFile.sync();
+  mFile.close();
+  mIndex.close();
 }
 
 
@@ -346,6 +754,14 @@ bool rDebug_Filewriter::appendFiles( const QString& SourceFile, const QString& D
     QFile SourceF( SourceFile );
     bool okay=false;
 
+    if( mFile.compression() != rDebugFileIo::Plain ) // gzip frames are appended as they are
+    {
+        QFile DestinF( DestinationFile );
+        if( SourceF.open( QIODevice::ReadOnly ) && DestinF.open( QIODevice::WriteOnly | QIODevice::Append ) )
+            okay = ( DestinF.write( SourceF.readAll() ) == SourceF.size() );
+        return okay;
+    }
+
     if( SourceF.open( QIODevice::ReadOnly | QIODevice::Text ) )
     {
         QTextStream SrcStream( &SourceF );
@@ -371,8 +787,9 @@ bool rDebug_Filewriter::appendFiles( const QString& SourceFile, const QString& D
 void rDebug_Filewriter::move( const QString& NewfileName )
 {
     const char *Who = "LogMove";
+    std::lock_guard<std::mutex> Lock( mLock );
 
-    QFileInfo OldLogFile( mpLogfile->fileName() );
+    QFileInfo OldLogFile( mFile.isOpen() ? mFile.fileName() : mFileName );
     QFileInfo NewLogFile( NewfileName );
     QString OldLogFileName( QDir::cleanPath( OldLogFile.absoluteFilePath() ) );
     QString NewLogFileName( QDir::cleanPath( NewLogFile.absoluteFilePath() ) );
@@ -380,7 +797,7 @@ void rDebug_Filewriter::move( const QString& NewfileName )
     const QString CloseReason( QString("~~~~~~~~~~ logfile moved to new location (%1) ~~~~~~~~~~").arg(NewLogFileName) );
     const QString OpenReason(  QString("~~~~~~~~~~ logfile moved to new location from (%1) ~~~~~~~~~~").arg(OldLogFileName) );
 
-    if( !mpLogfile )
+    if( !mFile.isOpen() )
     {
         open( NewfileName, Who, OpenReason.toUtf8().constData() );
     }
@@ -397,57 +814,66 @@ void rDebug_Filewriter::move( const QString& NewfileName )
             if( appendFiles( OldLogFileName, NewLogFileName ) )
             {
                 QFile::remove( OldLogFileName );
+                QFile::remove( rDebugSeekIndex::indexName( OldLogFileName ) );
             }
+            mFileName = NewLogFileName; // rotation goes on at the new location
+            mBackups.scan( mFileName );
             open( NewLogFileName, Who, OpenReason.toUtf8().constData() );
         }
     }
 }
 
 
-void rDebug_Filewriter::rotate(void)
+// Stamp: the period of the closed file (Daily, Hourly), empty for Numbered
+void rDebug_Filewriter::rotate( const QString& Stamp, qint64 Size )
+{
+  mBackups.rotate( mRotation, mMaxBackups, Stamp, Size );
+  rDebugStats::countRotation();
+}
+
+
+void rDebug_Filewriter::rotate_ondemand(void)
 {
-  const int32_t MinBackupIndex = 1;
-  QFileInfo fi( mFileName );
-  int32_t Index = MinBackupIndex;
-  for( ; Index<mMaxBackups ; ++Index )
+  const bool PeriodOver = ( mRotation != rDebugRetention::Numbered )
+                       && ( QDateTime::currentMSecsSinceEpoch() >= mPeriodEndMs );
+  if( !PeriodOver && !oversized() )
+    return;
+
+  const QString Stamp = mPeriodStamp; // the one the lines up to now belong to
+  if( PeriodOver )
+    next_period( QDateTime::currentDateTime() );
+
+  bool isopen = mFile.isOpen();
+  if( isopen )
   {
-    QFileInfo probe( fi.path() + '/' + fi.completeBaseName() + QString(".%1.").arg(Index) + fi.suffix() );
-    if( ! probe.exists() )
-      break;
+    const char *Who = "Rotator";
+    const char *Reason = "~~~~~~~~~~ logfile rotated ~~~~~~~~~~";
+    close( Who, Reason );
+
+    rotate( Stamp, mFile.size() );
+
+    open( mFileName, Who, Reason );
+    enforce_retention();
   }
-  // Index is last used backup + 1 now
-  for( ; Index>(MinBackupIndex-1) ; --Index )
+  else
   {
-    QString free_file( fi.path() + '/' + fi.completeBaseName() + QString(".%1.").arg(Index  ) + fi.suffix() );
-    QString used_file( fi.path() + '/' + fi.completeBaseName() + QString(".%1.").arg(Index-1) + fi.suffix() );
-    if( Index==MinBackupIndex )
-      used_file = mFileName;
-
-    QFile( used_file ).rename( free_file );
+    rotate( Stamp, QFileInfo( mFileName ).size() );
   }
 }
 
 
-void rDebug_Filewriter::rotate_ondemand(void)
+void rDebug_Filewriter::next_period( const QDateTime& Time )
 {
-  if( oversized( *mpLogfile ) )
-  {
-    bool isopen = ( mpLogfile && mpLogfile->isOpen() ) ? true : false;
-    if( isopen )
-    {
-      const char *Who = "Rotator";
-      const char *Reason = "~~~~~~~~~~ logfile rotated ~~~~~~~~~~";
-      close( Who, Reason );
+  mPeriodStamp = rDebugRetention::stamp( mRotation, Time );
+  mPeriodEndMs = rDebugRetention::periodEnd( mRotation, Time ).toMSecsSinceEpoch();
+}
 
-      rotate();
 
-      open( mFileName, Who, Reason );
-    }
-    else
-    {
-      rotate();
-    }
-  }
+// the count of numbered backups is kept by the rotation itself
+void rDebug_Filewriter::enforce_retention()
+{
+  const int MaxCount = ( mRotation == rDebugRetention::Numbered ) ? 0 : mMaxBackups;
+  mBackups.enforce( mFile.isOpen() ? mFile.size() : 0, mRetentionBudget, MaxCount );
 }
 
 
@@ -460,156 +886,643 @@ bool rDebug_Filewriter::oversized( const QString& fileName )
 }
 
 
-bool rDebug_Filewriter::oversized( QFile& openedFile )
+// the size is counted by mFile, no stat() per line
+bool rDebug_Filewriter::oversized()
 {
-  QFileInfo fi( openedFile );
-  if( fi.isReadable() && fi.size() > (mMaxSize - 128) ) // 128 bytes reserve to enshure the "closed/rolled" entry fits also
+  if( mFile.isOpen() && mFile.size() > (mMaxSize - 128) ) // 128 bytes reserve to enshure the "closed/rolled" entry fits also
       return true;
   return false;
 }
 
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+// the ring of one logging thread. The thread owns the producer side, the worker the consumer side.
+struct rDebug_AsyncWriter::ThreadRing
+{
+  explicit ThreadRing( int Capacity )
+    : mRing( Capacity, rDebugRecord( "", 0, "", rDebugLevel::rMsgType::Debug, 0, false ) )
+    , mClosed(false)
+    , mBytesIn(0)
+    , mBytesOut(0)
+  {}
+
+  // the slot for a line of Bytes, nullptr if the ring is full or over its share of the memory limit
+  rDebugRecord* roomFor( quint64 Bytes, qint64 Limit )
+  {
+    if( Limit > 0 && mBytesIn.load( std::memory_order_relaxed ) - mBytesOut.load( std::memory_order_acquire ) + Bytes > static_cast<quint64>( Limit )
+     && mRing.size() > 0 ) // one line always fits
+      return nullptr;
+    return mRing.back();
+  }
+
+  rDebugRing<rDebugRecord> mRing;
+  std::atomic<bool>        mClosed;   // the thread has ended, the worker forgets the ring, when it is empty
+  char                     mPadIn[64];
+  std::atomic<quint64>     mBytesIn;  // written by the logging thread
+  char                     mPadOut[64 - sizeof(std::atomic<quint64>)];
+  std::atomic<quint64>     mBytesOut; // written by the worker
+};
+
+
+// thread_local, so the DTor runs at the end of the thread and flushes what the thread has logged
+struct rDebug_AsyncWriter::RingOfThread
+{
+  RingOfThread() : mGeneration(0) {}
+  ~RingOfThread()
+  {
+    if( !mpRing )
+      return;
+    mpRing->mClosed.store( true );
+    rDebug_SinkSlot<rDebug_AsyncWriter>::Use pAsync( rDebug_AsyncWriter::pAsyncWriter );
+    if( pAsync && pAsync->mGeneration == mGeneration )
+      pAsync->flushRing( mpRing );
+  }
+  quint64                     mGeneration;
+  std::shared_ptr<ThreadRing> mpRing;
+};
+
+
+rDebug_SinkSlot<rDebug_AsyncWriter> rDebug_AsyncWriter::pAsyncWriter;
+thread_local bool     rDebug_AsyncWriter::mDeferThisThread = false;
+thread_local rDebug_AsyncWriter::RingOfThread rDebug_AsyncWriter::mRingOfThisThread;
+std::atomic<quint64>  rDebug_AsyncWriter::mLastGeneration( 0 );
+
+
+rDebug_AsyncWriter::rDebug_AsyncWriter( int MaxQueued, OverflowPolicy Overflow, Queueing Mode )
+  : mMaxQueued( qMax( MaxQueued, 16 ) )
+  , mOverflow(Overflow)
+  , mMode(Mode)
+  , mGeneration( mLastGeneration.fetch_add( 1 ) + 1 )
+  , mEnqueued(0)
+  , mWritten(0)
+  , mDropped(0)
+  , mQueuedMax(0)
+  , mStopping(false)
+  , mQueuedBytes(0)
+  , mMemoryLimit( 0x4000000 )
+  , mRingLimit( 0x4000000 )
+  , mRingDropped(0)
+  , mCollectorSleeps(false)
+  , mWorker(this)
+{
+  mWorker.start();
+  rDebug_AsyncWriter::pAsyncWriter.set( this );
+}
+
+
+rDebug_AsyncWriter::~rDebug_AsyncWriter()
+{
+  rDebug_AsyncWriter::pAsyncWriter.reset( this ); // new lines go directly to the sinks from now on
+  {
+    std::lock_guard<std::mutex> Lock( mLock );
+    mStopping = true;        // from now on, enqueue() refuses and the lines are written directly
+    mNotEmpty.notify_all();
+    mNotFull.notify_all();
+  }
+  mWorker.wait();            // the worker drains the queue before it ends
+}
+
+
+void rDebug_AsyncWriter::setDeferredFormatting( bool enable )
+{
+  rDebug_AsyncWriter::mDeferThisThread = enable;
+}
+
+
+bool rDebug_AsyncWriter::deferredFormatting()
+{
+  return rDebug_AsyncWriter::mDeferThisThread;
+}
+
+
+void rDebug_AsyncWriter::setMemoryLimit( qint64 Bytes )
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  mMemoryLimit.store( qMax<qint64>( Bytes, 0 ) );
+  shareMemoryLimit();
+  mNotFull.notify_all();
+}
+
+
+qint64 rDebug_AsyncWriter::memoryLimit() const
+{
+  return mMemoryLimit.load();
+}
+
+
+void rDebug_AsyncWriter::shareMemoryLimit()
+{
+  mRingLimit.store( mMemoryLimit.load() / qMax( static_cast<qint64>( mRings.size() ), static_cast<qint64>( 1 ) ) );
+}
+
+
+quint64 rDebug_AsyncWriter::dropped() const
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  return mDropped + mRingDropped.load( std::memory_order_relaxed );
+}
+
+
+quint64 rDebug_AsyncWriter::queued() const
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  quint64 Queued = static_cast<quint64>( mQueue.size() );
+  for( size_t i=0 ; i<mRings.size() ; ++i )
+    Queued += static_cast<quint64>( mRings[i]->mRing.size() );
+  return Queued;
+}
+
+
+quint64 rDebug_AsyncWriter::queuedMax() const
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  return mQueuedMax;
+}
+
+
+void rDebug_AsyncWriter::flush()
+{
+  if( QThread::currentThread() == &mWorker ) // a sink logging itself, would wait for its own
+    return;
+
+  std::unique_lock<std::mutex> Lock( mLock );
+  if( mMode == PerThreadRings )
+  {
+    const std::vector< std::shared_ptr<ThreadRing> > Rings = mRings;
+    std::vector<quint32> Targets;
+    for( size_t i=0 ; i<Rings.size() ; ++i )
+      Targets.push_back( Rings[i]->mRing.head() );
+    mNotEmpty.notify_one();
+    for( size_t i=0 ; i<Rings.size() ; ++i )
+      while( static_cast<qint32>( Targets[i] - Rings[i]->mRing.tail() ) > 0 )
+        mDrained.wait_for( Lock, std::chrono::milliseconds( 10 ) );
+    return;
+  }
+
+  const quint64 Target = mEnqueued;
+  while( mWritten < Target )
+    mDrained.wait( Lock );
+}
+
+
+void rDebug_AsyncWriter::flushRing( const std::shared_ptr<ThreadRing>& pRing )
+{
+  std::unique_lock<std::mutex> Lock( mLock );
+  const quint32 Target = pRing->mRing.head();
+  mNotEmpty.notify_one();
+  while( static_cast<qint32>( Target - pRing->mRing.tail() ) > 0 )
+    mDrained.wait_for( Lock, std::chrono::milliseconds( 10 ) );
+}
+
+
+void rDebug_AsyncWriter::wakeCollector()
+{
+  std::lock_guard<std::mutex> Lock( mLock );
+  mNotEmpty.notify_one();
+}
+
+
+bool rDebug_AsyncWriter::enqueue( rDebugRecord& Record )
+{
+  if( mMode == PerThreadRings )
+    return enqueueRing( Record );
+
+  std::unique_lock<std::mutex> Lock( mLock );
+  const bool fromWorker = ( QThread::currentThread() == &mWorker ); // must never block itself
+  const qint64 Bytes = Record.payloadBytes();
+  const qint64 Limit = mMemoryLimit.load();
+  while( !mStopping && !fromWorker
+      && ( static_cast<int>( mQueue.size() ) >= mMaxQueued || ( Limit > 0 && mQueuedBytes + Bytes > Limit && !mQueue.empty() ) ) )
+  {
+    if( mOverflow == Drop )
+    { ++mDropped;
+      return true;
+    }
+    mNotFull.wait( Lock );
+  }
+  if( mStopping )
+    return false;
+
+  mQueue.push_back( std::move( Record ) );
+  if( !mPool.empty() ) // the buffers of a written line, so the spare buffers of this thread are not gone
+  { Record.swapBuffers( mPool.back().mMsg, mPool.back().mBlob );
+    mPool.pop_back();
+  }
+  mQueuedBytes += Bytes;
+  if( static_cast<quint64>( mQueue.size() ) > mQueuedMax )
+    mQueuedMax = static_cast<quint64>( mQueue.size() );
+  ++mEnqueued;
+  mNotEmpty.notify_one();
+  return true;
+}
+
+
+rDebug_AsyncWriter::ThreadRing* rDebug_AsyncWriter::ringOfThisThread()
+{
+  RingOfThread& Mine = rDebug_AsyncWriter::mRingOfThisThread;
+  if( !Mine.mpRing || Mine.mGeneration != mGeneration )
+  {
+    if( Mine.mpRing )
+      Mine.mpRing->mClosed.store( true ); // a ring of an earlier writer
+    Mine.mpRing = std::make_shared<ThreadRing>( mMaxQueued );
+    Mine.mGeneration = mGeneration;
+    std::lock_guard<std::mutex> Lock( mLock );
+    mRings.push_back( Mine.mpRing );
+    shareMemoryLimit();
+  }
+  return Mine.mpRing.get();
+}
+
+
+// lock free for the logging thread, as long as the worker keeps up with it
+bool rDebug_AsyncWriter::enqueueRing( const rDebugRecord& Record )
+{
+  if( QThread::currentThread() == &mWorker ) // a sink logging itself, the worker is the only consumer
+    return false;
+
+  ThreadRing* pRing = ringOfThisThread();
+  const quint64 Bytes = static_cast<quint64>( Record.payloadBytes() );
+  rDebugRecord* pSlot;
+  int Spins = 0;
+  while( !( pSlot = pRing->roomFor( Bytes, mRingLimit.load( std::memory_order_relaxed ) ) ) )
+  {
+    if( mOverflow == Drop )
+    { mRingDropped.fetch_add( 1, std::memory_order_relaxed );
+      return true;
+    }
+    if( mStopping.load() )
+      return false;
+    if( mCollectorSleeps.load() ) // mLock only to wake it, not on each round
+      wakeCollector();
+    if( ++Spins < 64 )
+      QThread::yieldCurrentThread();
+    else // the collector is busy with a lot of lines, no need to burn a core while waiting for it
+      std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+  }
+  pSlot->assignReusing( Record );
+  pRing->mBytesIn.store( pRing->mBytesIn.load( std::memory_order_relaxed ) + Bytes, std::memory_order_relaxed );
+  pRing->mRing.commit();
+  if( mCollectorSleeps.load() ) // else it sees the line on its next round (10 ms at most)
+    wakeCollector();
+  return true;
+}
+
+
+void rDebug_AsyncWriter::run()
+{
+  rDebug_Filewriter::mBatchThisThread = true; // the file sink submits once per batch, see endBatch()
+  if( mMode == PerThreadRings )
+  {
+    runRings();
+    return;
+  }
+
+  std::vector<rDebugRecord> Batch; // swapped with mQueue, so both keep their capacity
+  std::unique_lock<std::mutex> Lock( mLock );
+  for(;;)
+  {
+    while( mQueue.empty() && !mStopping )
+      if( mNotEmpty.wait_for( Lock, std::chrono::seconds( 1 ) ) == std::cv_status::timeout ) // nothing for a second, time to close a gzip frame
+      { Lock.unlock();
+        rDebug_Filewriter::idle();
+        Lock.lock();
+      }
+    if( mQueue.empty() ) // && mStopping
+      break;
+
+    Batch.swap( mQueue );
+    mQueuedBytes = 0;
+    mNotFull.notify_all();
+    Lock.unlock();
+
+    for( size_t i=0 ; i<Batch.size() ; ++i )
+    {
+      rDebugRecord& Record = Batch[i];
+      Record.finish(); // deferred formatting happens here
+      rDebugBase::output( Record );
+      rDebugStats::countLatency( rDebugStats::HistEnqueueToWrite, Record.mEnqueueNs );
+      Record.recycle(); // drops the buffers above 1 KiB
+    }
+    rDebug_Filewriter::endBatch();
+
+    Lock.lock();
+    mWritten += static_cast<quint64>( Batch.size() );
+    for( size_t i=0 ; i<Batch.size() && mPool.size() < static_cast<size_t>( mMaxQueued ) ; ++i )
+    {
+      mPool.push_back( Buffers() );
+      Batch[i].swapBuffers( mPool.back().mMsg, mPool.back().mBlob );
+      mPool.back().mMsg.clear();
+      mPool.back().mBlob.clear();
+    }
+    Batch.clear();
+    mDrained.notify_all();
+  }
+}
+
+
+// the collector of the PerThreadRings mode
+void rDebug_AsyncWriter::runRings()
+{
+  int Idle = 0; // sleeps of 10 ms, idle() after 100 of them
+  std::vector< std::shared_ptr<ThreadRing> > Rings;
+  std::unique_lock<std::mutex> Lock( mLock );
+  for(;;)
+  {
+    Rings = mRings;
+    const bool Stopping = mStopping; // no more lines then, pAsyncWriter.reset() has waited for all users
+    quint64 Queued = 0;
+    for( size_t i=0 ; i<Rings.size() ; ++i )
+      Queued += static_cast<quint64>( Rings[i]->mRing.size() );
+    if( Queued > mQueuedMax )
+      mQueuedMax = Queued;
+    Lock.unlock();
+
+    const int Written = mergeRings( Rings );
+    if( Written )
+      rDebug_Filewriter::endBatch();
+
+    Lock.lock();
+    mWritten += static_cast<quint64>( Written );
+    mDrained.notify_all();
+    for( int i=static_cast<int>( mRings.size() )-1 ; i>=0 ; --i ) // forget the rings of ended threads
+      if( mRings[i]->mClosed.load() && mRings[i]->mRing.size() == 0 )
+      { mRings.erase( mRings.begin() + i );
+        shareMemoryLimit();
+      }
+    if( Written )
+      continue;
+    if( Stopping )
+      break;
+    mCollectorSleeps.store( true );
+    if( mNotEmpty.wait_for( Lock, std::chrono::milliseconds( 10 ) ) == std::cv_status::timeout && ++Idle >= 100 )
+    { Lock.unlock();
+      rDebug_Filewriter::idle();
+      Lock.lock();
+      Idle = 0;
+    }
+    mCollectorSleeps.store( false );
+  }
+}
+
+
+// writes the lines, which are in the rings now, the oldest sequence number first.
+// A min-heap of the ring fronts, keyed by the sequence number: log(threads) per line.
+// Each ring is in order on its own, so only its next front goes back into the heap.
+int rDebug_AsyncWriter::mergeRings( const std::vector< std::shared_ptr<ThreadRing> >& Rings )
+{
+  typedef std::pair<quint64,int> Front; // sequence number, ring
+  std::vector<Front> Heap;
+  Heap.reserve( Rings.size() );
+  std::vector<int> Left( Rings.size() );
+  for( size_t i=0 ; i<Rings.size() ; ++i )
+  {
+    Left[i] = Rings[i]->mRing.size(); // not more, else a busy thread could keep us here forever
+    if( Left[i] )
+      Heap.push_back( Front( Rings[i]->mRing.front()->mFileLineFunc.mSeq, static_cast<int>(i) ) );
+  }
+  std::make_heap( Heap.begin(), Heap.end(), std::greater<Front>() );
+
+  int Written = 0;
+  while( !Heap.empty() )
+  {
+    std::pop_heap( Heap.begin(), Heap.end(), std::greater<Front>() );
+    const int Oldest = Heap.back().second;
+    Heap.pop_back();
+
+    ThreadRing& Ring = *Rings[Oldest];
+    rDebugRecord& Record = *Ring.mRing.front();
+    const quint64 Bytes = static_cast<quint64>( Record.payloadBytes() );
+    Record.finish(); // deferred formatting happens here
+    rDebugBase::output( Record );
+    rDebugStats::countLatency( rDebugStats::HistEnqueueToWrite, Record.mEnqueueNs );
+    Record.recycle();
+    Ring.mRing.pop();
+    Ring.mBytesOut.store( Ring.mBytesOut.load( std::memory_order_relaxed ) + Bytes, std::memory_order_release );
+    ++Written;
+    if( --Left[Oldest] )
+    { Heap.push_back( Front( Ring.mRing.front()->mFileLineFunc.mSeq, Oldest ) );
+      std::push_heap( Heap.begin(), Heap.end(), std::greater<Front>() );
+    }
+  }
+  return Written;
+}
+
 /* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
 /* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
-rDebugLevel::rMsgType rDebugBase::mMaxLevel = SYSLOG_LEVEL_MAX;
+std::atomic<rDebugLevel::rMsgType>   rDebugBase::mMaxLevel( SYSLOG_LEVEL_MAX );
+std::shared_ptr<const rDebugPattern> rDebugBase::mPattern; // no QT_MESSAGE_PATTERN here, Qt applies it on its own to what we give to qDebug()
 
 
 rDebugBase::rDebugBase(const char *file, int line, const char* func, rDebugLevel::rMsgType Level, uint64_t LogId)
   : mBase(10)
-  , mFileLineFunc(file,line,func)
-  , mLevel(Level)
   , mFacility(SYSLOG_FACILITY)
-  , mTime( QDate::currentDate(), QTime::currentTime(), Qt::LocalTime )
-  , mLogId(LogId)
-  , mMsgBuffer("")
-  , mMsgStream(&mMsgBuffer)
-  , mWithLogId(SYSLOG_WITH_NUMERIC_8DIGITS_ID)
+  , mRecord(file, line, func, Level, LogId, SYSLOG_WITH_NUMERIC_8DIGITS_ID)
   , mSpace(true)
-{}
+  , mDeferred( rDebug_AsyncWriter::deferredFormatting() && rDebug_AsyncWriter::pAsyncWriter.isSet() )
+{
+  mRecord.borrowBuffers( mDeferred );
+}
 
 
 rDebugBase::~rDebugBase()
 {
-  if( SkipOutputByPreprocessor( mLevel ) )
+  deliver();
+  mRecord.returnBuffers();
+}
+
+
+void rDebugBase::deliver()
+{
+  if( SkipOutputByPreprocessor( mRecord.mLevel ) )
+    return;
+
+  const bool Filtered = !PassesGlobalLevel( mRecord.mFileLineFunc, mRecord.mLevel );
+  rDebugStats::countLine( mRecord.mLevel, Filtered );
+  if( Filtered )
     return;
 
-  output( mLevel );
+  // only for lines, which are going to be written, so a filtered line costs nothing here
+  mRecord.mFileLineFunc.mThreadId   = rDebugThread::id();
+  mRecord.mFileLineFunc.mThreadName = rDebugThread::name();
+  mRecord.mFileLineFunc.mSeq        = rDebugThread::nextSequence();
+  if( rDebugStats::enabled() )
+    rDebugStats::countCallSite( mRecord.mFileLineFunc.mFile, mRecord.mFileLineFunc.mLine, mRecord.mLevel );
+
+  {
+    rDebug_SinkSlot<rDebug_AsyncWriter>::Use pAsync( rDebug_AsyncWriter::pAsyncWriter );
+    if( pAsync )
+    {
+      if( !terminates( mRecord.mLevel ) && !rDebug_Filewriter::writesDirectly( mRecord.mLevel ) )
+      {
+        mRecord.mEnqueueNs = rDebugStats::startTimer();
+        if( pAsync->enqueue( mRecord ) )
+          return;
+      }
+      else
+      {
+        pAsync->flush(); // the lines before shall be written, before we abort() or sync
+      }
+    }
+  }
+
+  mRecord.finish();
+  output( mRecord );
 }
 
 
 void rDebugBase::setMaxLevel(rDebugLevel::rMsgType MaxLevel)
 {
-  rDebugBase::mMaxLevel = MaxLevel;
+  rDebugBase::mMaxLevel.store( MaxLevel, std::memory_order_relaxed );
 }
 
 
-void rDebugBase::output( rDebugLevel::rMsgType currLevel )
+// compiled aside and published as a whole, a line being written in parallel keeps the one it got
+void rDebugBase::setMessagePattern( const QString& Pattern )
 {
-  QSignalBackendWriter(currLevel );
-  QFileBackendWriter(  currLevel );
-  QDebugBackendWriter( currLevel ); // always need to be the last, because this one has the right of calling std::abort(), so the others need to be finished before
+  std::shared_ptr<const rDebugPattern> Compiled;
+  if( !Pattern.isEmpty() )
+    Compiled = std::make_shared<const rDebugPattern>( Pattern );
+  std::atomic_store( &rDebugBase::mPattern, Compiled );
 }
 
 
-/* ToDo:
- * support QT_MESSAGE_PATTERN environment variable.
- * For example: QT_MESSAGE_PATTERN="[%{type}] %{appname} (%{file}:%{line}) - %{message}"
+bool rDebugBase::terminates( rDebugLevel::rMsgType Level )
+{
+# if defined( QT_FATAL_WARNINGS )
+  return ( Level <= rDebugLevel::rMsgType::Warning );
+# else
+  return ( Level <= rDebugLevel::rMsgType::Alert );
+# endif
+}
+
+
+// the global level (and the rules of rDebugLevelRules) were checked by ~rDebugBase already
+// the classic line head is rendered once (on the first request) for the file sink and qDebug()
+void rDebugBase::output( rDebugRecord& Record )
+{
+  Record.chopTrailingSpace(); // the one of the last maybeSpace()
+  rDebugRendered Heads;
+  QSignalBackendWriter( Record );
+  QFileBackendWriter(   Record, Heads );
+  QDebugBackendWriter(  Record, Heads ); // always need to be the last, because this one has the right of calling std::abort(), so the others need to be finished before
+}
+
+
+// the line of QDebugBackendWriter, kept for the next line of the thread. Swapped out while in use,
+// so a line logged from within qDebug() (a message handler) gets an own one
+static thread_local std::string QDebugSpare;
+
+
+/* layout is the classic one, or the one given by setMessagePattern().
+ * note: QT_MESSAGE_PATTERN is not applied here, because Qt already applies it to all of qDebug()
+ *       and we would end up with a doubled decoration.
  */
-void rDebugBase::QDebugBackendWriter( rDebugLevel::rMsgType currLevel )
+void rDebugBase::QDebugBackendWriter( rDebugRecord& Record, rDebugRendered& Heads )
 {
-  if( rDebug_GlobalLevel::get() < currLevel )
+  if( rDebugBase::mMaxLevel.load( std::memory_order_relaxed ) < Record.mLevel )
+  { rDebugStats::countSink( rDebugStats::SinkQDebug, true );
     return;
+  }
 
-  if( rDebugBase::mMaxLevel < currLevel )
+  if( SkipOutputByPreprocessor( Record.mLevel ) )
     return;
 
-  if( SkipOutputByPreprocessor( currLevel ) )
-    return;
+  rDebugStats::countSink( rDebugStats::SinkQDebug, false );
+  const quint64 Started = rDebugStats::startTimer(); // the latency of an abort() is not of interest
+  std::string Line;
+  Line.swap( QDebugSpare );
+  Line.clear();
 
-  QString     mStringDevice("");
-  QTextStream WholeMsg( &mStringDevice );
-  WholeMsg.setCodec("UTF-8");
-  WholeMsg.setAutoDetectUnicode(true);
-
-  if( mWithLogId )
-      WholeMsg << QString("%1 [%2] %3, %4") \
-                  .arg( getDateTimeStr( mTime ) ) \
-                  .arg( getLevelName( mLevel ) ) \
-                  .arg( getLogIdStr( mLogId ) ) \
-                  .arg( mMsgBuffer ) ;
+  const std::shared_ptr<const rDebugPattern> Pattern( std::atomic_load( &rDebugBase::mPattern ) );
+  if( Pattern && !Pattern->isEmpty() )
+  {
+    Pattern->render( Line, Record.mFileLineFunc, Record.mTimeMs, Record.mLevel, Record.mLogId, Record.mMsg );
+  }
   else
-    WholeMsg << QString("%1 [%2] %4") \
-                  .arg( getDateTimeStr( mTime ) ) \
-                  .arg( getLevelName( mLevel ) ) \
-                  .arg( mMsgBuffer ) ;
-
-  WholeMsg.flush();
+  {
+    const rDebugRendered::Layout Part = ( Record.mWithLogId ) ? rDebugRendered::LogIdPadded : rDebugRendered::NoLogId;
+    renderClassicHead( Heads, Part, Record.mFileLineFunc, Record.mTimeMs, Record.mLevel, Record.mLogId );
+    rDebugCore::append( Line, Heads.part( rDebugRendered::Stem ) );
+    rDebugCore::append( Line, Heads.part( Part ) );
+    Line += Record.mMsg; // its trailing space is chopped by output() already
+  }
+  appendFieldsText( Line, Record.mFields );
 
-  if( mStringDevice.length()>1 && mStringDevice.endsWith(' ') )
-      mStringDevice.chop(1);
+  to_xDebug( Record.mLevel, Line );
+  rDebugStats::countLatency( rDebugStats::HistQDebugWrite, Started );
 
-  to_xDebug( mLevel, mStringDevice );
+  if( Line.capacity() <= 0x10000 ) // a huge one goes back to the heap
+    Line.swap( QDebugSpare );
 }
 
 
-void rDebugBase::QSignalBackendWriter( rDebugLevel::rMsgType currLevel )
+void rDebugBase::QSignalBackendWriter( rDebugRecord& Record )
 {
-  if( rDebug_GlobalLevel::get() < currLevel )
-    return;
-  if( SkipOutputByPreprocessor( currLevel ) )
+  if( SkipOutputByPreprocessor( Record.mLevel ) )
     return;
 
-  if( rDebug_Signaller::pSignaller )
-  {
-      if( mMsgBuffer.length()>1 && mMsgBuffer.endsWith(' ') )
-          mMsgBuffer.chop(1);
-      rDebug_Signaller::pSignaller->signal_line( mFileLineFunc, mTime, mLevel, mLogId, mMsgBuffer );
+  rDebug_SinkSlot<rDebug_Signaller>::Use pSignaller( rDebug_Signaller::pSignaller );
+  if( !pSignaller )
+    return;
+  if( rDebug_Signaller::mMaxLevel.load( std::memory_order_relaxed ) < Record.mLevel )
+  { rDebugStats::countSink( rDebugStats::SinkSignal, true );
+    return;
   }
+
+  rDebugStats::countSink( rDebugStats::SinkSignal, false );
+  const quint64 Started = rDebugStats::startTimer();
+  // the only place, where the UTF-8 line becomes a QString
+  pSignaller->signal_line( Record.mFileLineFunc, Record.time(), Record.mLevel, Record.mLogId, Record.text() );
+  rDebugStats::countLatency( rDebugStats::HistSignalWrite, Started );
 }
 
 
-void rDebugBase::QFileBackendWriter( rDebugLevel::rMsgType currLevel )
+void rDebugBase::QFileBackendWriter( rDebugRecord& Record, rDebugRendered& Heads )
 {
-  if( rDebug_GlobalLevel::get() < currLevel )
-    return;
-  if( SkipOutputByPreprocessor( currLevel ) )
+  if( SkipOutputByPreprocessor( Record.mLevel ) )
     return;
 
-  if( rDebug_Filewriter::pFilewriter )
+  rDebug_SinkSlot<rDebug_Filewriter>::Use pFilewriter( rDebug_Filewriter::pFilewriter );
+  if( pFilewriter )
   {
-      if( mMsgBuffer.length()>1 && mMsgBuffer.endsWith(' ') )
-          mMsgBuffer.chop(1);
-      rDebug_Filewriter::pFilewriter->write_file( mFileLineFunc, mTime, mLevel, mLogId, mMsgBuffer );
+      const quint64 Started = rDebugStats::startTimer();
+      pFilewriter->write_file( Record.mFileLineFunc, Record.mTimeMs, Record.mLevel, Record.mLogId, Record.mMsg, Record.mFields, &Heads );
+      rDebugStats::countLatency( rDebugStats::HistFileWrite, Started );
   }
 }
 
 
 void rDebugBase::writer( rDebugLevel::rMsgType Level, uint64_t LogId, bool withLogId, const char* msg, va_list valist )
 {
-  mWithLogId = withLogId;
-  mLogId     = (LogId) ? LogId : static_cast<uint64_t>(QCoreApplication::applicationPid());
-  mLevel     = Level;
+  mRecord.mWithLogId = withLogId;
+  mRecord.mLogId     = (LogId) ? LogId : static_cast<uint64_t>(QCoreApplication::applicationPid());
+  mRecord.mLevel     = Level;
 
-  if( rDebug_GlobalLevel::get() < Level )
+  if( !PassesGlobalLevel( mRecord.mFileLineFunc, Level ) )
     return;
 
   if(!msg)
     return;
 
-  size_t allocated = 1024;
-  char* str = new char[allocated];
-  *str=0;
-  int attempted;
-  attempted = vsnprintf( str, allocated, msg, valist );
-  if( attempted >= static_cast<int>(allocated) )
+  // printf output is taken as UTF-8, right into the (recycled) buffer of the record
+  std::string& Out  = mRecord.mMsg;
+  const size_t Used = Out.size();
+  const size_t Room = qMax<size_t>( Out.capacity() - Used, 256 );
+  Out.resize( Used + Room );
+  va_list first;
+  va_copy( first, valist ); // a second vsnprintf() needs the arguments again
+  const int attempted = vsnprintf( &Out[Used], Room, msg, first );
+  va_end( first );
+  if( attempted < 0 )
+  { Out.resize( Used );
+    return;
+  }
+  if( static_cast<size_t>(attempted) >= Room )
   {
-    delete [] str;
-    allocated = static_cast<size_t>(attempted + 1);
-    str = new char[ allocated ];
-    vsnprintf( str, allocated, msg, valist );
+    Out.resize( Used + static_cast<size_t>(attempted) + 1 );
+    vsnprintf( &Out[Used], static_cast<size_t>(attempted) + 1, msg, valist );
   }
-
-  mMsgBuffer.append(str);
-  delete [] str;
+  Out.resize( Used + static_cast<size_t>(attempted) );
 }
 
 
@@ -636,6 +1549,93 @@ QString rDebugBase::getLevelName( rDebugLevel::rMsgType Level )
 
 
 
+const char* rDebugBase::getLevelKey( rDebugLevel::rMsgType Level )
+{
+  return rDebugCore::levelKey( Level );
+}
+
+
+// the translations of getLevelName(), as they are on the first line
+const std::string& rDebugBase::getLevelNameUtf8( rDebugLevel::rMsgType Level )
+{
+  static const struct Names
+  {
+    Names()
+    { for( int lvl=0 ; lvl<8 ; ++lvl )
+        rDebugArgs::appendString( mUtf8[lvl], rDebugBase::getLevelName( static_cast<rDebugLevel::rMsgType>(lvl) ) );
+    }
+    std::string mUtf8[8]; // Emergency(0) .. Debug(7)
+  } LevelNames;
+
+  if( Level < rDebugLevel::rMsgType::Emergency || Level > rDebugLevel::rMsgType::Debug )
+    return LevelNames.mUtf8[rDebugLevel::rMsgType::Emergency];
+  return LevelNames.mUtf8[Level];
+}
+
+
+// rDebugCore::formatTime() writes the untranslated format, a translation to another one goes the QDateTime way
+void rDebugBase::appendDateTimeText( std::string& line, rDebugCore::TimeMs Time )
+{
+  static const bool Classic = ( QObject::tr("yyyy-MM-dd HH:mm:ss,zzz","local date time format for logging") == QLatin1String( "yyyy-MM-dd HH:mm:ss,zzz" ) );
+  if( Classic )
+    rDebugCore::appendTime( line, Time );
+  else
+    rDebugArgs::appendString( line, getDateTimeStr( QDateTime::fromMSecsSinceEpoch( Time ) ) );
+}
+
+
+// "[name:id #seq]", the #seq only for counted lines
+void rDebugBase::appendOriginText( std::string& line, const FileLineFunc_t& Origin )
+{
+  char Tmp[rDebugThread::NameChars];
+  rDebugCore::appendOrigin( line, rDebugThread::nameOf( Origin.mThreadName, Origin.mThreadId, Tmp ), Origin.mThreadId, Origin.mSeq );
+}
+
+
+// Stem: "<time> [<Level>] ", the others: "<LogId> [<thread>:<tid> #<seq>], " (see rDebugRendered)
+void rDebugBase::renderClassicHead( rDebugRendered& Heads, rDebugRendered::Layout Part, const FileLineFunc_t& Origin,
+                                    rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId )
+{
+  if( !Heads.has( rDebugRendered::Stem ) )
+  {
+    std::string& Text = Heads.begin( rDebugRendered::Stem );
+    appendDateTimeText( Text, Time );
+    Text += " [";
+    Text += getLevelNameUtf8( Level );
+    Text += "] ";
+    Heads.end( rDebugRendered::Stem );
+  }
+  if( Part == rDebugRendered::Stem || Heads.has( Part ) )
+    return;
+
+  std::string& Text = Heads.begin( Part );
+  if( Part == rDebugRendered::LogIdPlain )
+  { rDebugCore::appendUInt( Text, LogId );
+    Text += ' ';
+  }
+  else if( Part == rDebugRendered::LogIdPadded )
+  { rDebugCore::appendUInt( Text, LogId, 8 ); // getLogIdStr( LogId, 8 )
+    Text += ' ';
+  }
+  appendOriginText( Text, Origin );
+  Text += ", ";
+  Heads.end( Part );
+}
+
+
+void rDebugBase::appendFieldsText( std::string& line, const rDebugFields& Fields )
+{
+  for( size_t i=0 ; i<Fields.size() ; ++i )
+  {
+    line += ' ';
+    line += Fields[i].mKey;
+    line += '=';
+    line += Fields[i].mValue;
+  }
+}
+
+
+
 QString rDebugBase::getDateTimeStr(const QDateTime& Time)
 {
   QString TimestampAsString( QString("%1").arg( Time.toString(QObject::tr("yyyy-MM-dd HH:mm:ss,zzz","local date time format for logging"))) );
@@ -662,185 +1662,336 @@ rDebugBase& rDebugBase::integerBase( int base )
 
 rDebugBase& rDebugBase::operator<<( QChar ch )
 {
-  mMsgStream << ch;
+  if( mDeferred )
+    mRecord.mArgs.putQChar( ch );
+  else
+    rDebugArgs::appendQChar( mRecord.mMsg, ch );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( bool flg )
 {
-  mMsgStream << ((flg) ? "true" : "false");
+  if( mDeferred )
+    mRecord.mArgs.putBool( flg );
+  else
+    mRecord.mMsg += (flg) ? "true" : "false";
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( char ch )
 {
-  mMsgStream << ch;
+  if( mDeferred )
+    mRecord.mArgs.putChar( ch );
+  else
+    rDebugArgs::appendChar( mRecord.mMsg, ch );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( signed short num )
 {
-  mMsgStream.setIntegerBase(mBase);
-  mMsgStream << num;
+  if( mDeferred )
+    mRecord.mArgs.putInt( num, mBase );
+  else
+    rDebugArgs::appendInt( mRecord.mMsg, num, mBase );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( unsigned short num )
 {
-  mMsgStream.setIntegerBase(mBase);
-  mMsgStream << num;
+  if( mDeferred )
+    mRecord.mArgs.putUInt( num, mBase );
+  else
+    rDebugArgs::appendUInt( mRecord.mMsg, num, mBase );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( signed int num )
 {
-  mMsgStream.setIntegerBase(mBase);
-  mMsgStream << num;
+  if( mDeferred )
+    mRecord.mArgs.putInt( num, mBase );
+  else
+    rDebugArgs::appendInt( mRecord.mMsg, num, mBase );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( unsigned int num )
 {
-  mMsgStream.setIntegerBase(mBase);
-  mMsgStream << num;
+  if( mDeferred )
+    mRecord.mArgs.putUInt( num, mBase );
+  else
+    rDebugArgs::appendUInt( mRecord.mMsg, num, mBase );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( signed long lnum )
 {
-  mMsgStream.setIntegerBase(mBase);
-  mMsgStream << lnum;
+  if( mDeferred )
+    mRecord.mArgs.putInt( lnum, mBase );
+  else
+    rDebugArgs::appendInt( mRecord.mMsg, lnum, mBase );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( unsigned long lnum )
 {
-  mMsgStream.setIntegerBase(mBase);
-  mMsgStream << lnum;
+  if( mDeferred )
+    mRecord.mArgs.putUInt( lnum, mBase );
+  else
+    rDebugArgs::appendUInt( mRecord.mMsg, lnum, mBase );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( qint64 i64 )
 {
-  mMsgStream.setIntegerBase(mBase);
-  mMsgStream << i64;
+  if( mDeferred )
+    mRecord.mArgs.putInt( i64, mBase );
+  else
+    rDebugArgs::appendInt( mRecord.mMsg, i64, mBase );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( quint64 i64 )
 {
-  mMsgStream.setIntegerBase(mBase);
-  mMsgStream << i64;
+  if( mDeferred )
+    mRecord.mArgs.putUInt( i64, mBase );
+  else
+    rDebugArgs::appendUInt( mRecord.mMsg, i64, mBase );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( float flt )
 {
-  mMsgStream << flt;
+  if( mDeferred )
+    mRecord.mArgs.putDouble( flt );
+  else
+    rDebugArgs::appendDouble( mRecord.mMsg, flt );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( double dbl )
 {
-  mMsgStream << dbl;
+  if( mDeferred )
+    mRecord.mArgs.putDouble( dbl );
+  else
+    rDebugArgs::appendDouble( mRecord.mMsg, dbl );
+  return maybeSpace();
+}
+
+
+// all char pointers and arrays, taken as UTF-8 like qDebug() does
+rDebugBase& rDebugBase::putChars( const char* Text, int Len )
+{
+  if( !Text )
+  {
+    Text = "(nullptr)";
+    Len  = 9;
+  }
+  if( mDeferred )
+    mRecord.mArgs.putCStr( Text, Len );
+  else if( Len < 0 )
+    mRecord.mMsg += Text;
+  else
+    mRecord.mMsg.append( Text, static_cast<size_t>( Len ) );
   return maybeSpace();
 }
 
 
-rDebugBase& rDebugBase::operator<<( const char * ptr )
+rDebugBase& rDebugBase::operator<<( const rDebugLiteral& Literal )
 {
-  mMsgStream << ((ptr)?ptr:"(nullptr)");
+  if( mDeferred )
+    mRecord.mArgs.putLiteral( Literal.mText, Literal.mLen );
+  else
+    mRecord.mMsg.append( Literal.mText, static_cast<size_t>( Literal.mLen ) );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( const QString & str )
 {
-  mMsgStream << str;
+  if( mDeferred )
+    mRecord.mArgs.putString( str );
+  else
+    rDebugArgs::appendString( mRecord.mMsg, str );
+  return maybeSpace();
+}
+
+
+rDebugBase& rDebugBase::operator<<( QString && str )
+{
+  if( mDeferred )
+    mRecord.mArgs.putString( std::move( str ) );
+  else
+    rDebugArgs::appendString( mRecord.mMsg, str );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( const QStringRef & str )
 {
-  #if defined(QT_VERSION) && (QT_VERSION>=0x050000)
-  mMsgStream << str;
-  #elif defined(QT_VERSION) && (QT_VERSION>=0x040000)
-  mMsgStream << str.toString();
-  #endif
+  if( mDeferred )
+    mRecord.mArgs.putString( str.toString() );
+  else
+    rDebugArgs::appendString( mRecord.mMsg, str.unicode(), str.size() );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( const QLatin1String & str )
 {
-  mMsgStream << str;
+  if( mDeferred )
+    mRecord.mArgs.putString( QString(str) );
+  else
+    rDebugArgs::appendLatin1( mRecord.mMsg, str.latin1(), str.size() );
   return maybeSpace();
 }
 
 
 rDebugBase& rDebugBase::operator<<( const QByteArray & ba )
 {
-  mMsgStream << ba;
+  if( mDeferred )
+    mRecord.mArgs.putBytes( ba );
+  else
+    mRecord.mMsg.append( ba.constData(), static_cast<size_t>( ba.size() ) );
+  return maybeSpace();
+}
+
+
+rDebugBase& rDebugBase::operator<<( QByteArray && ba )
+{
+  if( mDeferred )
+    mRecord.mArgs.putBytes( std::move( ba ) );
+  else
+    mRecord.mMsg.append( ba.constData(), static_cast<size_t>( ba.size() ) );
+  return maybeSpace();
+}
+
+
+// the format strings of rDebug_f() and friends are literals, so the deferred formatting
+// just keeps the address of the part. {{ and }} split it, at the second brace
+void rDebugBase::putSegment( const char* Text, int Len, bool Escaped )
+{
+  if( Len <= 0 )
+    return;
+  if( Escaped )
+  {
+    int Begin = 0;
+    for( int i=0 ; i<Len ; ++i )
+      if( ( Text[i] == '{' || Text[i] == '}' ) && i+1 < Len && Text[i+1] == Text[i] )
+      { putSegment( Text + Begin, i+1 - Begin, false );
+        Begin = ++i + 1;
+      }
+    putSegment( Text + Begin, Len - Begin, false );
+    return;
+  }
+  if( mDeferred )
+    mRecord.mArgs.putLiteral( Text, Len );
+  else
+    mRecord.mMsg.append( Text, static_cast<size_t>( Len ) );
+}
+
+
+rDebugBase& rDebugBase::operator<<( const std::string& str )
+{
+  if( mDeferred )
+    mRecord.mArgs.putCStr( str.data(), static_cast<int>( str.size() ) );
+  else
+    mRecord.mMsg += str;
+  return maybeSpace();
+}
+
+
+#if defined(RDEBUG_CORE_STRING_VIEW)
+rDebugBase& rDebugBase::operator<<( std::string_view str )
+{
+  if( mDeferred )
+    mRecord.mArgs.putCStr( str.data(), static_cast<int>( str.size() ) );
+  else
+    mRecord.mMsg.append( str.data(), str.size() );
   return maybeSpace();
 }
+#endif
 
 
 rDebugBase& rDebugBase::operator<<( const void * vptr )
 {
-  mMsgStream << "0x" << hex << vptr;
+  if( mDeferred )
+    mRecord.mArgs.putPointer( vptr );
+  else
+    rDebugArgs::appendPointer( mRecord.mMsg, vptr );
   return maybeSpace();
 }
 
+// the text of a string based QTextStream (before, the address of its QString was logged)
 rDebugBase& rDebugBase::operator<<(const QTextStream& qts)
 {
-  mMsgStream << qts.string();
+  const QString* pText = qts.string();
+  if( !pText )
+    return maybeSpace();
+  if( mDeferred )
+    mRecord.mArgs.putString( *pText );
+  else
+    rDebugArgs::appendString( mRecord.mMsg, *pText );
   return maybeSpace();
 }
 
 rDebugBase&rDebugBase::operator<<(const QPoint& d)
 {
-  mMsgStream << "@(" << d.x() << "," << d.y() << ")";
+  if( mDeferred )
+    mRecord.mArgs.putPoint( d );
+  else
+    rDebugArgs::appendPoint( mRecord.mMsg, d );
   return maybeSpace();
 }
 
 
 rDebugBase&rDebugBase::operator<<(const QSize& d)
 {
-  mMsgStream << "@(" << d.width() << "x" << d.height() << ")";
+  if( mDeferred )
+    mRecord.mArgs.putSize( d );
+  else
+    rDebugArgs::appendSize( mRecord.mMsg, d );
   return maybeSpace();
 }
 
 
 rDebugBase&rDebugBase::operator<<(const QRect& d)
 {
-  mMsgStream << "QRect(" << d.x() << "," << d.y() << "/" << d.width() << "x" << d.height() << ")";
+  if( mDeferred )
+    mRecord.mArgs.putRect( d );
+  else
+    rDebugArgs::appendRect( mRecord.mMsg, d );
   return maybeSpace();
 }
 
 
 rDebugBase&rDebugBase::operator<<( const QDir& d )
 {
-  mMsgStream << d.absolutePath();
+  if( mDeferred )
+    mRecord.mArgs.putString( d.absolutePath() );
+  else
+    rDebugArgs::appendString( mRecord.mMsg, d.absolutePath() );
   return maybeSpace();
 }
 
 
 rDebugBase&rDebugBase::operator<<( const QFileInfo& f )
 {
-  mMsgStream << f.absoluteFilePath();
+  if( mDeferred )
+    mRecord.mArgs.putString( f.absoluteFilePath() );
+  else
+    rDebugArgs::appendString( mRecord.mMsg, f.absoluteFilePath() );
   return maybeSpace();
 }
 
@@ -869,6 +2020,71 @@ rDebugBase& rDebugBase::operator<<( const QEvent* evp )
 }
 
 
+rDebugBase& rDebugBase::field( const char* Key, const QString& Value )
+{
+  mRecord.mFields.push_back( rDebugField( Key, std::string(), false ) );
+  rDebugArgs::appendString( mRecord.mFields.back().mValue, Value );
+  return *this;
+}
+
+
+rDebugBase& rDebugBase::field( const char* Key, const char* Value )
+{
+  mRecord.mFields.push_back( rDebugField( Key, (Value) ? Value : "(nullptr)", false ) );
+  return *this;
+}
+
+
+rDebugBase& rDebugBase::field( const char* Key, signed int Value )
+{
+  return field( Key, static_cast<qint64>(Value) );
+}
+
+
+rDebugBase& rDebugBase::field( const char* Key, unsigned int Value )
+{
+  return field( Key, static_cast<quint64>(Value) );
+}
+
+
+rDebugBase& rDebugBase::field( const char* Key, signed long Value )
+{
+  return field( Key, static_cast<qint64>(Value) );
+}
+
+
+rDebugBase& rDebugBase::field( const char* Key, unsigned long Value )
+{
+  return field( Key, static_cast<quint64>(Value) );
+}
+
+
+rDebugBase& rDebugBase::field( const char* Key, qint64 Value )
+{
+  mRecord.mFields.push_back( rDebugField( Key, std::string(), true ) );
+  rDebugArgs::appendInt( mRecord.mFields.back().mValue, Value, 10 );
+  return *this;
+}
+
+
+rDebugBase& rDebugBase::field( const char* Key, quint64 Value )
+{
+  mRecord.mFields.push_back( rDebugField( Key, std::string(), true ) );
+  rDebugArgs::appendUInt( mRecord.mFields.back().mValue, Value, 10 );
+  return *this;
+}
+
+
+rDebugBase& rDebugBase::field( const char* Key, double Value )
+{
+  // the shortest text, which reads back the same, as for operator<<. JSON has no representation
+  // for inf/nan, so these are kept as strings
+  mRecord.mFields.push_back( rDebugField( Key, std::string(), std::isfinite(Value) ) );
+  rDebugArgs::appendDouble( mRecord.mFields.back().mValue, Value );
+  return *this;
+}
+
+
 rDebugBase& rDebugBase::debug(uint64_t LogId, const char* msg, ... )
 {
   va_list args;
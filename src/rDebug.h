@@ -41,9 +41,27 @@
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
+#include <QThread>
+#include <QMetaType>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <vector>
+#include <type_traits>
 
 #include "rDebugLevel.h"
 #include "rDebugCodeloc.h"
+#include "rDebugCore.h"
+#include "rDebugFmt.h"
+#include "rDebugPattern.h"
+#include "rDebugRecord.h"
+#include "rDebugFileIo.h"
+#include "rDebugRetention.h"
+#include "rDebugSeekIndex.h"
+
+Q_DECLARE_METATYPE( FileLineFunc_t )
 
 
 #ifdef qDebug
@@ -87,6 +105,24 @@
 # define rSystem    rDebugBase( __FILE__, __LINE__, __PRETTY_FUNCTION__ ).error     // another syslog 3 alias
 // --- old: only smart Qt5 support: #endif
 
+// ---- the same with a "{}" format string, checked by the compiler (see rDebugFmt) --------
+// rInfo_f( "x={} y={:x}", x, y ) is a statement of its own, there is no << behind it
+# define rDebug_f( Fmt, ... )     RDEBUG_FORMATTED( debug,     Fmt, ##__VA_ARGS__ )
+# define rInfo_f( Fmt, ... )      RDEBUG_FORMATTED( info,      Fmt, ##__VA_ARGS__ )
+# define rNote_f( Fmt, ... )      RDEBUG_FORMATTED( note,      Fmt, ##__VA_ARGS__ )
+# define rWarning_f( Fmt, ... )   RDEBUG_FORMATTED( warning,   Fmt, ##__VA_ARGS__ )
+# define rError_f( Fmt, ... )     RDEBUG_FORMATTED( error,     Fmt, ##__VA_ARGS__ )
+# define rCritical_f( Fmt, ... )  RDEBUG_FORMATTED( critical,  Fmt, ##__VA_ARGS__ )
+# define rFatal_f( Fmt, ... )     RDEBUG_FORMATTED( fatal,     Fmt, ##__VA_ARGS__ )
+# define rEmergency_f( Fmt, ... ) RDEBUG_FORMATTED( emergency, Fmt, ##__VA_ARGS__ )
+
+// the printf masks of the calls above are checked by gcc and clang (-Wformat), like those of printf() itself
+#if defined(__GNUC__)
+# define RDEBUG_PRINTF_CHECK( FormatArg, FirstArg ) __attribute__(( format( printf, FormatArg, FirstArg ) ))
+#else
+# define RDEBUG_PRINTF_CHECK( FormatArg, FirstArg )
+#endif
+
 
 // -----------------------
 // this is controlling the gloabl Message filtering by a global level,
@@ -106,6 +142,8 @@
 // which are checked, after a message passed a rDebug_GlobalLevel::set(m) set value. So each of the 3
 // sinks can reduce verbosity idividually, while all together can obey an common global level of
 // verbosity.
+// All levels are atomics, so any thread may change them while others are logging.
+// rDebug_LevelWatcher sets them from a rules file, and adds levels per category and call site (see rDebugLevelRules).
 // -----------------------
 class rDebug_GlobalLevel
 {
@@ -113,9 +151,104 @@ public:
   rDebug_GlobalLevel( rDebugLevel::rMsgType MaxLevel = rDebugLevel::rMsgType::Informational );
   static void set( rDebugLevel::rMsgType MaxLevel );
   static rDebugLevel::rMsgType get();
+  static bool passes( const char* File, int Line, rDebugLevel::rMsgType Level ); // get(), or the rule of a category/site (see rDebugLevelRules)
+
+private:
+  static std::atomic<rDebugLevel::rMsgType> mMaxLevel;
+};
+
+
+
+// -----------------------
+// the static "current sink" pointer of rDebug_Signaller, rDebug_Filewriter and rDebug_AsyncWriter
+// (and of the current rDebugLevelRules, which are swapped by exchange()).
+// The logging threads read it without a lock, the sink DTor unpublishes it and waits for the
+// threads, which still use the sink.
+// usage:
+//    rDebug_SinkSlot<rDebug_Filewriter>::Use pSink( rDebug_Filewriter::pFilewriter ); // logging thread
+//    if( pSink )
+//      pSink->write_file( ... );
+//    ...
+//    rDebug_Filewriter::pFilewriter.reset( this ); // sink DTor
+// note:
+//    - the users are counted in Stripes counters of their own cache line each, a thread always takes the
+//      same one. So a line is a fetch_add/fetch_sub on a line no other thread writes (up to Stripes threads)
+//    - the counters come twice, one set per epoch. reset() flips the epoch and then waits only for the
+//      users of the old one; users coming meanwhile count in the new set and see the pointer unpublished.
+//      So reset() finishes even under a steady stream of logging threads
+// -----------------------
+template<class Sink> class rDebug_SinkSlot
+{
+public:
+  constexpr rDebug_SinkSlot() : mpSink(nullptr), mEpoch(0) {} // constant initialized, so usable before main()
+
+  void set( Sink* pSink ) { mpSink.store( pSink ); }
+  void reset( Sink* pSink ) // unpublish pSink (if it is still the current one) and wait for its users
+  {
+    Sink* pExpected = pSink;
+    mpSink.compare_exchange_strong( pExpected, nullptr );
+    waitForUsers();
+  }
+  Sink* exchange( Sink* pSink ) // publish pSink instead, wait for the users of the one before and return it
+  {
+    Sink* pOld = mpSink.exchange( pSink );
+    waitForUsers();
+    return pOld;
+  }
+  bool isSet() const { return mpSink.load( std::memory_order_relaxed ) != nullptr; }
+
+  class Use
+  {
+  public:
+    explicit Use( rDebug_SinkSlot& Slot )
+      : mpCount( &Slot.mUsers[ Slot.mEpoch.load() ][ stripeOfThisThread() ].mCount )
+    {
+      mpCount->fetch_add( 1 );
+      mpSink = Slot.mpSink.load();
+    }
+    ~Use() { mpCount->fetch_sub( 1 ); }
+    Sink* operator->() const { return mpSink; }
+    Sink* get() const        { return mpSink; }
+    explicit operator bool() const { return mpSink != nullptr; }
+  private:
+    Use( const Use& );
+    Use& operator=( const Use& );
+    std::atomic<int>* mpCount;
+    Sink*             mpSink;
+  };
 
 private:
-  static rDebugLevel::rMsgType mMaxLevel;
+  void waitForUsers()
+  {
+    std::lock_guard<std::mutex> Lock( mResetLock ); // one flip at a time, or a 2nd reset could flip back
+    const unsigned Old = mEpoch.fetch_xor( 1 );
+    for( int s=0 ; s<Stripes ; ++s )
+      while( mUsers[Old][s].mCount.load() )
+        QThread::yieldCurrentThread();
+  }
+
+  enum { Stripes = 16 };
+  struct alignas(64) Stripe
+  {
+    constexpr Stripe() : mCount(0) {}
+    std::atomic<int> mCount;
+  };
+
+  static int stripeOfThisThread()
+  {
+    static std::atomic<unsigned> Next( 0 );
+    static thread_local int      Index = -1;
+    if( Index < 0 )
+      Index = static_cast<int>( Next.fetch_add( 1, std::memory_order_relaxed ) % Stripes );
+    return Index;
+  }
+
+  rDebug_SinkSlot( const rDebug_SinkSlot& );
+  rDebug_SinkSlot& operator=( const rDebug_SinkSlot& );
+  std::atomic<Sink*>    mpSink;
+  std::atomic<unsigned> mEpoch;
+  std::mutex            mResetLock;
+  Stripe                mUsers[2][Stripes];
 };
 
 
@@ -132,6 +265,10 @@ class rDebugBase;
 //      to be set at least to the same value, or it will win the filtering (may also be wanted)
 //    - if using multiple sinks with different Levels (f.i. file with all-logging and listview with only errors),
 //      implement different filtering there
+//    - with rDebug_AsyncWriter, the signal is emitted from its background thread, so slots in other threads
+//      get it as queued connection (FileLineFunc_t and uint64_t are registered as meta types for that)
+//    - the FileLineFunc_t also tells the logging thread (mThreadId, mThreadName) and the sequence number
+//      of the line (mSeq), so a slot can sort the lines of a thread or detect a missing one
 // -----------------------
 class rDebug_Signaller : public QObject
 {
@@ -152,54 +289,302 @@ signals:
   void sig_logline( const FileLineFunc_t& CodeLocation, const QDateTime& Time, int Level, uint64_t LogId, const QString& line );
 
 private:
-  static rDebug_Signaller*     pSignaller;
-  static rDebugLevel::rMsgType mMaxLevel;
+  static rDebug_SinkSlot<rDebug_Signaller>   pSignaller;
+  static std::atomic<rDebugLevel::rMsgType>  mMaxLevel;
 };
 
 
 
+// -----------------------
+// write the logging into a file, with size and/or time based rotation.
+// note:
+//    - the line layout is selectable per file sink:
+//        PlainText  : "<time> [<Level>] <LogId> [<thread>:<tid> #<seq>], <message> {from <func> in <file>:<line>}" (the classic one)
+//        JsonLines  : one JSON object per line, members ts, level, logid, file, line, func, tid, thread, seq, msg + all rDebugFields.
+//                     ts is local time with its offset to UTC (RFC 3339, "2026-10-18T14:03:12.345+02:00")
+//    - JsonLines files never get a BOM, so decide for the format in the CTor, before the file is created
+//    - PlainText lines can get an own layout via setMessagePattern( "[%{type}] %{file}:%{line} - %{message}" ),
+//      see rDebugPattern. Without, the QT_MESSAGE_PATTERN environment variable is used, if set.
+//    - lines are written as UTF-8 bytes, the message is already UTF-8 (see rDebugRecord), so there is no
+//      QTextStream and no codec in between. The line path is plain C++ (std::string, rDebugCore::Span,
+//      std::mutex), Qt is left for the file names, the rotation and the QtFile backend of rDebugFileIo
+//    - thread-safe: writing, rotation, move() and the setters are serialized by an internal mutex,
+//      the level is an atomic. Destroy it only, when no other thread will log anymore (or accept, that
+//      their lines are not written to file)
+//    - setIoBackend( rDebugFileIo::IoUring ) or ( rDebugFileIo::Pwritev ) for high volume logs on Linux/Unix,
+//      see rDebugFileIo. A line written directly is in the kernel, when the logging call returns (as with QFile).
+//      Lines from rDebug_AsyncWriter are collected and submitted once per batch, io_uring does not even wait for that.
+//      The classic layout goes as header, message and tail straight into the buffers of rDebugFileIo, so a batch
+//      of lines costs one pwritev() (or io_uring submission) and no temporary line per record.
+//    - how durable a line is when the logging call returns, is set per level with setDurability():
+//        Buffered: stays in the buffers, until they are full or a line of another durability submits them
+//        Flushed : handed to the kernel, survives a crash of the process (the default, as before)
+//        Synced  : on the disk, fdatasync() after the line. Threads waiting for a sync at the same time share
+//                  one fdatasync() (group commit), which is done outside the mutex of the sink
+//        DSynced : on the disk, written through a second descriptor opened with O_DSYNC (see rDebugFileIo)
+//      setDurability( Level, D ) sets Level and all more severe ones, so go from Debug up to the severe levels:
+//        rDebug_Filewriter::setDurability( rDebugLevel::rMsgType::Debug,    rDebug_Filewriter::Buffered );
+//        rDebug_Filewriter::setDurability( rDebugLevel::rMsgType::Warning,  rDebug_Filewriter::Flushed );
+//        rDebug_Filewriter::setDurability( rDebugLevel::rMsgType::Critical, rDebug_Filewriter::Synced );
+//      Synced and DSynced lines bypass rDebug_AsyncWriter: its queue is flushed, then the line is written
+//      directly, so it is on the disk together with all lines before, when the call returns.
+//      Each sync is counted in rDebugStats. On Windows there is no fdatasync(), Synced is Flushed there.
+//    - rotation, see rDebugRetention:
+//        setRotation( rDebugRetention::Numbered ): the classic one, over MaxSize app.log becomes app.1.log
+//        setRotation( rDebugRetention::Daily / Hourly ): at midnight (each hour) app.log becomes app.2026-10-18.log
+//        (app.2026-10-18_14.log), and over MaxSize within the period app.2026-10-18-1.log and so on.
+//      A file of an earlier period, found when the rotation is set, is rotated at once.
+//      MaxBackups limits the timestamped backups as well, setMaxBackups( 0 ) keeps them by the budget only.
+//    - setRetentionBudget( Bytes ): the oldest backups are removed, until all of them and the current file
+//      fit into Bytes. The directory is scanned once, when the file sink is created (or moved).
+//    - setSeekIndex( 0x10000 ) writes a sparse index beside the file ("app.log.idx"), one entry per 64 KiB
+//      with the time range, the levels and the LogIds of the lines. rDebugSeekIndex::ranges() tells the parts
+//      of a (rotated) file, a search for a time window, level or LogId has to read.
+//    - setCompression( rDebugFileIo::Gzip ) writes the file as gzip frames (see rDebugFileIo), so name it
+//      "app.log.gz", the backups become "app.log.1.gz". MaxSize and the retention budget count compressed bytes.
+//      The compression runs where the lines are written: on the worker of rDebug_AsyncWriter, if there is one,
+//      which also closes a frame older than FrameMs when it is idle. Without, the next line closes it.
+//      A Flushed line is readable, when its frame is closed, a Synced one closes its frame at once (so
+//      many Synced lines give small frames). No seek index for compressed files, its offsets would be of no use.
+//      rdebug-grep does not read .gz files, use "zcat app.log.gz | grep" for them.
 // -----------------------
 class rDebug_Filewriter
 {
   friend class rDebugBase;
+  friend class rDebug_AsyncWriter;
 public:
-  rDebug_Filewriter(const QString& fileName, rDebugLevel::rMsgType MaxLevel = rDebugLevel::rMsgType::Informational, qint16 MaxBackups=2 , qint64 MaxSize=0x100000);
+  enum OutputFormat { PlainText, JsonLines };
+  enum Durability { Buffered, Flushed, Synced, DSynced };
+
+  rDebug_Filewriter(const QString& fileName, rDebugLevel::rMsgType MaxLevel = rDebugLevel::rMsgType::Informational, qint16 MaxBackups=2 , qint64 MaxSize=0x100000, OutputFormat Format=PlainText );
   virtual ~rDebug_Filewriter();
   static void setMaxLevel( rDebugLevel::rMsgType MaxLevel );
   void setMaxSize( qint64 MaxSize=0x100000 );
   void setMaxBackups( qint16 MaxBackups );
+  void setOutputFormat( OutputFormat Format );
+  OutputFormat outputFormat() const { return mFormat; }
+  void setMessagePattern( const QString& Pattern ); // empty for the classic layout
+  void setIoBackend( rDebugFileIo::Backend Backend ); // falls back to what the system has, see ioBackend()
+  void setRotation( rDebugRetention::Rotation Mode );
+  rDebugRetention::Rotation rotation() const;
+  void setRetentionBudget( qint64 Bytes ); // 0 = no budget
+  void setSeekIndex( int BlockSize );       // 0 = no index (the default), see rDebugSeekIndex
+  void setCompression( rDebugFileIo::Compression Mode, int FrameBytes=0x100000, int FrameMs=2000 );
+  rDebugFileIo::Backend ioBackend() const;
   static void enableCodeLocations(bool enable);
-  void write_file( const FileLineFunc_t& CodeLocation, const QDateTime& Time, rDebugLevel::rMsgType Level, uint64_t LogId, const QString& line );
-  void write_file_raw(const FileLineFunc_t& CodeLocation, const QDateTime& Time, rDebugLevel::rMsgType Level, uint64_t LogId, const QString& line);
+  static void setDurability( rDebugLevel::rMsgType Level, Durability D ); // Level and all more severe ones
+  static Durability durability( rDebugLevel::rMsgType Level );
+  static bool writesDirectly( rDebugLevel::rMsgType Level ) { return durability( Level ) >= Synced; }
+  void write_file( const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields=rDebugFields(),
+                   rDebugRendered* Heads=nullptr ); // line is UTF-8, Heads: shared with the other sinks, see rDebugBase::output()
+  void write_file_raw(const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields=rDebugFields() );
+  // the Qt adapters
+  void write_file( const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, const QByteArray& line, const rDebugFields& Fields=rDebugFields() )
+  { write_file( CodeLocation, Time, Level, LogId, rDebugCore::Span( line.constData(), static_cast<size_t>( line.size() ) ), Fields ); }
+  void write_file( const FileLineFunc_t& CodeLocation, const QDateTime& Time, rDebugLevel::rMsgType Level, uint64_t LogId, const QByteArray& line, const rDebugFields& Fields=rDebugFields() )
+  { write_file( CodeLocation, Time.toMSecsSinceEpoch(), Level, LogId, line, Fields ); }
+  void write_file_raw(const FileLineFunc_t& CodeLocation, const QDateTime& Time, rDebugLevel::rMsgType Level, uint64_t LogId, const QByteArray& line, const rDebugFields& Fields=rDebugFields() )
+  { write_file_raw( CodeLocation, Time.toMSecsSinceEpoch(), Level, LogId, rDebugCore::Span( line.constData(), static_cast<size_t>( line.size() ) ), Fields ); }
   void move( const QString& NewfileName ); // moving a running log into other location
 
 protected:
   void write_wrap( const char* Location, const char* Reason );
   void write_BOM();
+  void write_text_line( const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields, rDebugRendered& Heads );
+  void write_json_line( const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields );
 
 private:
   void open( const QString& fileName, const char* Location, const char* Reason );
   void close(const char* Location, const char* Reason);
   bool oversized( const QString& fileName );
-  bool oversized( QFile& openedFile );
-  void rotate(void);
+  bool oversized();
+  void rotate( const QString& Stamp, qint64 Size );
   void rotate_ondemand(void);
+  void next_period( const QDateTime& Time );
+  void enforce_retention();
   bool appendFiles( const QString& SourceFile, const QString& DestinationFile );
 
 private:
-  static rDebug_Filewriter*    pFilewriter;
-  static rDebugLevel::rMsgType mMaxLevel;
-  static bool                  mDumpCodeLocation;
+  void write_line( const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span line, const rDebugFields& Fields, rDebugRendered* Heads=nullptr );
+  void line_written( int Bytes, rDebugLevel::rMsgType Level );
+  void sync_up_to( qint64 Ticket );
+  static bool anyDurable();
+  static void endBatch(); // rDebug_AsyncWriter, after each batch of lines
+  static void idle();     // rDebug_AsyncWriter, when no lines came for a while
+
+private:
+  static rDebug_SinkSlot<rDebug_Filewriter>  pFilewriter;
+  static std::atomic<rDebugLevel::rMsgType>  mMaxLevel;
+  static std::atomic<bool>                   mDumpCodeLocation;
+  static thread_local bool                   mBatchThisThread; // the worker of rDebug_AsyncWriter: submit at endBatch()
+  static std::atomic<quint32>                mDurability;      // 2 bits per level
+  mutable std::mutex           mLock;      // guards all below
   QString                      mFileName;
   qint64                       mMaxSize;
   qint16                       mMaxBackups;
-  QFile*                       mpLogfile;
+  OutputFormat                 mFormat;
+  rDebugPattern                mPattern;
+  rDebugFileIo::Backend        mIoBackend;
+  rDebugFileIo                 mFile;
+  std::string                  mScratch;   // the parts of a line, which are not copied from the record as they are
+  qint64                       mWrittenTotal;   // bytes of all lines, over all rotations
+  qint64                       mSyncTicket;     // mWrittenTotal after the last Synced line, taken by its caller
+  bool                         mSyncAtBatchEnd; // a Synced line came from rDebug_AsyncWriter
+  std::mutex                   mSyncLock;       // guards the group commit below, never held with mLock
+  std::condition_variable      mSyncDone;
+  bool                         mSyncing;        // one thread does the fdatasync() for all waiting ones
+  qint64                       mSyncedUpTo;     // mWrittenTotal of the last finished fdatasync()
+  rDebugRetention              mBackups;
+  rDebugRetention::Rotation    mRotation;
+  qint64                       mRetentionBudget;
+  QDateTime                    mFileTime;       // when the lines of the current file began (about)
+  QString                      mPeriodStamp;    // Daily, Hourly: of the period the current file belongs to
+  qint64                       mPeriodEndMs;    // and its end, in msecs since epoch
+  rDebugSeekIndex              mIndex;
+  int                          mIndexBlock;     // 0: no index, and none for compressed files
 };
 
 
 
 
 // -----------------------
+// feed all sinks (rDebug_Signaller, rDebug_Filewriter, qDebug) from a background thread,
+// so the logging thread only has to queue the line.
+// usage:
+//    rDebug_Filewriter  rLogFile( ... );
+//    rDebug_AsyncWriter rLogAsync;                     // create it after the sinks, so it is gone before them
+//    ...
+//    rDebug_AsyncWriter::setDeferredFormatting(true);  // in a latency critical thread: only capture the raw
+//                                                      // operator<< values, convert them to text in the background
+// note:
+//    - Emergency and Alert lines (and with QT_FATAL_WARNINGS also Critical..Warning) are going to abort(),
+//      so these flush the queue and are written directly by the logging thread
+//    - a full queue blocks the logging thread (Block) or drops the line (Drop)
+//    - Queueing SharedQueue: one queue for all threads, behind a mutex. Fine for a few threads.
+//      Queueing PerThreadRings: each logging thread gets its own lock free ring of MaxQueued lines
+//      (bounded memory per thread), the background thread merges all rings in order of the sequence
+//      number (see rDebugThread). Made for many cores, where the one mutex becomes the bottleneck.
+//      A thread flushes its ring, when it ends. Lines logged by a sink itself (in the background thread)
+//      are written directly then.
+//    - the slots of the rings are a slab per thread: the message is copied into the buffers the slot
+//      kept from its last line, so with the spare buffers of rDebugRecord a line needs no malloc()/free()
+//      in steady state. The slots are made when a ring first needs them, in chunks of 64, and a slot keeps
+//      its buffers up to 1 KiB each, so an idle ring holds at most its high water mark of lines times 2 KiB.
+//      The SharedQueue mode moves the buffers of the line into the queue instead, and the logging thread
+//      gets those of a written line back from a pool in exchange (up to 1 KiB each, MaxQueued of them).
+//      So neither mode calls malloc()/free() per line in steady state.
+//    - setMemoryLimit() caps the messages waiting in the queue or in all rings together (64 MiB by default).
+//      The rings share it evenly. Over the limit, a line is handled like one into a full queue.
+// -----------------------
+class rDebug_AsyncWriter
+{
+  friend class rDebugBase;
+  friend class rDebugStats;
+public:
+  enum OverflowPolicy { Block, Drop };
+  enum Queueing { SharedQueue, PerThreadRings };
+
+  rDebug_AsyncWriter( int MaxQueued=0x4000, OverflowPolicy Overflow=Block, Queueing Mode=SharedQueue );
+  virtual ~rDebug_AsyncWriter();
+  void flush();  // returns, when all lines queued up to now are written
+  void setMemoryLimit( qint64 Bytes ); // 0 = no limit
+  qint64 memoryLimit() const;
+  quint64 dropped() const;
+  quint64 queued() const;     // waiting now
+  quint64 queuedMax() const;  // high water mark
+  static void setDeferredFormatting( bool enable ); // for the calling thread only
+  static bool deferredFormatting();
+
+private:
+  struct ThreadRing;
+  struct RingOfThread;
+  struct Buffers
+  {
+    std::string mMsg;
+    std::string mBlob;
+  };
+
+  bool enqueue( rDebugRecord& Record ); // takes the buffers of Record, if it is queued
+  bool enqueueRing( const rDebugRecord& Record );
+  ThreadRing* ringOfThisThread();
+  void flushRing( const std::shared_ptr<ThreadRing>& pRing );
+  void wakeCollector();
+  void shareMemoryLimit(); // under mLock
+  void run();
+  void runRings();
+  int  mergeRings( const std::vector< std::shared_ptr<ThreadRing> >& Rings );
+
+  class Worker : public QThread
+  {
+  public:
+    explicit Worker( rDebug_AsyncWriter* pOwner ) : mpOwner(pOwner) {}
+  protected:
+    virtual void run() { mpOwner->run(); }
+  private:
+    rDebug_AsyncWriter* mpOwner;
+  };
+
+private:
+  static rDebug_SinkSlot<rDebug_AsyncWriter> pAsyncWriter;
+  static thread_local bool     mDeferThisThread;
+  static thread_local RingOfThread mRingOfThisThread;
+  static std::atomic<quint64>  mLastGeneration;
+  const int                    mMaxQueued;
+  const OverflowPolicy         mOverflow;
+  const Queueing               mMode;
+  const quint64                mGeneration;   // tells the rings of this writer from those of an earlier one
+  mutable std::mutex           mLock;
+  std::condition_variable      mNotEmpty;
+  std::condition_variable      mNotFull;
+  std::condition_variable      mDrained;
+  std::vector<rDebugRecord>    mQueue;
+  std::vector<Buffers>         mPool;         // SharedQueue: the buffers of written lines, for the next ones
+  quint64                      mEnqueued;
+  quint64                      mWritten;
+  quint64                      mDropped;
+  quint64                      mQueuedMax;
+  std::atomic<bool>            mStopping;     // written under mLock, read without by a blocked enqueueRing()
+  qint64                       mQueuedBytes;
+  std::atomic<qint64>          mMemoryLimit;
+  std::atomic<qint64>          mRingLimit;    // the share of each ring
+  std::vector< std::shared_ptr<ThreadRing> > mRings;  // PerThreadRings, guarded by mLock
+  std::atomic<quint64>         mRingDropped;
+  std::atomic<bool>            mCollectorSleeps;
+  Worker                       mWorker;
+};
+
+
+
+
+// -----------------------
+// a string literal, the deferred formatting of rDebug_AsyncWriter keeps just its address.
+// usage:
+//    rInfo() << rLiteral( "request done" ) << ReqName;
+// note:
+//    - only a literal compiles ("" Text), so the text lives as long as the program
+//    - a plain "text" is copied once, like every char array: it might be a local one,
+//      gone before the line is rendered in the background
+// -----------------------
+struct rDebugLiteral
+{
+  const char* mText;
+  int         mLen;
+};
+#define rLiteral( Text ) rDebugLiteral{ "" Text, static_cast<int>( sizeof( "" Text ) - 1 ) }
+
+
+
+// -----------------------
+// one log line while it is built, behind all the macros above.
+// note:
+//    - the operator<< of the Qt types are adapters: they write UTF-8 into the record, which is plain bytes
+//      from then on. std::string (and std::string_view with C++17) go in as they are.
+//    - the dynamic part of a line is copied at most once: char arrays and literals are taken with the
+//      length the compiler knows, temporary QString and QByteArray are moved into a deferred record
+//    - the per line work of the sinks (time stamp, level, LogId, origin) is done by rDebugCore without Qt,
+//      once per line for all sinks (see rDebugRendered).
+//      getDateTimeStr(), getLevelName() and getLogIdStr() stay for the callers outside; the translated
+//      level names and time format are taken once, on the first line (like rDebugPattern does).
 // -----------------------
 class rDebugBase
 {
@@ -222,11 +607,23 @@ public:
   rDebugBase& operator<<( quint64 i64 );
   rDebugBase& operator<<( float flt );
   rDebugBase& operator<<( double dbl );
-  rDebugBase& operator<<( const char * ptr );
+  template<class T> typename std::enable_if< std::is_same<T,const char*>::value || std::is_same<T,char*>::value, rDebugBase& >::type
+  operator<<( T ptr )                     { return putChars( ptr, -1 ); }
+  template<int N>
+  rDebugBase& operator<<( const char (&Text)[N] ) { return putChars( Text, arrayLength( Text, N ) ); } // no strlen() for literals
+  template<int N>
+  rDebugBase& operator<<( char (&Text)[N] )       { return putChars( Text, -1 ); }                    // a buffer, not full
+  rDebugBase& operator<<( const rDebugLiteral& Literal ); // rLiteral( "text" )
   rDebugBase& operator<<( const QString & str );
+  rDebugBase& operator<<( QString && str );                // deferred: moved into the record
   rDebugBase& operator<<( const QStringRef & str );
   rDebugBase& operator<<( const QLatin1String & str );
   rDebugBase& operator<<( const QByteArray & ba );
+  rDebugBase& operator<<( QByteArray && ba );              // deferred: moved into the record
+  rDebugBase& operator<<( const std::string& str );       // UTF-8
+#if defined(RDEBUG_CORE_STRING_VIEW)
+  rDebugBase& operator<<( std::string_view str );         // UTF-8
+#endif
   rDebugBase& operator<<( const void * vptr );
   rDebugBase& operator<<( const QTextStream& qts );
   rDebugBase& operator<<( const QPoint& d );
@@ -236,56 +633,117 @@ public:
   rDebugBase& operator<<( const QFileInfo& f );
   rDebugBase& operator<<( const QEvent* evp ); /// Gives human-readable event type information.
 
+  // structured fields, see rDebugField
+  rDebugBase& field( const char* Key, const QString& Value );
+  rDebugBase& field( const char* Key, const char* Value );
+  rDebugBase& field( const char* Key, signed int Value );
+  rDebugBase& field( const char* Key, unsigned int Value );
+  rDebugBase& field( const char* Key, signed long Value );
+  rDebugBase& field( const char* Key, unsigned long Value );
+  rDebugBase& field( const char* Key, qint64 Value );
+  rDebugBase& field( const char* Key, quint64 Value );
+  rDebugBase& field( const char* Key, double Value );
+
   // Emergency / Alert / Critical / Error / Warning / Notice / Informational / Debug
-  rDebugBase& debug(    uint64_t LogId=0, const char *msg = nullptr, ... );
-  rDebugBase& info(     uint64_t LogId=0, const char *msg = nullptr, ... );
-  rDebugBase& note(     uint64_t LogId=0, const char *msg = nullptr, ... );
-  rDebugBase& warning(  uint64_t LogId=0, const char *msg = nullptr, ... );
-  rDebugBase& error(    uint64_t LogId=0, const char *msg = nullptr, ... );
-  rDebugBase& critical( uint64_t LogId=0, const char *msg = nullptr, ... );
-  rDebugBase& emergency(uint64_t LogId=0, const char *msg = nullptr, ... );
-  rDebugBase& fatal(    uint64_t LogId=0, const char *msg = nullptr, ... );
-
-  rDebugBase& debug(    const char *msg, ... );
-  rDebugBase& info(     const char *msg, ... );
-  rDebugBase& note(     const char *msg, ... );
-  rDebugBase& warning(  const char *msg, ... );
-  rDebugBase& error(    const char *msg, ... );
-  rDebugBase& critical( const char *msg, ... );
-  rDebugBase& emergency(const char *msg, ... );
-  rDebugBase& fatal(    const char *msg, ... );
+  // (the printf masks count "this" as argument 1)
+  rDebugBase& debug(    uint64_t LogId=0, const char *msg = nullptr, ... ) RDEBUG_PRINTF_CHECK( 3, 4 );
+  rDebugBase& info(     uint64_t LogId=0, const char *msg = nullptr, ... ) RDEBUG_PRINTF_CHECK( 3, 4 );
+  rDebugBase& note(     uint64_t LogId=0, const char *msg = nullptr, ... ) RDEBUG_PRINTF_CHECK( 3, 4 );
+  rDebugBase& warning(  uint64_t LogId=0, const char *msg = nullptr, ... ) RDEBUG_PRINTF_CHECK( 3, 4 );
+  rDebugBase& error(    uint64_t LogId=0, const char *msg = nullptr, ... ) RDEBUG_PRINTF_CHECK( 3, 4 );
+  rDebugBase& critical( uint64_t LogId=0, const char *msg = nullptr, ... ) RDEBUG_PRINTF_CHECK( 3, 4 );
+  rDebugBase& emergency(uint64_t LogId=0, const char *msg = nullptr, ... ) RDEBUG_PRINTF_CHECK( 3, 4 );
+  rDebugBase& fatal(    uint64_t LogId=0, const char *msg = nullptr, ... ) RDEBUG_PRINTF_CHECK( 3, 4 );
+
+  rDebugBase& debug(    const char *msg, ... ) RDEBUG_PRINTF_CHECK( 2, 3 );
+  rDebugBase& info(     const char *msg, ... ) RDEBUG_PRINTF_CHECK( 2, 3 );
+  rDebugBase& note(     const char *msg, ... ) RDEBUG_PRINTF_CHECK( 2, 3 );
+  rDebugBase& warning(  const char *msg, ... ) RDEBUG_PRINTF_CHECK( 2, 3 );
+  rDebugBase& error(    const char *msg, ... ) RDEBUG_PRINTF_CHECK( 2, 3 );
+  rDebugBase& critical( const char *msg, ... ) RDEBUG_PRINTF_CHECK( 2, 3 );
+  rDebugBase& emergency(const char *msg, ... ) RDEBUG_PRINTF_CHECK( 2, 3 );
+  rDebugBase& fatal(    const char *msg, ... ) RDEBUG_PRINTF_CHECK( 2, 3 );
+
+  // the message of rDebug_f(), rInfo_f(), ..., with the Layout the compiler made of Fmt (see rDebugFmt).
+  // No spaces are put in between, the format string has all of them.
+  template<int N, class... A>
+  rDebugBase& format( const char* Fmt, const rDebugFmt::Layout<N>& Layout, const A&... Args )
+  {
+    const bool Space = mSpace;
+    mSpace = false;
+    formatFrom<N>( Fmt, Layout, 0, Args... );
+    mSpace = Space;
+    return *this;
+  }
 
 public:
   static void setMaxLevel(rDebugLevel::rMsgType MaxLevel);
+  static void setMessagePattern( const QString& Pattern ); // layout of the qDebug() sink, empty for the classic one
   static QString getLevelName( rDebugLevel::rMsgType Level );
   static QString getDateTimeStr(const QDateTime& Time);
   static QString getLogIdStr(uint64_t LogId, int FormatLen=8);
+  static const std::string& getLevelNameUtf8( rDebugLevel::rMsgType Level ); // getLevelName(), taken once
+  static void appendDateTimeText( std::string& line, rDebugCore::TimeMs Time );   // getDateTimeStr(), without a QDateTime
+  static const char* getLevelKey( rDebugLevel::rMsgType Level ); // untranslated short name, for machine readable output
+  static void appendFieldsText( std::string& line, const rDebugFields& Fields );
+  static void appendOriginText( std::string& line, const FileLineFunc_t& Origin ); // thread and sequence number
+  static void renderClassicHead( rDebugRendered& Heads, rDebugRendered::Layout Part, const FileLineFunc_t& Origin,
+                                 rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId ); // if not yet
+
+  inline rDebugBase &nospace()    { mSpace = false;                 return *this; }
+  inline rDebugBase &space()      { mSpace = true; putSpace();      return *this; }
+  inline rDebugBase &maybeSpace() { if( mSpace )   putSpace();      return *this; }
 
-  inline rDebugBase &nospace()    { mSpace = false;                   return *this; }
-  inline rDebugBase &space()      { mSpace = true; mMsgStream << ' '; return *this; }
-  inline rDebugBase &maybeSpace() { if( mSpace )   mMsgStream << ' '; return *this; }
+  static void output( rDebugRecord& Record ); // feed all sinks with a finished line
 
 protected:
-  void output( rDebugLevel::rMsgType currLevel );
   void writer(rDebugLevel::rMsgType Level, uint64_t LogId, bool withLogId, const char* msg, va_list valist );
 
 private:
-  void QDebugBackendWriter(  rDebugLevel::rMsgType currLevel );
-  void QSignalBackendWriter( rDebugLevel::rMsgType currLevel );
-  void QFileBackendWriter(   rDebugLevel::rMsgType currLevel );
+  template<int N>
+  void formatFrom( const char* Fmt, const rDebugFmt::Layout<N>& Layout, int i )
+  {
+    putSegment( Fmt + Layout.mBegin[i], Layout.mEnd[i] - Layout.mBegin[i], Layout.mEscaped[i] );
+  }
+  template<int N, class A, class... More>
+  void formatFrom( const char* Fmt, const rDebugFmt::Layout<N>& Layout, int i, const A& Arg, const More&... Rest )
+  {
+    putSegment( Fmt + Layout.mBegin[i], Layout.mEnd[i] - Layout.mBegin[i], Layout.mEscaped[i] );
+    const int Base = mBase;
+    switch( Layout.mSpec[i] )
+    {
+      case 'x': mBase = 16; break;
+      case 'o': mBase =  8; break;
+      case 'b': mBase =  2; break;
+      case 'd': mBase = 10; break;
+      default : break;
+    }
+    *this << Arg;
+    mBase = Base;
+    formatFrom<N>( Fmt, Layout, i+1, Rest... );
+  }
+  void putSegment( const char* Text, int Len, bool Escaped ); // a literal part of a format string
+  rDebugBase& putChars( const char* Text, int Len );          // a C string, Len < 0: up to the '\0'
+  static int arrayLength( const char* Text, int N )           // a literal has its only '\0' at [N-1]
+  {
+    return ( N > 1 && Text[N-1] == 0 && Text[N-2] != 0 ) ? N-1 : -1;
+  }
+
+  void deliver(); // the line is complete: filter, enqueue or write it
+  inline void putSpace() { if( mDeferred ) mRecord.mArgs.putChar(' '); else mRecord.mMsg += ' '; }
+  static bool terminates( rDebugLevel::rMsgType Level ); // true for the levels, which to_xDebug() turns into abort()
+  static void QDebugBackendWriter(  rDebugRecord& Record, rDebugRendered& Heads );
+  static void QSignalBackendWriter( rDebugRecord& Record );
+  static void QFileBackendWriter(   rDebugRecord& Record, rDebugRendered& Heads );
 
 private:
-  static rDebugLevel::rMsgType mMaxLevel;
-  int         mBase;
-  FileLineFunc_t mFileLineFunc;
-  rDebugLevel::rMsgType    mLevel;
-  uint        mFacility;
-  QDateTime   mTime;
-  uint64_t    mLogId;
-  QString     mMsgBuffer;
-  QTextStream mMsgStream;
-  bool        mWithLogId;
-  bool        mSpace;
+  static std::atomic<rDebugLevel::rMsgType>   mMaxLevel;
+  static std::shared_ptr<const rDebugPattern> mPattern; // replaced as a whole, accessed by std::atomic_load/store
+  int          mBase;
+  uint         mFacility;
+  rDebugRecord mRecord;     // the message is built as UTF-8 in mRecord.mMsg
+  bool         mSpace;
+  bool         mDeferred;   // capture into mRecord.mArgs instead of mRecord.mMsg
 };
 
 typedef rDebugBase& (*rDebugBaseManipulator)( rDebugBase& );// manipulator function
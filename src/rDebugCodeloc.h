@@ -30,18 +30,36 @@
  * License is compatible with GPL and LGPL
  */ 
 
+#include <stdint.h>
 
+
+// where a line comes from: the code location, and the thread with the sequence number of the line
+// (rDebugRecord fills mThreadId/mThreadName, rDebugBase the mSeq, see rDebugThread)
 class FileLineFunc_t
 {
 public:
+  FileLineFunc_t() // for Qt's meta type system only (queued connections)
+    : mFile(nullptr)
+    , mLine(0)
+    , mFunc(nullptr)
+    , mThreadId(0)
+    , mThreadName(nullptr)
+    , mSeq(0)
+    {}
   FileLineFunc_t( const char *file, int line, const char* func )
     : mFile(file)
     , mLine(line)
     , mFunc(func)
+    , mThreadId(0)
+    , mThreadName(nullptr)
+    , mSeq(0)
     {}
   const char* mFile;
-  const int   mLine;
+  int         mLine;
   const char* mFunc;
+  uint32_t    mThreadId;   // rDebugThread::id()
+  const char* mThreadName; // rDebugThread::name(), UTF-8, lives until the end of the process. nullptr: "thread-<mThreadId>"
+  uint64_t    mSeq;        // rDebugThread::nextSequence(), 0 for lines not counted (filtered, logfile headers)
 };
 
 #endif // RDEBUGCODELOC_H
@@ -0,0 +1,326 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugConfig.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QList>
+#include <string.h>  // strlen, memcmp
+
+#include "rDebugConfig.h"
+#include "rDebug.h"
+
+
+rDebug_SinkSlot<const rDebugLevelRules> rDebugLevelRules::mCurrent;
+std::atomic<bool>                       rDebugLevelRules::mLocalRules( false );
+
+
+rDebugLevelRules::rDebugLevelRules()
+  : mGlobal(Unset)
+{
+  for( int k=0 ; k<SinkCount ; ++k )
+    mSink[k] = Unset;
+}
+
+
+rDebugLevelRules::~rDebugLevelRules()
+{}
+
+
+bool rDebugLevelRules::parseLevel( const QByteArray& Name, rDebugLevel::rMsgType& Level )
+{
+  static const struct { const char* mName; rDebugLevel::rMsgType mLevel; } Names[] =
+  { { "silent",        rDebugLevel::rMsgType::Silent        }
+  , { "emergency",     rDebugLevel::rMsgType::Emergency     }
+  , { "alert",         rDebugLevel::rMsgType::Alert         }
+  , { "critical",      rDebugLevel::rMsgType::Critical      }
+  , { "error",         rDebugLevel::rMsgType::Error         }
+  , { "warning",       rDebugLevel::rMsgType::Warning       }
+  , { "notice",        rDebugLevel::rMsgType::Notice        }
+  , { "informational", rDebugLevel::rMsgType::Informational }
+  , { "info",          rDebugLevel::rMsgType::Informational }
+  , { "debug",         rDebugLevel::rMsgType::Debug         }
+  , { "all",           rDebugLevel::rMsgType::All           }
+  };
+  const QByteArray Lower( Name.trimmed().toLower() );
+  for( size_t i=0 ; i<sizeof(Names)/sizeof(Names[0]) ; ++i )
+  {
+    if( Lower == Names[i].mName )
+    { Level = Names[i].mLevel;
+      return true;
+    }
+  }
+
+  bool isNumber = false;
+  const int Number = Lower.toInt( &isNumber );
+  if( isNumber && ( ( Number >= rDebugLevel::rMsgType::Silent && Number <= rDebugLevel::rMsgType::Debug ) || Number == rDebugLevel::rMsgType::All ) )
+  { Level = static_cast<rDebugLevel::rMsgType>( Number );
+    return true;
+  }
+  return false;
+}
+
+
+rDebugLevelRules* rDebugLevelRules::parse( const QByteArray& Text, QString* pError )
+{
+  rDebugLevelRules* pRules = new rDebugLevelRules;
+  const QList<QByteArray> Lines( Text.split( '\n' ) );
+  for( int n=0 ; n<Lines.size() ; ++n )
+  {
+    QByteArray Line( Lines.at(n) );
+    const int Comment = Line.indexOf( '#' );
+    if( Comment >= 0 )
+      Line.truncate( Comment );
+    Line = Line.trimmed();
+    if( Line.isEmpty() )
+      continue;
+
+    const int Assign = Line.indexOf( '=' );
+    rDebugLevel::rMsgType Level = rDebugLevel::rMsgType::Silent;
+    if( Assign <= 0 || !parseLevel( Line.mid( Assign+1 ), Level ) )
+    {
+      if( pError )
+        *pError = QString( "line %1: expected <key> = <level>, got \"%2\"" ).arg( n+1 ).arg( QString::fromUtf8( Line ) );
+      delete pRules;
+      return nullptr;
+    }
+
+    const QByteArray Key( Line.left( Assign ).trimmed() );
+    if( Key == "global" )
+      pRules->mGlobal = Level;
+    else if( Key == "sink.signal" )
+      pRules->mSink[SinkSignal] = Level;
+    else if( Key == "sink.file" )
+      pRules->mSink[SinkFile] = Level;
+    else if( Key == "sink.qdebug" )
+      pRules->mSink[SinkQDebug] = Level;
+    else if( Key.startsWith( "category." ) && Key.size() > 9 )
+    {
+      Category Rule;
+      Rule.mFiles = Key.mid( 9 );
+      Rule.mLevel = Level;
+      pRules->mCategories.append( Rule );
+    }
+    else if( Key.startsWith( "site." ) && Key.indexOf( ':', 5 ) > 5 )
+    {
+      const int Colon = Key.lastIndexOf( ':' );
+      bool isNumber = false;
+      Site Rule;
+      Rule.mFileEnd = Key.mid( 5, Colon-5 );
+      Rule.mLine    = Key.mid( Colon+1 ).toInt( &isNumber );
+      Rule.mLevel   = Level;
+      if( !isNumber )
+      {
+        if( pError )
+          *pError = QString( "line %1: expected site.<file>:<line>, got \"%2\"" ).arg( n+1 ).arg( QString::fromUtf8( Key ) );
+        delete pRules;
+        return nullptr;
+      }
+      pRules->mSites.append( Rule );
+    }
+    else
+    {
+      if( pError )
+        *pError = QString( "line %1: unknown key \"%2\"" ).arg( n+1 ).arg( QString::fromUtf8( Key ) );
+      delete pRules;
+      return nullptr;
+    }
+  }
+
+  if( pRules->localRules() )
+  {
+    pRules->mpCache.reset( new CacheSlot[CacheSlots] );
+    for( int i=0 ; i<CacheSlots ; ++i )
+      pRules->mpCache[i].mState.store( CacheSlot::Free, std::memory_order_relaxed );
+  }
+  return pRules;
+}
+
+
+void rDebugLevelRules::publish( rDebugLevelRules* pRules )
+{
+  if( !pRules )
+    return;
+  if( pRules->mGlobal != Unset )
+    rDebug_GlobalLevel::set( static_cast<rDebugLevel::rMsgType>( pRules->mGlobal ) );
+  if( pRules->mSink[SinkSignal] != Unset )
+    rDebug_Signaller::setMaxLevel( static_cast<rDebugLevel::rMsgType>( pRules->mSink[SinkSignal] ) );
+  if( pRules->mSink[SinkFile] != Unset )
+    rDebug_Filewriter::setMaxLevel( static_cast<rDebugLevel::rMsgType>( pRules->mSink[SinkFile] ) );
+  if( pRules->mSink[SinkQDebug] != Unset )
+    rDebugBase::setMaxLevel( static_cast<rDebugLevel::rMsgType>( pRules->mSink[SinkQDebug] ) );
+
+  static std::mutex Publishing; // keeps mLocalRules in line with mCurrent
+  std::lock_guard<std::mutex> Lock( Publishing );
+  if( pRules->localRules() )
+    mLocalRules.store( true );
+  delete mCurrent.exchange( pRules ); // no thread looks into the rules before, after exchange()
+  if( !pRules->localRules() )
+    mLocalRules.store( false );
+}
+
+
+bool rDebugLevelRules::wildcardMatch( const char* Pattern, const char* Text )
+{
+  const char* StarPattern = nullptr;
+  const char* StarText    = nullptr;
+  while( *Text )
+  {
+    if( *Pattern == '*' )
+    { StarPattern = ++Pattern;
+      StarText    = Text;
+    }
+    else if( *Pattern == '?' || *Pattern == *Text )
+    { ++Pattern;
+      ++Text;
+    }
+    else if( StarPattern )
+    { Pattern = StarPattern;
+      Text    = ++StarText;
+    }
+    else
+      return false;
+  }
+  while( *Pattern == '*' )
+    ++Pattern;
+  return !*Pattern;
+}
+
+
+int rDebugLevelRules::lookup( const char* File, int Line ) const
+{
+  if( !File )
+    return Unset;
+  const int FileLen = static_cast<int>( strlen( File ) );
+  for( int i=0 ; i<mSites.size() ; ++i )
+  {
+    const Site& Rule = mSites.at(i);
+    if( Rule.mLine == Line && FileLen >= Rule.mFileEnd.size()
+     && !memcmp( File + FileLen - Rule.mFileEnd.size(), Rule.mFileEnd.constData(), static_cast<size_t>( Rule.mFileEnd.size() ) ) )
+      return Rule.mLevel;
+  }
+  int Level = Unset;
+  for( int i=0 ; i<mCategories.size() ; ++i )
+  {
+    if( wildcardMatch( mCategories.at(i).mFiles.constData(), File ) )
+      Level = mCategories.at(i).mLevel; // the last one wins
+  }
+  return Level;
+}
+
+
+rDebugLevel::rMsgType rDebugLevelRules::maxLevelFor( const char* File, int Line, rDebugLevel::rMsgType Global )
+{
+  rDebug_SinkSlot<const rDebugLevelRules>::Use pRules( mCurrent );
+  if( !pRules || !pRules->mpCache )
+    return Global;
+  return pRules->cachedLevelFor( File, Line, Global );
+}
+
+
+rDebugLevel::rMsgType rDebugLevelRules::cachedLevelFor( const char* File, int Line, rDebugLevel::rMsgType Global ) const
+{
+  const quintptr Key   = reinterpret_cast<quintptr>(File) ^ ( static_cast<quintptr>( static_cast<unsigned>(Line) ) << 16 );
+  const unsigned Start = static_cast<unsigned>( ( Key * 0x9E3779B1u ) >> 7 ) & ( CacheSlots - 1 );
+  for( unsigned Probe=0 ; Probe<8 ; ++Probe )
+  {
+    CacheSlot& Slot = mpCache[ (Start + Probe) & (CacheSlots - 1) ];
+    int State = Slot.mState.load( std::memory_order_acquire );
+    if( State == CacheSlot::Free )
+    {
+      int Expected = CacheSlot::Free;
+      if( Slot.mState.compare_exchange_strong( Expected, CacheSlot::Claimed, std::memory_order_acquire ) )
+      {
+        Slot.mFile  = File;
+        Slot.mLine  = Line;
+        Slot.mLevel = lookup( File, Line );
+        Slot.mState.store( CacheSlot::Ready, std::memory_order_release );
+        return ( Slot.mLevel == Unset ) ? Global : static_cast<rDebugLevel::rMsgType>( Slot.mLevel );
+      }
+      State = Expected;
+    }
+    if( State == CacheSlot::Claimed ) // another thread is just filling it, don't wait for it
+      continue;
+    if( Slot.mFile == File && Slot.mLine == Line )
+      return ( Slot.mLevel == Unset ) ? Global : static_cast<rDebugLevel::rMsgType>( Slot.mLevel );
+  }
+
+  const int Level = lookup( File, Line ); // cache is crowded here, decide without it
+  return ( Level == Unset ) ? Global : static_cast<rDebugLevel::rMsgType>( Level );
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+rDebug_LevelWatcher::rDebug_LevelWatcher( const QString& FileName, QObject* pParent )
+  : QObject(pParent)
+  , mFileName( QFileInfo( FileName ).absoluteFilePath() )
+  , mpWatcher( new QFileSystemWatcher( this ) )
+{
+  QObject::connect( mpWatcher, SIGNAL(fileChanged(QString)),      this, SLOT(on_changed(QString)) );
+  QObject::connect( mpWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(on_changed(QString)) );
+  mpWatcher->addPath( QFileInfo( mFileName ).absolutePath() );
+  reload();
+}
+
+
+rDebug_LevelWatcher::~rDebug_LevelWatcher()
+{}
+
+
+bool rDebug_LevelWatcher::reload()
+{
+  QFile File( mFileName );
+  if( !File.open( QIODevice::ReadOnly ) )
+    return false; // not there (yet), the directory watch tells, when it comes
+  if( !mpWatcher->files().contains( mFileName ) )
+    mpWatcher->addPath( mFileName ); // again, after it was replaced
+  const QByteArray Text( File.readAll() );
+  if( Text == mLoaded )
+    return true;
+
+  QString Error;
+  rDebugLevelRules* pRules = rDebugLevelRules::parse( Text, &Error );
+  if( !pRules )
+  {
+    rWarning() << "rDebug_LevelWatcher:" << mFileName << Error << "- the rules before stay active";
+    return false;
+  }
+  rDebugLevelRules::publish( pRules );
+  mLoaded = Text;
+  rNote() << "rDebug_LevelWatcher: rules of" << mFileName << "applied";
+  return true;
+}
+
+
+void rDebug_LevelWatcher::on_changed( const QString& Path )
+{
+  Q_UNUSED( Path );
+  reload();
+}
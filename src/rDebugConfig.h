@@ -0,0 +1,158 @@
+#ifndef RDEBUGCONFIG_H
+#define RDEBUGCONFIG_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugConfig.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+#include "rDebugLevel.h"
+
+class QFileSystemWatcher;
+template<class Sink> class rDebug_SinkSlot;
+
+
+// -----------------------
+// an immutable set of level rules: global, per sink, per category and per call site.
+// A new set is published as a whole, the logging threads just load the current pointer.
+// rules text:
+//    # comment
+//    global               = Informational
+//    sink.signal          = Warning        # the same as rDebug_Signaller::setMaxLevel()
+//    sink.file            = All            #             rDebug_Filewriter::setMaxLevel()
+//    sink.qdebug          = Silent         #             rDebugBase::setMaxLevel()
+//    category.*/net/*     = Debug          # category: all source files (__FILE__) matching the wildcard
+//    site.net/client.cpp:120 = Debug       # one call site: end of __FILE__ and the line
+// levels are Silent, Emergency, Alert, Critical, Error, Warning, Notice, Informational (or Info), Debug, All
+// or their numbers. Upper and lower case does not matter.
+// usage:
+//    QString Error;
+//    rDebugLevelRules* pRules = rDebugLevelRules::parse( Text, &Error );
+//    if( pRules )
+//      rDebugLevelRules::publish( pRules );  // applies global and sink levels, takes the ownership
+// note:
+//    - category and site rules override the global level for their lines, in both directions.
+//      site wins over category, the last matching category wins. The sink levels filter afterwards.
+//    - the decision per call site is cached in the rules (lock free), so a line pays a table lookup
+//      only if there are category or site rules at all. Without, it is the global level check as before,
+//      and the rules have no cache (it is 2048 slots, about 48 KiB).
+//    - the current rules are held in a rDebug_SinkSlot. publish() swaps them, waits for the threads
+//      still looking into the rules before, and deletes them then.
+// -----------------------
+class rDebugLevelRules
+{
+public:
+  enum Sink { SinkSignal, SinkFile, SinkQDebug, SinkCount };
+  enum { Unset = -2, CacheSlots = 2048 };
+
+  ~rDebugLevelRules();
+  static rDebugLevelRules* parse( const QByteArray& Text, QString* pError=nullptr );
+  static bool parseLevel( const QByteArray& Name, rDebugLevel::rMsgType& Level );
+
+  static void publish( rDebugLevelRules* pRules );
+
+  // of the current rules, for the logging threads
+  static bool hasLocalRules() { return mLocalRules.load( std::memory_order_relaxed ); }
+  static rDebugLevel::rMsgType maxLevelFor( const char* File, int Line, rDebugLevel::rMsgType Global );
+
+private:
+  rDebugLevelRules();
+  rDebugLevelRules( const rDebugLevelRules& );
+  rDebugLevelRules& operator=( const rDebugLevelRules& );
+  bool localRules() const { return !mCategories.isEmpty() || !mSites.isEmpty(); }
+  rDebugLevel::rMsgType cachedLevelFor( const char* File, int Line, rDebugLevel::rMsgType Global ) const;
+  int lookup( const char* File, int Line ) const; // Unset, if no local rule matches
+  static bool wildcardMatch( const char* Pattern, const char* Text );
+
+  struct Category
+  {
+    QByteArray mFiles; // wildcard, '*' and '?'
+    int        mLevel;
+  };
+  struct Site
+  {
+    QByteArray mFileEnd;
+    int        mLine;
+    int        mLevel;
+  };
+  struct CacheSlot
+  {
+    enum { Free, Claimed, Ready };
+    std::atomic<int> mState;
+    const char*      mFile;
+    int              mLine;
+    int              mLevel;
+  };
+
+  static rDebug_SinkSlot<const rDebugLevelRules> mCurrent;
+  static std::atomic<bool> mLocalRules; // of mCurrent, so a line without looks into no rules at all
+  int               mGlobal;
+  int               mSink[SinkCount];
+  QVector<Category> mCategories;
+  QVector<Site>     mSites;
+  std::unique_ptr<CacheSlot[]> mpCache; // CacheSlots of them, only with local rules
+};
+
+
+
+// -----------------------
+// watches a rules file (see rDebugLevelRules) and publishes it again, whenever it changes.
+// So the verbosity of a running process can be raised (and lowered) by editing a file.
+// usage:
+//    rDebug_LevelWatcher rLogLevels( "/etc/myapp/rdebug.levels" );
+// note:
+//    - needs a running event loop in the thread creating it (QFileSystemWatcher)
+//    - editors, which replace the file instead of writing it, are handled by watching the directory too
+//    - a broken rules file is reported as a Warning line, the rules before stay active
+//    - a missing or removed file keeps the rules before as well
+// -----------------------
+class rDebug_LevelWatcher : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit rDebug_LevelWatcher( const QString& FileName, QObject* pParent=nullptr );
+  virtual ~rDebug_LevelWatcher();
+  bool reload();
+
+private slots:
+  void on_changed( const QString& Path );
+
+private:
+  const QString       mFileName;
+  QFileSystemWatcher* mpWatcher;
+  QByteArray          mLoaded; // content of the last published file, to skip the doubled notifications
+};
+
+#endif // RDEBUGCONFIG_H
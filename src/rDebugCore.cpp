@@ -0,0 +1,146 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugCore.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <chrono>
+#include <time.h>
+#include <string.h>  // memcpy
+
+#include "rDebugCore.h"
+
+
+namespace
+{
+  // the local date and time of one second, "yyyy-MM-dd HH:mm:ss", and its offset to UTC "+hh:mm"
+  struct SecondText
+  {
+    SecondText() : mSecond(INT64_MIN) {}
+    int64_t mSecond;
+    char    mText[19];
+    char    mOffset[6];
+  };
+  thread_local SecondText LastSecond;
+
+
+  inline void putDigits( char* Dst, int Value, int Count )
+  {
+    for( int i=Count-1 ; i>=0 ; --i )
+    { Dst[i] = static_cast<char>( '0' + Value % 10 );
+      Value /= 10;
+    }
+  }
+
+
+  // days since 1970-01-01 of a date in the proleptic Gregorian calendar (H. Hinnant's days_from_civil)
+  int64_t daysFromCivil( int64_t Year, int Month, int Day )
+  {
+    Year -= ( Month <= 2 ) ? 1 : 0;
+    const int64_t Era = ( Year >= 0 ? Year : Year - 399 ) / 400;
+    const int64_t YearOfEra = Year - Era * 400;
+    const int64_t DayOfYear = ( 153 * ( Month + ( Month > 2 ? -3 : 9 ) ) + 2 ) / 5 + Day - 1;
+    const int64_t DayOfEra  = YearOfEra * 365 + YearOfEra / 4 - YearOfEra / 100 + DayOfYear;
+    return Era * 146097 + DayOfEra - 719468;
+  }
+
+
+  void localSecond( SecondText& Text, int64_t Second )
+  {
+    const time_t Secs = static_cast<time_t>( Second );
+    struct tm Tm;
+#if defined(_WIN32)
+    if( localtime_s( &Tm, &Secs ) != 0 )
+#else
+    if( !localtime_r( &Secs, &Tm ) )
+#endif
+      memset( &Tm, 0, sizeof(Tm) );
+    char* p = Text.mText;
+    putDigits( p,      Tm.tm_year + 1900, 4 ); p[4]  = '-';
+    putDigits( p + 5,  Tm.tm_mon + 1,     2 ); p[7]  = '-';
+    putDigits( p + 8,  Tm.tm_mday,        2 ); p[10] = ' ';
+    putDigits( p + 11, Tm.tm_hour,        2 ); p[13] = ':';
+    putDigits( p + 14, Tm.tm_min,         2 ); p[16] = ':';
+    putDigits( p + 17, Tm.tm_sec,         2 );
+
+    // the local time read as UTC, minus the real UTC: no tm_gmtoff on Windows, and no global timezone either
+    const int64_t LocalAsUtc = daysFromCivil( Tm.tm_year + 1900, Tm.tm_mon + 1, Tm.tm_mday ) * 86400
+                             + Tm.tm_hour * 3600 + Tm.tm_min * 60 + Tm.tm_sec;
+    const int Offset  = static_cast<int>( ( LocalAsUtc - Second ) / 60 ); // minutes east of UTC
+    const int Minutes = ( Offset < 0 ) ? -Offset : Offset;
+    char* o = Text.mOffset;
+    o[0] = ( Offset < 0 ) ? '-' : '+';
+    putDigits( o + 1, Minutes / 60 % 100, 2 ); o[3] = ':';
+    putDigits( o + 4, Minutes % 60,       2 );
+    Text.mSecond = Second;
+  }
+} // namespace
+
+
+rDebugCore::TimeMs rDebugCore::now()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+}
+
+
+int rDebugCore::formatTime( char* Dst, TimeMs Time, bool Iso )
+{
+  int64_t Second = Time / 1000;
+  int     Milli  = static_cast<int>( Time % 1000 );
+  if( Milli < 0 ) // before 1970
+  { Milli += 1000;
+    --Second;
+  }
+  SecondText& Text = LastSecond;
+  if( Text.mSecond != Second )
+    localSecond( Text, Second );
+
+  memcpy( Dst, Text.mText, sizeof(Text.mText) );
+  Dst[19] = Iso ? '.' : ',';
+  putDigits( Dst + 20, Milli, 3 );
+  if( !Iso )
+    return TimeChars;
+  Dst[10] = 'T';
+  memcpy( Dst + TimeChars, Text.mOffset, sizeof(Text.mOffset) );
+  return IsoTimeChars;
+}
+
+
+const char* rDebugCore::levelKey( rDebugLevel::rMsgType Level )
+{
+  switch( Level )
+  {
+    case rDebugLevel::rMsgType::Debug        : return "Debg";
+    case rDebugLevel::rMsgType::Informational: return "Info";
+    case rDebugLevel::rMsgType::Notice       : return "Note";
+    case rDebugLevel::rMsgType::Warning      : return "Warn";
+    case rDebugLevel::rMsgType::Error        : return "Err!";
+    case rDebugLevel::rMsgType::Critical     : return "Crit";
+    case rDebugLevel::rMsgType::Alert        : return "Alrt";
+    case rDebugLevel::rMsgType::Emergency    : // fall through
+    default                                  : return "Emrg";
+  }
+}
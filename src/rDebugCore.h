@@ -0,0 +1,142 @@
+#ifndef RDEBUGCORE_H
+#define RDEBUGCORE_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugCore.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>  // strlen
+#include <string>
+
+#if (__cplusplus >= 201703L) && defined(__has_include)
+#  if __has_include(<string_view>)
+#    include <string_view>
+#    define RDEBUG_CORE_STRING_VIEW 1
+#  endif
+#endif
+
+#include "rDebugLevel.h"
+#include "rDebugFormat.h"
+
+
+// -----------------------
+// the Qt-free part of building a line: the time stamp, level, LogId and origin of the classic layout,
+// written as UTF-8 into a plain buffer. rDebugBase and the sinks put the Qt types on top of it.
+// The Buffer just needs an append( const char*, int ), so QByteArray or std::string will do (like rDebugJson).
+// usage:
+//    const rDebugCore::TimeMs Now = rDebugCore::now();
+//    std::string Line;
+//    rDebugCore::appendTime( Line, Now );  // "2026-10-18 14:03:12,345"
+// note:
+//    - a time is the msecs since epoch (UTC) of std::chrono::system_clock, taken once per line.
+//      A QDateTime is only made of it, where one is asked for (the Qt signal, %{time <format>})
+//    - formatTime() writes local time like QDateTime::toString( "yyyy-MM-dd HH:mm:ss,zzz" ) does, the date
+//      and time up to the seconds are converted once per second and thread, then only the msecs are new.
+//      Iso adds the offset to UTC (RFC 3339, "2026-10-18T14:03:12.345+02:00"), so the time is unambiguous
+//      also around a DST change and for readers in another time zone
+//    - Span is a pointer and a length, a std::string_view where the compiler has C++17.
+//      It does not own the bytes.
+// -----------------------
+namespace rDebugCore
+{
+  typedef int64_t TimeMs;
+  enum { TimeChars = 23, IsoTimeChars = 29 }; // "yyyy-MM-dd HH:mm:ss,zzz", "yyyy-MM-ddTHH:mm:ss.zzz+hh:mm"
+
+  class Span
+  {
+  public:
+    Span() : mData(""), mSize(0) {}
+    Span( const char* Data, size_t Size ) : mData(Data), mSize(Size) {}
+    Span( const std::string& Str ) : mData(Str.data()), mSize(Str.size()) {}
+#if defined(RDEBUG_CORE_STRING_VIEW)
+    Span( std::string_view Str ) : mData(Str.data()), mSize(Str.size()) {}
+    operator std::string_view() const { return std::string_view( mData, mSize ); }
+#endif
+    static Span of( const char* Str ) { return Str ? Span( Str, strlen( Str ) ) : Span(); }
+
+    const char* data() const { return mData; }
+    size_t size() const      { return mSize; }
+    bool empty() const       { return !mSize; }
+
+  private:
+    const char* mData;
+    size_t      mSize;
+  };
+
+  TimeMs now();
+  int formatTime( char* Dst, TimeMs Time, bool Iso=false ); // Iso: "yyyy-MM-ddTHH:mm:ss.zzz+hh:mm", returns the length
+  const char* levelKey( rDebugLevel::rMsgType Level );      // "Debg", "Info", ... untranslated
+
+
+  template<class Buffer>
+  void append( Buffer& Out, Span Str )
+  {
+    if( Str.size() )
+      Out.append( Str.data(), static_cast<int>( Str.size() ) );
+  }
+
+
+  template<class Buffer>
+  void appendTime( Buffer& Out, TimeMs Time, bool Iso=false )
+  {
+    char Tmp[IsoTimeChars];
+    Out.append( Tmp, formatTime( Tmp, Time, Iso ) );
+  }
+
+
+  template<class Buffer>
+  void appendUInt( Buffer& Out, uint64_t Num, int MinDigits=0 ) // zero padded to MinDigits (16 at most)
+  {
+    static const char Zeros[] = "0000000000000000";
+    char Tmp[rDebugFormat::MaxChars];
+    const int Len = rDebugFormat::formatUnsigned( Tmp, Num, 10 );
+    if( Len < MinDigits )
+      Out.append( Zeros, ( MinDigits - Len < 16 ) ? MinDigits - Len : 16 );
+    Out.append( Tmp, Len );
+  }
+
+
+  // "[name:id #seq]", the #seq only for counted lines
+  template<class Buffer>
+  void appendOrigin( Buffer& Out, Span ThreadName, uint32_t ThreadId, uint64_t Seq )
+  {
+    Out.append( "[", 1 );
+    append( Out, ThreadName );
+    Out.append( ":", 1 );
+    appendUInt( Out, ThreadId );
+    if( Seq )
+    { Out.append( " #", 2 );
+      appendUInt( Out, Seq );
+    }
+    Out.append( "]", 1 );
+  }
+
+} // namespace rDebugCore
+
+#endif // RDEBUGCORE_H
@@ -0,0 +1,817 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugFileIo.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QFile>
+#include <QElapsedTimer>
+#include <string.h>  // memcpy, memset
+#include <stdlib.h>
+
+#include "rDebugFileIo.h"
+
+#if defined(Q_OS_UNIX)
+#  define RDEBUG_FILEIO_POSIX 1
+#  include <sys/types.h>
+#  include <sys/uio.h>   // pwritev
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <errno.h>
+#endif
+
+#if defined(RDEBUG_FILEIO_POSIX) && defined(__linux__) && !defined(RDEBUG_NO_IO_URING) && defined(__has_include)
+#  if __has_include(<linux/io_uring.h>)
+#    define RDEBUG_FILEIO_URING 1
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#  endif
+#endif
+
+
+#if !defined(RDEBUG_NO_ZLIB) && defined(__has_include)
+#  if __has_include(<zlib.h>)
+#    define RDEBUG_FILEIO_ZLIB 1
+#    include <zlib.h>
+#  endif
+#endif
+
+
+#if defined(RDEBUG_FILEIO_ZLIB)
+// the deflate stream of the open frame, one gzip member
+struct rDebugFileIo::Zip
+{
+  enum { OutSize = 0x10000, Level = 1 }; // level 1: lines shrink 5 to 10 times anyway, at a fraction of the CPU of the default
+
+  z_stream      mStream;
+  qint64        mIn;         // uncompressed bytes in the open frame
+  QElapsedTimer mAge;        // since the first of them
+  char          mOut[OutSize];
+};
+#else
+struct rDebugFileIo::Zip {};
+#endif
+
+
+#if defined(RDEBUG_FILEIO_URING)
+// the rings shared with the kernel, see io_uring_setup(2)
+struct rDebugFileIo::Uring
+{
+  struct Piece
+  {
+    int    mBuffer;  // -1 = free
+    int    mStart;
+    int    mLen;
+    qint64 mOffset;
+    iovec  mIov;     // for IORING_OP_WRITEV, if the buffers could not be registered
+  };
+
+  Uring() : mRingFd(-1), mpSqMap(MAP_FAILED), mSqMapSize(0), mpCqMap(MAP_FAILED), mCqMapSize(0), mpSqes(nullptr), mSqesSize(0), mFixed(false), mInFlight(0)
+  {
+    for( int i=0 ; i<MaxPieces ; ++i )
+      mPieces[i].mBuffer = -1;
+  }
+
+  int            mRingFd;
+  void*          mpSqMap;
+  size_t         mSqMapSize;
+  void*          mpCqMap;
+  size_t         mCqMapSize;
+  io_uring_sqe*  mpSqes;
+  size_t         mSqesSize;
+  unsigned*      mpSqTail;
+  unsigned*      mpSqMask;
+  unsigned*      mpSqArray;
+  unsigned*      mpCqHead;
+  unsigned*      mpCqTail;
+  unsigned*      mpCqMask;
+  io_uring_cqe*  mpCqes;
+  bool           mFixed;      // buffers registered, IORING_OP_WRITE_FIXED
+  int            mInFlight;   // pieces
+  Piece          mPieces[MaxPieces];
+};
+#else
+struct rDebugFileIo::Uring {};
+#endif
+
+
+rDebugFileIo::rDebugFileIo()
+  : mBackend(QtFile)
+  , mpQFile(nullptr)
+  , mFd(-1)
+  , mDSyncFd(-1)
+  , mSize(0)
+  , mOffset(0)
+  , mpBuffers(nullptr)
+  , mFirst(0)
+  , mCurrent(0)
+  , mUnsynced(false)
+  , mpUring(nullptr)
+  , mCompression(Plain)
+  , mFrameBytes(0x100000)
+  , mFrameMs(2000)
+  , mpZip(nullptr)
+{
+  for( int i=0 ; i<Buffers ; ++i )
+    mFill[i] = mSent[i] = mInFlight[i] = 0;
+}
+
+
+rDebugFileIo::~rDebugFileIo()
+{
+  close();
+}
+
+
+const char* rDebugFileIo::name( Backend Which )
+{
+  switch( Which )
+  {
+    case QtFile : return "QFile";
+    case Pwritev: return "pwritev";
+    case IoUring: return "io_uring";
+  }
+  return "?";
+}
+
+
+bool rDebugFileIo::available( Backend Which )
+{
+  switch( Which )
+  {
+    case QtFile : return true;
+#if defined(RDEBUG_FILEIO_POSIX)
+    case Pwritev: return true;
+#endif
+#if defined(RDEBUG_FILEIO_URING)
+    case IoUring:
+    { static const bool Works = []() -> bool
+      { io_uring_params Params;
+        memset( &Params, 0, sizeof(Params) );
+        const int Fd = static_cast<int>( syscall( __NR_io_uring_setup, 4, &Params ) );
+        if( Fd < 0 )
+          return false;
+        ::close( Fd );
+        return true;
+      }();
+      return Works;
+    }
+#endif
+    default: return false;
+  }
+}
+
+
+bool rDebugFileIo::available( Compression Which )
+{
+#if defined(RDEBUG_FILEIO_ZLIB)
+  return Which == Plain || Which == Gzip;
+#else
+  return Which == Plain;
+#endif
+}
+
+
+void rDebugFileIo::setCompression( Compression Mode, int FrameBytes, int FrameMs )
+{
+  mCompression = available( Mode ) ? Mode : Plain;
+  mFrameBytes  = qMax( FrameBytes, 0x1000 );
+  mFrameMs     = qMax( FrameMs, 0 );
+}
+
+
+bool rDebugFileIo::open( const QString& FileName, Backend Wanted )
+{
+  close();
+  mFileName = FileName;
+  mSize = mOffset = 0;
+  mUnsynced = false;
+
+  if( Wanted == IoUring && !available( IoUring ) )
+    Wanted = Pwritev;
+  if( Wanted != QtFile && !available( Pwritev ) )
+    Wanted = QtFile;
+
+  if( Wanted != QtFile && openPosix( FileName ) )
+  {
+    mBackend = Pwritev;
+    if( Wanted == IoUring && startUring() )
+      mBackend = IoUring;
+    shareHandle( mFd );
+    startZip();
+    return true;
+  }
+
+  mBackend = QtFile;
+  mpQFile = new QFile( FileName );
+  QIODevice::OpenMode Mode = QIODevice::Append;
+  if( mCompression == Plain )
+    Mode |= QIODevice::Text; // not for gzip, it would get CRs on Windows
+  if( !mpQFile->open( Mode ) )
+  { delete mpQFile;
+    mpQFile = nullptr;
+    return false;
+  }
+  mSize = mpQFile->size();
+  shareHandle( mpQFile->handle() );
+  startZip();
+  return true;
+}
+
+
+// a dup() of Fd, closed by the last user
+void rDebugFileIo::shareHandle( int Fd )
+{
+#if defined(RDEBUG_FILEIO_POSIX)
+  const int Dup = ( Fd >= 0 ) ? ::dup( Fd ) : -1;
+  if( Dup >= 0 )
+    mpSyncFd = std::shared_ptr<const int>( new int( Dup ), []( const int* p ) { ::close( *p ); delete p; } );
+#else
+  Q_UNUSED( Fd );
+#endif
+}
+
+
+void rDebugFileIo::close()
+{
+  stopZip(); // the last frame still goes into the file
+  mpSyncFd.reset();
+  if( mpQFile )
+  {
+    mpQFile->close();
+    delete mpQFile;
+    mpQFile = nullptr;
+  }
+#if defined(RDEBUG_FILEIO_POSIX)
+  if( mFd >= 0 )
+  {
+    submit();
+    waitAll();
+    stopUring();
+    ::close( mFd );
+    mFd = -1;
+  }
+  if( mDSyncFd >= 0 )
+  { ::close( mDSyncFd );
+    mDSyncFd = -1;
+  }
+#endif
+  free( mpBuffers );
+  mpBuffers = nullptr;
+}
+
+
+bool rDebugFileIo::openPosix( const QString& FileName )
+{
+#if defined(RDEBUG_FILEIO_POSIX)
+  const QByteArray Path( QFile::encodeName( FileName ) );
+  mFd = ::open( Path.constData(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666 );
+  if( mFd < 0 )
+    return false;
+  mSize = mOffset = ::lseek( mFd, 0, SEEK_END );
+
+  void* pBuffers = nullptr;
+  if( posix_memalign( &pBuffers, 4096, static_cast<size_t>(Buffers) * BufferSize ) != 0 )
+  { ::close( mFd );
+    mFd = -1;
+    return false;
+  }
+  mpBuffers = static_cast<char*>( pBuffers );
+  for( int i=0 ; i<Buffers ; ++i )
+    mFill[i] = mSent[i] = mInFlight[i] = 0;
+  mFirst = mCurrent = 0;
+  return true;
+#else
+  Q_UNUSED( FileName );
+  return false;
+#endif
+}
+
+
+void rDebugFileIo::append( const char* Data, int Size )
+{
+#if defined(RDEBUG_FILEIO_ZLIB)
+  if( mpZip )
+  {
+    z_stream& Z = mpZip->mStream;
+    if( !mpZip->mIn )
+      mpZip->mAge.start();
+    mpZip->mIn += Size;
+    Z.next_in  = reinterpret_cast<Bytef*>( const_cast<char*>( Data ) );
+    Z.avail_in = static_cast<uInt>( Size );
+    deflateTo( Z_NO_FLUSH );
+    if( mpZip->mIn >= mFrameBytes )
+      closeFrame();
+    return;
+  }
+#endif
+  appendRaw( Data, Size );
+}
+
+
+void rDebugFileIo::appendRaw( const char* Data, int Size )
+{
+  mSize += Size;
+  if( mpQFile )
+  {
+    mpQFile->write( Data, Size );
+    return;
+  }
+  if( mFd < 0 )
+    return;
+
+  while( Size > 0 )
+  {
+    if( mFill[mCurrent] == BufferSize )
+      nextBuffer();
+    const int Chunk = qMin( Size, BufferSize - mFill[mCurrent] );
+    memcpy( mpBuffers + mCurrent * BufferSize + mFill[mCurrent], Data, static_cast<size_t>(Chunk) );
+    mFill[mCurrent] += Chunk;
+    Data += Chunk;
+    Size -= Chunk;
+  }
+}
+
+
+bool rDebugFileIo::pending() const
+{
+  if( frameDue() )
+    return true;
+  if( mpQFile )
+    return mpQFile->bytesToWrite() > 0;
+  return mFd >= 0 && ( mFill[mCurrent] > mSent[mCurrent] || ( mBackend == Pwritev && mFirst != mCurrent ) );
+}
+
+
+// the current buffer is full, go on with the next one
+void rDebugFileIo::nextBuffer()
+{
+  const int Next = ( mCurrent + 1 ) % Buffers;
+  if( mBackend == IoUring )
+  {
+    if( mFill[mCurrent] > mSent[mCurrent] )
+      queuePiece( mCurrent );
+    waitBuffer( Next );
+  }
+  else if( Next == mFirst ) // all buffers are full
+  {
+    writePending( mFd );         // the current one is empty again then
+    return;
+  }
+  mCurrent = Next;
+  mFill[mCurrent] = mSent[mCurrent] = 0;
+}
+
+
+void rDebugFileIo::submit( bool Wait )
+{
+  if( frameDue() )
+    closeFrame();
+  if( mpQFile )
+  {
+    mpQFile->flush();
+    return;
+  }
+  if( mFd < 0 )
+    return;
+  if( mBackend == IoUring )
+  {
+    if( mFill[mCurrent] > mSent[mCurrent] )
+      queuePiece( mCurrent );
+    if( Wait )
+      waitAll();
+    else
+      reap( false );
+  }
+  else
+  {
+    writePending( mFd );
+  }
+}
+
+
+void rDebugFileIo::submitDSync()
+{
+  closeFrame();
+#if defined(RDEBUG_FILEIO_POSIX)
+  if( mFd >= 0 && mDSyncFd < 0 )
+    mDSyncFd = ::open( QFile::encodeName( mFileName ).constData(), O_WRONLY | O_DSYNC | O_CLOEXEC );
+  if( mDSyncFd < 0 ) // QtFile, or the second open failed
+  {
+    sync();
+    return;
+  }
+  if( mUnsynced ) // the bytes in front of these are in the page cache only
+  {
+    waitAll();
+    datasync( mFd );
+    mUnsynced = false;
+  }
+  if( mBackend == IoUring )
+  {
+    const int Len = mFill[mCurrent] - mSent[mCurrent];
+    writeAt( mDSyncFd, mpBuffers + mCurrent * BufferSize + mSent[mCurrent], Len, mOffset );
+    mSent[mCurrent] = mFill[mCurrent];
+    mOffset += Len;
+  }
+  else
+  {
+    writePending( mDSyncFd );
+  }
+#else
+  sync();
+#endif
+}
+
+
+void rDebugFileIo::sync()
+{
+  closeFrame();
+  submit( true );
+  if( mpQFile )
+  {
+    datasync( mpQFile->handle() );
+    return;
+  }
+  if( mFd >= 0 )
+  { datasync( mFd );
+    mUnsynced = false;
+  }
+}
+
+
+void rDebugFileIo::datasync( int Fd )
+{
+#if defined(RDEBUG_FILEIO_POSIX)
+  while( ::fdatasync( Fd ) < 0 && errno == EINTR )
+    ;
+#else
+  Q_UNUSED( Fd ); // QFile::flush() is all we have there
+#endif
+}
+
+
+// Pwritev: all buffers from mFirst up to mCurrent with one syscall
+void rDebugFileIo::writePending( int Fd )
+{
+#if defined(RDEBUG_FILEIO_POSIX)
+  iovec Iov[Buffers];
+  int   Count = 0;
+  for( int i=mFirst ; ; i=(i+1)%Buffers )
+  {
+    if( mFill[i] > mSent[i] )
+    { Iov[Count].iov_base = mpBuffers + i * BufferSize + mSent[i];
+      Iov[Count].iov_len  = static_cast<size_t>( mFill[i] - mSent[i] );
+      ++Count;
+    }
+    if( i == mCurrent )
+      break;
+  }
+
+  int First = 0;
+  while( First < Count )
+  {
+    const ssize_t Written = ::pwritev( Fd, Iov + First, Count - First, static_cast<off_t>( mOffset ) );
+    if( Written < 0 )
+    { if( errno == EINTR )
+        continue;
+      break; // disk full or gone, the lines are lost like with QFile
+    }
+    if( Fd == mFd )
+      mUnsynced = true;
+    mOffset += Written;
+    size_t Left = static_cast<size_t>( Written );
+    while( First < Count && Left >= Iov[First].iov_len )
+      Left -= Iov[First++].iov_len;
+    if( First < Count )
+    { Iov[First].iov_base = static_cast<char*>( Iov[First].iov_base ) + Left;
+      Iov[First].iov_len -= Left;
+    }
+  }
+
+  // everything is in the kernel now, start again with the current buffer
+  mFill[mCurrent] = mSent[mCurrent] = 0;
+  mFirst = mCurrent;
+#else
+  Q_UNUSED( Fd );
+#endif
+}
+
+
+void rDebugFileIo::writeAt( int Fd, const char* Data, qint64 Size, qint64 Offset )
+{
+#if defined(RDEBUG_FILEIO_POSIX)
+  while( Size > 0 )
+  {
+    const ssize_t Written = ::pwrite( Fd, Data, static_cast<size_t>(Size), static_cast<off_t>(Offset) );
+    if( Written < 0 )
+    { if( errno == EINTR )
+        continue;
+      return;
+    }
+    Data   += Written;
+    Size   -= Written;
+    Offset += Written;
+  }
+#else
+  Q_UNUSED( Fd ); Q_UNUSED( Data ); Q_UNUSED( Size ); Q_UNUSED( Offset );
+#endif
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+#if defined(RDEBUG_FILEIO_ZLIB)
+
+void rDebugFileIo::startZip()
+{
+  if( mCompression != Gzip )
+    return;
+  Zip* p = new Zip;
+  memset( &p->mStream, 0, sizeof(p->mStream) );
+  p->mIn = 0;
+  if( deflateInit2( &p->mStream, Zip::Level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK ) // +16: gzip header and trailer
+  { delete p;
+    return; // plain then
+  }
+  mpZip = p;
+}
+
+
+void rDebugFileIo::stopZip()
+{
+  if( !mpZip )
+    return;
+  closeFrame();
+  deflateEnd( &mpZip->mStream );
+  delete mpZip;
+  mpZip = nullptr;
+}
+
+
+// runs deflate() on the input given, the output goes into the file buffers
+void rDebugFileIo::deflateTo( int Flush )
+{
+  z_stream& Z = mpZip->mStream;
+  for(;;)
+  {
+    Z.next_out  = reinterpret_cast<Bytef*>( mpZip->mOut );
+    Z.avail_out = Zip::OutSize;
+    const int Ret = deflate( &Z, Flush );
+    const int Produced = Zip::OutSize - static_cast<int>( Z.avail_out );
+    if( Produced )
+      appendRaw( mpZip->mOut, Produced );
+    if( Ret == Z_STREAM_END || Ret == Z_STREAM_ERROR || ( Ret == Z_BUF_ERROR && !Produced ) )
+      return;
+    if( Flush == Z_NO_FLUSH && !Z.avail_in && Z.avail_out )
+      return;
+  }
+}
+
+
+// finishes the gzip member with the bytes given so far, the next append() starts a new one
+void rDebugFileIo::closeFrame()
+{
+  if( !mpZip || !mpZip->mIn )
+    return;
+  mpZip->mStream.avail_in = 0;
+  deflateTo( Z_FINISH );
+  deflateReset( &mpZip->mStream );
+  mpZip->mIn = 0;
+}
+
+
+bool rDebugFileIo::frameDue() const
+{
+  return mpZip && mpZip->mIn && mpZip->mAge.hasExpired( mFrameMs );
+}
+
+#else  // RDEBUG_FILEIO_ZLIB
+
+void rDebugFileIo::startZip()            {}
+void rDebugFileIo::stopZip()             {}
+void rDebugFileIo::deflateTo( int )      {}
+void rDebugFileIo::closeFrame()          {}
+bool rDebugFileIo::frameDue() const      { return false; }
+
+#endif // RDEBUG_FILEIO_ZLIB
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+#if defined(RDEBUG_FILEIO_URING)
+
+static int uringEnter( int RingFd, unsigned ToSubmit, unsigned MinComplete, unsigned Flags )
+{
+  for(;;)
+  {
+    const int Ret = static_cast<int>( syscall( __NR_io_uring_enter, RingFd, ToSubmit, MinComplete, Flags, nullptr, 0 ) );
+    if( Ret >= 0 || errno != EINTR )
+      return Ret;
+  }
+}
+
+
+bool rDebugFileIo::startUring()
+{
+  io_uring_params Params;
+  memset( &Params, 0, sizeof(Params) );
+  const int RingFd = static_cast<int>( syscall( __NR_io_uring_setup, MaxPieces, &Params ) );
+  if( RingFd < 0 )
+    return false;
+
+  Uring* p = new Uring;
+  p->mRingFd    = RingFd;
+  p->mSqMapSize = Params.sq_off.array + Params.sq_entries * sizeof(unsigned);
+  p->mCqMapSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+  const bool SingleMap = ( Params.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+  if( SingleMap )
+    p->mSqMapSize = p->mCqMapSize = qMax( p->mSqMapSize, p->mCqMapSize );
+
+  p->mpSqMap = mmap( nullptr, p->mSqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_SQ_RING );
+  if( p->mpSqMap != MAP_FAILED )
+    p->mpCqMap = SingleMap ? p->mpSqMap
+                           : mmap( nullptr, p->mCqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_CQ_RING );
+  p->mSqesSize = Params.sq_entries * sizeof(io_uring_sqe);
+  void* pSqes = MAP_FAILED;
+  if( p->mpCqMap != MAP_FAILED )
+    pSqes = mmap( nullptr, p->mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_SQES );
+  if( pSqes == MAP_FAILED )
+  { mpUring = p;
+    stopUring();
+    return false;
+  }
+  p->mpSqes = static_cast<io_uring_sqe*>( pSqes );
+
+  char* Sq = static_cast<char*>( p->mpSqMap );
+  char* Cq = static_cast<char*>( p->mpCqMap );
+  p->mpSqTail  = reinterpret_cast<unsigned*>( Sq + Params.sq_off.tail );
+  p->mpSqMask  = reinterpret_cast<unsigned*>( Sq + Params.sq_off.ring_mask );
+  p->mpSqArray = reinterpret_cast<unsigned*>( Sq + Params.sq_off.array );
+  p->mpCqHead  = reinterpret_cast<unsigned*>( Cq + Params.cq_off.head );
+  p->mpCqTail  = reinterpret_cast<unsigned*>( Cq + Params.cq_off.tail );
+  p->mpCqMask  = reinterpret_cast<unsigned*>( Cq + Params.cq_off.ring_mask );
+  p->mpCqes    = reinterpret_cast<io_uring_cqe*>( Cq + Params.cq_off.cqes );
+
+  // registered buffers save the kernel the page pinning per write. Needs RLIMIT_MEMLOCK, else plain writev
+  iovec Iov[Buffers];
+  for( int i=0 ; i<Buffers ; ++i )
+  { Iov[i].iov_base = mpBuffers + i * BufferSize;
+    Iov[i].iov_len  = BufferSize;
+  }
+  p->mFixed = ( syscall( __NR_io_uring_register, RingFd, IORING_REGISTER_BUFFERS, Iov, Buffers ) == 0 );
+
+  mpUring = p;
+  return true;
+}
+
+
+void rDebugFileIo::stopUring()
+{
+  Uring* p = mpUring;
+  if( !p )
+    return;
+  mpUring = nullptr;
+  if( p->mpSqes )
+    munmap( p->mpSqes, p->mSqesSize );
+  if( p->mpCqMap != MAP_FAILED && p->mpCqMap != p->mpSqMap )
+    munmap( p->mpCqMap, p->mCqMapSize );
+  if( p->mpSqMap != MAP_FAILED )
+    munmap( p->mpSqMap, p->mSqMapSize );
+  ::close( p->mRingFd ); // unregisters the buffers too
+  delete p;
+}
+
+
+void rDebugFileIo::queuePiece( int Buffer )
+{
+  Uring* p = mpUring;
+  int Piece = -1;
+  for(;;)
+  {
+    for( int i=0 ; i<MaxPieces && Piece<0 ; ++i )
+      if( p->mPieces[i].mBuffer < 0 )
+        Piece = i;
+    if( Piece >= 0 )
+      break;
+    reap( true ); // all pieces in flight
+  }
+
+  mUnsynced = true;
+  Uring::Piece& Pc = p->mPieces[Piece];
+  Pc.mBuffer = Buffer;
+  Pc.mStart  = mSent[Buffer];
+  Pc.mLen    = mFill[Buffer] - mSent[Buffer];
+  Pc.mOffset = mOffset;
+  Pc.mIov.iov_base = mpBuffers + Buffer * BufferSize + Pc.mStart;
+  Pc.mIov.iov_len  = static_cast<size_t>( Pc.mLen );
+
+  const unsigned Tail  = *p->mpSqTail; // we are the only producer
+  const unsigned Index = Tail & *p->mpSqMask;
+  io_uring_sqe* pSqe = &p->mpSqes[Index];
+  memset( pSqe, 0, sizeof(*pSqe) );
+  pSqe->fd  = mFd;
+  pSqe->off = static_cast<__u64>( Pc.mOffset );
+  if( p->mFixed )
+  { pSqe->opcode    = IORING_OP_WRITE_FIXED;
+    pSqe->addr      = reinterpret_cast<__u64>( Pc.mIov.iov_base );
+    pSqe->len       = static_cast<__u32>( Pc.mLen );
+    pSqe->buf_index = static_cast<__u16>( Buffer );
+  }
+  else
+  { pSqe->opcode    = IORING_OP_WRITEV;
+    pSqe->addr      = reinterpret_cast<__u64>( &Pc.mIov );
+    pSqe->len       = 1;
+  }
+  pSqe->user_data = static_cast<__u64>( Piece );
+  p->mpSqArray[Index] = Index;
+  __atomic_store_n( p->mpSqTail, Tail + 1, __ATOMIC_RELEASE );
+
+  mSent[Buffer]    = mFill[Buffer];
+  mOffset         += Pc.mLen;
+  mInFlight[Buffer]++;
+  p->mInFlight++;
+
+  if( uringEnter( p->mRingFd, 1, 0, 0 ) < 0 ) // the kernel did not take it, write it ourselves
+  {
+    __atomic_store_n( p->mpSqTail, Tail, __ATOMIC_RELEASE );
+    writeAt( mFd, static_cast<const char*>( Pc.mIov.iov_base ), Pc.mLen, Pc.mOffset );
+    Pc.mBuffer = -1;
+    mInFlight[Buffer]--;
+    p->mInFlight--;
+  }
+}
+
+
+// takes the completions there are, with Wait at least one
+void rDebugFileIo::reap( bool Wait )
+{
+  Uring* p = mpUring;
+  if( !p->mInFlight )
+    return;
+  unsigned Head = *p->mpCqHead;
+  if( Wait && Head == __atomic_load_n( p->mpCqTail, __ATOMIC_ACQUIRE ) )
+    uringEnter( p->mRingFd, 0, 1, IORING_ENTER_GETEVENTS );
+
+  const unsigned Tail = __atomic_load_n( p->mpCqTail, __ATOMIC_ACQUIRE );
+  for( ; Head != Tail ; ++Head )
+  {
+    const io_uring_cqe& Cqe = p->mpCqes[ Head & *p->mpCqMask ];
+    Uring::Piece& Pc = p->mPieces[ Cqe.user_data ];
+    const int Done = qMax( Cqe.res, 0 );
+    if( Done < Pc.mLen ) // short or failed (f.i. -EAGAIN), the bytes are still in the buffer
+      writeAt( mFd, static_cast<const char*>( Pc.mIov.iov_base ) + Done, Pc.mLen - Done, Pc.mOffset + Done );
+    mInFlight[Pc.mBuffer]--;
+    Pc.mBuffer = -1;
+    p->mInFlight--;
+  }
+  __atomic_store_n( p->mpCqHead, Head, __ATOMIC_RELEASE );
+}
+
+
+void rDebugFileIo::waitBuffer( int Buffer )
+{
+  while( mInFlight[Buffer] > 0 )
+    reap( true );
+}
+
+
+void rDebugFileIo::waitAll()
+{
+  while( mpUring && mpUring->mInFlight > 0 )
+    reap( true );
+}
+
+#else  // RDEBUG_FILEIO_URING
+
+bool rDebugFileIo::startUring()          { return false; }
+void rDebugFileIo::stopUring()           {}
+void rDebugFileIo::queuePiece( int )     {}
+void rDebugFileIo::reap( bool )          {}
+void rDebugFileIo::waitBuffer( int )     {}
+void rDebugFileIo::waitAll()             {}
+
+#endif // RDEBUG_FILEIO_URING
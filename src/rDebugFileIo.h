@@ -0,0 +1,154 @@
+#ifndef RDEBUGFILEIO_H
+#define RDEBUGFILEIO_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugFileIo.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QString>
+#include <QByteArray>
+#include <memory>
+#include <string>
+
+class QFile;
+
+
+// -----------------------
+// the bytes of rDebug_Filewriter into the file: the sink append()s whole lines, submit() hands them to the OS.
+// usage:
+//    rDebugFileIo File;
+//    File.open( "app.log", rDebugFileIo::IoUring ); // backend() tells, what it got
+//    File.append( Line );
+//    File.submit();
+// note:
+//    - QtFile : a QFile in append and text mode, submit() is QFile::flush(). The default, and the only one on Windows
+//    - Pwritev: (Unix) own buffers of 256 KiB, submit() writes all filled ones with a single pwritev()
+//    - IoUring: (Linux) the same buffers, registered with the kernel. submit() queues them as async writes and
+//      returns at once, completions are reaped by the next calls without waiting. Only if a buffer is needed
+//      again while its bytes are still in flight, append() waits for them.
+//      Falls back to Pwritev, if the kernel has no io_uring or forbids it (like some container runtimes do).
+//      Built on the raw syscalls, so no liburing is needed. RDEBUG_NO_IO_URING leaves it out.
+//    - submit( true ) waits for the writes in flight, sync() does too and calls fdatasync(), close() waits as well
+//    - submitDSync() writes the bytes not submitted yet through a second descriptor with O_DSYNC, so they are on
+//      the disk without an own fdatasync(). Bytes submitted before through the normal descriptor (Flushed lines,
+//      full buffers, io_uring writes) get an fdatasync() first, so the file has no hole in front of them after a
+//      crash. unsynced() tells, if there are such bytes
+//    - syncHandle() is a duplicate of the descriptor, which stays valid after close(). rDebug_Filewriter uses it
+//      for the fdatasync() of a group commit, without holding its mutex
+//    - Pwritev and IoUring write at own offsets, so they have to be the only writer of the file
+//    - setCompression( Gzip ) before open(): the bytes go through zlib first, as a series of gzip members
+//      (frames). A frame is closed, when FrameBytes of lines went into it, or it is older than FrameMs at the
+//      next submit() or frameDue() check. Concatenated members are a valid .gz file, so zcat and gunzip read it
+//      as one, and a crash loses the open frame only. sync(), submitDSync() and close() close the frame too.
+//      size() counts the compressed bytes then. RDEBUG_NO_ZLIB (CONFIG+=nozlib) leaves it out
+//    - not thread-safe, rDebug_Filewriter calls it with its mutex held
+// -----------------------
+class rDebugFileIo
+{
+public:
+  enum Backend { QtFile, Pwritev, IoUring };
+  enum Compression { Plain, Gzip };
+
+  rDebugFileIo();
+  ~rDebugFileIo();
+
+  bool open( const QString& FileName, Backend Wanted );
+  void close();
+  bool isOpen() const { return mpQFile || mFd >= 0; }
+  Backend backend() const { return mBackend; }
+  const QString& fileName() const { return mFileName; }
+  qint64 size() const { return mSize; } // of the file, including the bytes not submitted yet
+
+  void append( const char* Data, int Size );
+  void append( const QByteArray& Bytes ) { append( Bytes.constData(), Bytes.size() ); }
+  void append( const std::string& Bytes ) { append( Bytes.data(), static_cast<int>( Bytes.size() ) ); }
+  bool pending() const;                 // bytes not submitted yet
+  void submit( bool Wait=false );       // Wait: return, when the kernel has taken all (IoUring), else just queue them
+  void submitDSync();
+  void sync();
+  bool unsynced() const { return mUnsynced; } // bytes went to the kernel since the last fdatasync()
+  std::shared_ptr<const int> syncHandle() const { return mpSyncFd; }
+
+  void setCompression( Compression Mode, int FrameBytes=0x100000, int FrameMs=2000 ); // for the next open()
+  Compression compression() const { return mCompression; } // as set, Plain if not available
+  bool frameDue() const;                // the open frame is older than FrameMs
+  void closeFrame();
+
+  static bool available( Backend Which );
+  static bool available( Compression Which );
+  static const char* name( Backend Which );
+  static void datasync( int Fd );
+
+private:
+  rDebugFileIo( const rDebugFileIo& );
+  rDebugFileIo& operator=( const rDebugFileIo& );
+
+  enum { BufferSize = 0x40000, Buffers = 4, MaxPieces = 32 };
+
+  bool openPosix( const QString& FileName );
+  void appendRaw( const char* Data, int Size );
+  void startZip();
+  void stopZip();
+  void deflateTo( int Flush );          // Gzip: the input of the stream into the file
+  void shareHandle( int Fd );
+  void nextBuffer();
+  void writePending( int Fd );          // Pwritev
+  void writeAt( int Fd, const char* Data, qint64 Size, qint64 Offset ); // synchronous, until all is written
+
+  struct Zip;
+  struct Uring;
+  bool startUring();
+  void stopUring();
+  void queuePiece( int Buffer );        // IoUring: [mSent,mFill) of the buffer as one async write
+  void reap( bool Wait );
+  void waitBuffer( int Buffer );
+  void waitAll();
+
+  Backend     mBackend;
+  QString     mFileName;
+  QFile*      mpQFile;                  // QtFile
+  int         mFd;                      // Pwritev, IoUring
+  int         mDSyncFd;                 // opened on the first submitDSync()
+  std::shared_ptr<const int> mpSyncFd;
+  qint64      mSize;
+  qint64      mOffset;                  // end of the bytes given to the kernel
+  char*       mpBuffers;                // Buffers * BufferSize
+  int         mFill[Buffers];           // bytes in the buffer
+  int         mSent[Buffers];           // of these already submitted
+  int         mInFlight[Buffers];       // IoUring: writes of the buffer, not completed yet
+  int         mFirst;                   // Pwritev: first buffer with bytes not written yet
+  int         mCurrent;                 // the buffer append() fills
+  bool        mUnsynced;                // see unsynced()
+  Uring*      mpUring;
+  Compression mCompression;
+  int         mFrameBytes;
+  int         mFrameMs;
+  Zip*        mpZip;                    // Gzip, while open
+};
+
+#endif // RDEBUGFILEIO_H
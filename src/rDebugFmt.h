@@ -0,0 +1,164 @@
+#ifndef RDEBUGFMT_H
+#define RDEBUGFMT_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugFmt.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <type_traits>
+
+
+// -----------------------
+// the format strings of rDebug_f(), rInfo_f(), ... checked and cut into segments while compiling.
+// usage:
+//    rInfo_f( "user {} logged in after {} ms, flags {:x}", UserName, Elapsed, Flags );
+// supported placeholders:
+//    {}     the argument as operator<< of rDebugBase writes it, so every type it takes is allowed
+//    {:x} {:o} {:b} {:d}   an integer in hex, octal, binary or decimal
+//    {{ }}  a literal '{' or '}'
+// note:
+//    - a format string with a wrong number of {}, a spec on a non integer, or an unpaired brace does not compile
+//    - the Layout is a constexpr of each call site: the literal parts are offsets into the string literal,
+//      so at run time the line is just copies of those parts and the arguments, there is no parsing.
+//      With rDebug_AsyncWriter's deferred formatting, the literal parts are not even copied (see rDebugBase::format())
+//    - the checks are C++11 constexpr recursion, one level per character: keep a format string below
+//      about 400 characters (the constexpr depth of gcc is 512 by default)
+// -----------------------
+namespace rDebugFmt
+{
+  enum { Invalid = -1 };
+
+  // end of the placeholder starting with the '{' at s[i], or Invalid
+  constexpr int placeholderEnd( const char* s, int i )
+  {
+    return ( s[i+1] == '}' ) ? i+2
+         : ( s[i+1] == ':' && ( s[i+2]=='x' || s[i+2]=='o' || s[i+2]=='b' || s[i+2]=='d' ) && s[i+3] == '}' ) ? i+4
+         : Invalid;
+  }
+
+  constexpr int addOne( int n ) { return ( n == Invalid ) ? Invalid : n+1; }
+
+  // the number of placeholders from s[i] on, or Invalid
+  constexpr int count( const char* s, int i=0 )
+  {
+    return ( s[i] == 0 ) ? 0
+         : ( s[i] == '{' && s[i+1] == '{' ) ? count( s, i+2 )
+         : ( s[i] == '}' && s[i+1] == '}' ) ? count( s, i+2 )
+         : ( s[i] == '}' ) ? Invalid
+         : ( s[i] == '{' ) ? ( ( placeholderEnd( s, i ) == Invalid ) ? Invalid : addOne( count( s, placeholderEnd( s, i ) ) ) )
+         : count( s, i+1 );
+  }
+
+  // where placeholder k starts (its '{'), the end of the string for k = count()
+  constexpr int start( const char* s, int k, int i=0 )
+  {
+    return ( s[i] == 0 ) ? i
+         : ( ( s[i] == '{' && s[i+1] == '{' ) || ( s[i] == '}' && s[i+1] == '}' ) ) ? start( s, k, i+2 )
+         : ( s[i] == '{' ) ? ( ( k == 0 || placeholderEnd( s, i ) == Invalid ) ? i : start( s, k-1, placeholderEnd( s, i ) ) )
+         : start( s, k, i+1 );
+  }
+
+  // where the literal part in front of placeholder k starts
+  constexpr int segmentBegin( const char* s, int k )
+  {
+    return ( k == 0 ) ? 0
+         : ( s[start( s, k-1 )] == 0 || placeholderEnd( s, start( s, k-1 ) ) == Invalid ) ? start( s, k-1 ) // the static_assert tells
+         : placeholderEnd( s, start( s, k-1 ) );
+  }
+
+  constexpr char spec( const char* s, int k )
+  {
+    return ( s[start( s, k )] == '{' && s[start( s, k ) + 1] == ':' ) ? s[start( s, k ) + 2] : 0;
+  }
+
+  constexpr bool escaped( const char* s, int From, int To )
+  {
+    return ( From+1 < To ) && ( ( s[From] == '{' && s[From+1] == '{' ) || ( s[From] == '}' && s[From+1] == '}' ) || escaped( s, From+1, To ) );
+  }
+
+
+  // which specs an argument type takes
+  template<class T> constexpr bool isInteger()
+  {
+    return std::is_integral<T>::value && !std::is_same<T,bool>::value && !std::is_same<T,char>::value;
+  }
+
+  template<int K> constexpr bool specsFit( const char* ) { return true; }
+  template<int K, class A, class... More> constexpr bool specsFit( const char* s )
+  {
+    return ( spec( s, K ) == 0 || isInteger<A>() ) && specsFit<K+1, More...>( s );
+  }
+
+
+  // the types of the arguments of a call, see RDEBUG_FORMATTED
+  template<class... A> struct Args
+  {
+    enum { Count = sizeof...(A) };
+    static constexpr bool countFits( const char* s ) { return count( s ) == Count; }
+    static constexpr bool specsFit( const char* s )  { return rDebugFmt::specsFit<0, A...>( s ); }
+  };
+  template<class... A> Args<typename std::decay<A>::type...> argsOf( const A&... ); // for decltype() only
+
+
+  template<int... I> struct Indices {};
+  template<int N, int... I> struct MakeIndices : MakeIndices<N-1, N-1, I...> {};
+  template<int... I> struct MakeIndices<0, I...> { typedef Indices<I...> Type; };
+
+
+  // segment i is the literal text [mBegin[i],mEnd[i]) in front of placeholder i, the last one is behind all
+  template<int N> struct Layout
+  {
+    int  mBegin[N+1];
+    int  mEnd[N+1];
+    char mSpec[N+1];    // of placeholder i, 0 for {}
+    bool mEscaped[N+1]; // the segment has a {{ or }} to be made single
+  };
+
+  template<int N, int... I> constexpr Layout<N> layout( const char* s, Indices<I...> )
+  {
+    return Layout<N>{ { segmentBegin( s, I )... }, { start( s, I )... }, { spec( s, I )... }, { escaped( s, segmentBegin( s, I ), start( s, I ) )... } };
+  }
+
+  template<int N> constexpr Layout<N> layout( const char* s )
+  {
+    return layout<N>( s, typename MakeIndices<N+1>::Type() );
+  }
+
+} // namespace rDebugFmt
+
+
+// the call behind rDebug_f(), rInfo_f(), ...: the checks and the Layout are done by the compiler
+#define RDEBUG_FORMATTED( Level, Fmt, ... ) \
+  do { \
+    typedef decltype( rDebugFmt::argsOf( __VA_ARGS__ ) ) rDebugFmtArgs; \
+    static_assert( rDebugFmtArgs::countFits( Fmt ), "rDebug format: the number of {} differs from the arguments, or a brace is not paired" ); \
+    static_assert( !rDebugFmtArgs::countFits( Fmt ) || rDebugFmtArgs::specsFit( Fmt ), "rDebug format: {:x} {:o} {:b} {:d} are for integers only" ); \
+    static constexpr rDebugFmt::Layout<rDebugFmtArgs::Count> rDebugFmtLayout = rDebugFmt::layout<rDebugFmtArgs::Count>( Fmt ); \
+    rDebugBase( __FILE__, __LINE__, __PRETTY_FUNCTION__ ).Level().format( Fmt, rDebugFmtLayout, ##__VA_ARGS__ ); \
+  } while(0)
+
+#endif // RDEBUGFMT_H
@@ -0,0 +1,252 @@
+#ifndef RDEBUGFORMAT_H
+#define RDEBUGFORMAT_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugFormat.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>  // memcpy
+#include <stdio.h>   // snprintf, fallback of formatDouble
+#include <stdlib.h>  // strtod
+#include <math.h>
+
+#if (__cplusplus >= 201703L) && defined(__has_include)
+#  if __has_include(<charconv>)
+#    include <charconv>
+#  endif
+#endif
+
+
+// -----------------------
+// number to text conversion for the operator<< of rDebugBase and rDebugArgs::render(),
+// writing ASCII into a caller provided char buffer of at least rDebugFormat::MaxChars.
+// Returns the number of chars written, there is no '\0' appended.
+// note:
+//    - integers: table driven for base 10 (two digits per division) and 16, shift based for 8 and 2,
+//      any other base 2..36 via a generic loop. Negative values are written as '-' + magnitude,
+//      like QTextStream does it also for hex/oct/bin.
+//    - doubles: shortest text, which reads back to the same double. std::to_chars where available (C++17),
+//      else the same text by hand: the digits of integral values via the integer path, the others via
+//      "%.14e".."%.16e" + round-trip check, then fixed or exponent notation, whichever is shorter
+//      (fixed on a tie), like to_chars does it. testing/rDebug_FormatTest checks both against a table.
+//    - pointers: "0x" + hex digits
+// -----------------------
+namespace rDebugFormat
+{
+  enum { MaxChars = 72 }; // 64 binary digits + sign, or the longest double
+
+  static const char DigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+  static const char Digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+
+  inline int formatUnsigned( char* dst, uint64_t num, int base=10 )
+  {
+    char  tmp[MaxChars];
+    char* const end = tmp + sizeof(tmp);
+    char* pos = end;
+
+    switch( base )
+    {
+      case 10:
+        while( num >= 100 )
+        {
+          const unsigned idx = static_cast<unsigned>( num % 100 ) * 2;
+          num /= 100;
+          *--pos = DigitPairs[idx+1];
+          *--pos = DigitPairs[idx];
+        }
+        if( num >= 10 )
+        {
+          const unsigned idx = static_cast<unsigned>( num ) * 2;
+          *--pos = DigitPairs[idx+1];
+          *--pos = DigitPairs[idx];
+        }
+        else
+          *--pos = static_cast<char>( '0' + num );
+        break;
+      case 16: do { *--pos = Digits[num & 0x0F]; num >>= 4; } while( num ); break;
+      case  8: do { *--pos = Digits[num & 0x07]; num >>= 3; } while( num ); break;
+      case  2: do { *--pos = Digits[num & 0x01]; num >>= 1; } while( num ); break;
+      default:
+        if( base < 2 || base > 36 )
+          base = 10;
+        do { *--pos = Digits[num % static_cast<unsigned>(base)]; num /= static_cast<unsigned>(base); } while( num );
+        break;
+    }
+
+    const int len = static_cast<int>( end - pos );
+    memcpy( dst, pos, static_cast<size_t>(len) );
+    return len;
+  }
+
+
+  inline int formatSigned( char* dst, int64_t num, int base=10 )
+  {
+    if( num >= 0 )
+      return formatUnsigned( dst, static_cast<uint64_t>(num), base );
+    *dst = '-';
+    return 1 + formatUnsigned( dst+1, 0 - static_cast<uint64_t>(num), base ); // also fine for INT64_MIN
+  }
+
+
+  inline int formatPointer( char* dst, const void* vptr )
+  {
+    dst[0] = '0';
+    dst[1] = 'x';
+    return 2 + formatUnsigned( dst+2, static_cast<uint64_t>( reinterpret_cast<uintptr_t>(vptr) ), 16 );
+  }
+
+
+#if !( defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L) )
+  // the significant digits (no trailing zeros) and the exponent of the first one, as fixed or
+  // exponent notation, whichever is shorter. Fixed on a tie, like printf("%f") and to_chars do.
+  // A fixed integral value beyond 2^53 gets its exact digits instead of zeros, as with to_chars.
+  inline int formatDecimal( char* dst, double value, const char* digits, int count, int exp10 )
+  {
+    const bool neg      = signbit(value) != 0;
+    const int expDigits = ( exp10 <= -100 || exp10 >= 100 ) ? 3 : 2;
+    const int sciLen    = count + ( count > 1 ? 1 : 0 ) + 2 + expDigits;
+    const int fixedLen  = ( exp10 >= 0 ) ? ( ( count > exp10+1 ) ? count + 1 : exp10 + 1 )
+                                         : 1 + 1 + (-exp10-1) + count;
+    char* pos = dst;
+    if( neg )
+      *pos++ = '-';
+    if( fixedLen <= sciLen )
+    {
+      if( exp10 >= count && fabs(value) >= 9007199254740992.0 )
+        pos += snprintf( pos, MaxChars-1, "%.0f", fabs(value) ); // < 1e23 here, no decimal point
+      else if( exp10 >= 0 )
+      {
+        const int intDigits = ( count < exp10+1 ) ? count : exp10+1;
+        memcpy( pos, digits, static_cast<size_t>(intDigits) );
+        pos += intDigits;
+        for( int i=count ; i<exp10+1 ; ++i )
+          *pos++ = '0';
+        if( count > exp10+1 )
+        { *pos++ = '.';
+          memcpy( pos, digits + intDigits, static_cast<size_t>(count - intDigits) );
+          pos += count - intDigits;
+        }
+      }
+      else
+      {
+        *pos++ = '0';
+        *pos++ = '.';
+        for( int i=1 ; i<-exp10 ; ++i )
+          *pos++ = '0';
+        memcpy( pos, digits, static_cast<size_t>(count) );
+        pos += count;
+      }
+    }
+    else
+    {
+      *pos++ = digits[0];
+      if( count > 1 )
+      { *pos++ = '.';
+        memcpy( pos, digits+1, static_cast<size_t>(count-1) );
+        pos += count-1;
+      }
+      *pos++ = 'e';
+      *pos++ = ( exp10 < 0 ) ? '-' : '+';
+      const int mag = ( exp10 < 0 ) ? -exp10 : exp10;
+      if( expDigits == 3 )
+        *pos++ = static_cast<char>( '0' + mag / 100 );
+      *pos++ = static_cast<char>( '0' + mag / 10 % 10 );
+      *pos++ = static_cast<char>( '0' + mag % 10 );
+    }
+    return static_cast<int>( pos - dst );
+  }
+#endif
+
+
+  inline int formatDouble( char* dst, double dbl )
+  {
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+    return static_cast<int>( std::to_chars( dst, dst + MaxChars, dbl ).ptr - dst );
+#else
+    const bool neg = signbit(dbl) != 0;
+    if( dbl != dbl )
+    { memcpy( dst, "-nan" + (neg ? 0 : 1), neg ? 4 : 3 );
+      return neg ? 4 : 3;
+    }
+    if( dbl == HUGE_VAL || dbl == -HUGE_VAL )
+    { memcpy( dst, "-inf" + (neg ? 0 : 1), neg ? 4 : 3 );
+      return neg ? 4 : 3;
+    }
+
+    char digits[MaxChars];
+    int  count = 0;
+    int  exp10 = 0;
+    if( dbl == floor(dbl) && fabs(dbl) < 9007199254740992.0 ) // 2^53: integral, all digits exact in uint64
+    {
+      count = formatUnsigned( digits, static_cast<uint64_t>( fabs(dbl) ) );
+      exp10 = count - 1;
+    }
+    else
+    {
+      // 15 significant digits round-trip for any normal double, so if they read back, the shortest
+      // text is them without the trailing zeros. Else 16 or 17. Subnormals have less precision,
+      // they may need only 1, so try all.
+      char text[MaxChars];
+      const int first = ( fabs(dbl) < 2.2250738585072014e-308 ) ? 1 : 15;
+      for( int prec=first ; prec<=17 ; ++prec )
+      {
+        snprintf( text, sizeof(text), "%.*e", prec-1, dbl );
+        if( prec==17 || strtod( text, nullptr ) == dbl ) // snprintf and strtod use the same locale
+          break;
+      }
+      // [-]d[.ddd]e[+-]xx, the decimal point may be a ',' in a Qt application (setlocale(LC_ALL,""))
+      const char* pos = text + ( text[0] == '-' ? 1 : 0 );
+      digits[count++] = *pos++;
+      if( *pos != 'e' )
+        ++pos;
+      while( *pos >= '0' && *pos <= '9' )
+        digits[count++] = *pos++;
+      exp10 = static_cast<int>( strtol( pos+1, nullptr, 10 ) );
+    }
+    while( count > 1 && digits[count-1] == '0' )
+      --count;
+    return formatDecimal( dst, dbl, digits, count, exp10 );
+#endif
+  }
+
+} // namespace rDebugFormat
+
+#endif // RDEBUGFORMAT_H
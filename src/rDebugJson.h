@@ -0,0 +1,140 @@
+#ifndef RDEBUGJSON_H
+#define RDEBUGJSON_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugJson.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <stddef.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && (_M_IX86_FP>=2) )
+#  include <emmintrin.h>
+#  define RDEBUG_JSON_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+
+// -----------------------
+// minimal JSON string escaper, used by the JSON-Lines mode of rDebug_Filewriter.
+// input is UTF-8, bytes >= 0x80 are passed through unchanged (JSON allows raw UTF-8),
+// only '"', '\\' and control characters < 0x20 need to be escaped.
+// The Buffer just needs an append( const char*, int ), so QByteArray or std::string will do.
+// usage:
+//    QByteArray line;
+//    rDebugJson::appendString( line, msg.constData(), msg.size() );
+// -----------------------
+namespace rDebugJson
+{
+  inline int lowestBit( unsigned mask )
+  {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward( &idx, mask );
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctz( mask );
+#endif
+  }
+
+
+  // returns the number of leading bytes, which can be copied without any escaping
+  inline size_t plainPrefix( const char* str, size_t len )
+  {
+    size_t pos = 0;
+#if defined(RDEBUG_JSON_SSE2)
+    const __m128i quote  = _mm_set1_epi8( '"' );
+    const __m128i bslash = _mm_set1_epi8( '\\' );
+    const __m128i ctrl   = _mm_set1_epi8( 0x1F );
+    for( ; pos+16 <= len ; pos += 16 )
+    {
+      const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>(str+pos) );
+      const __m128i hits  = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chunk, quote ), _mm_cmpeq_epi8( chunk, bslash ) ),
+                                          _mm_cmpeq_epi8( _mm_min_epu8( chunk, ctrl ), chunk ) ); // unsigned chunk <= 0x1F
+      const unsigned mask = static_cast<unsigned>( _mm_movemask_epi8( hits ) );
+      if( mask )
+        return pos + static_cast<size_t>( lowestBit( mask ) );
+    }
+#endif
+    for( ; pos < len ; ++pos )
+    {
+      const unsigned char ch = static_cast<unsigned char>( str[pos] );
+      if( ch < 0x20 || ch == '"' || ch == '\\' )
+        break;
+    }
+    return pos;
+  }
+
+
+  template<class Buffer>
+  void appendEscaped( Buffer& out, const char* str, size_t len )
+  {
+    static const char HexDigits[] = "0123456789abcdef";
+    while( len )
+    {
+      const size_t plain = plainPrefix( str, len );
+      if( plain )
+        out.append( str, static_cast<int>(plain) );
+      str += plain;
+      len -= plain;
+      if( !len )
+        break;
+
+      const unsigned char ch = static_cast<unsigned char>( *str++ );
+      --len;
+      switch( ch )
+      {
+        case '"' : out.append( "\\\"", 2 ); break;
+        case '\\': out.append( "\\\\", 2 ); break;
+        case '\n': out.append( "\\n",  2 ); break;
+        case '\r': out.append( "\\r",  2 ); break;
+        case '\t': out.append( "\\t",  2 ); break;
+        case '\b': out.append( "\\b",  2 ); break;
+        case '\f': out.append( "\\f",  2 ); break;
+        default  :
+        { const char uni[6] = { '\\', 'u', '0', '0', HexDigits[ch>>4], HexDigits[ch&0x0F] };
+          out.append( uni, 6 );
+        } break;
+      }
+    }
+  }
+
+
+  // "str" including the quotes
+  template<class Buffer>
+  void appendString( Buffer& out, const char* str, size_t len )
+  {
+    out.append( "\"", 1 );
+    if( str )
+      appendEscaped( out, str, len );
+    out.append( "\"", 1 );
+  }
+
+} // namespace rDebugJson
+
+#endif // RDEBUGJSON_H
@@ -0,0 +1,384 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugMetrics.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QFile>
+#include <QMutexLocker>
+#include <QList>
+#if (QT_VERSION >= 0x050100)
+#  include <QSaveFile>
+#endif
+#if defined(QT_NETWORK_LIB)
+#  include <QTcpServer>
+#  include <QTcpSocket>
+#  include <QLocalServer>
+#  include <QLocalSocket>
+#  include <QHostAddress>
+#endif
+
+#include "rDebugMetrics.h"
+#include "rDebugStats.h"
+#include "rDebug.h"
+
+
+namespace
+{
+  const char* const SinkLabel[ rDebugStats::SinkCount ] = { "signal", "file", "qdebug" };
+  const rDebugStats::Histogram SinkHist[ rDebugStats::SinkCount ] = { rDebugStats::HistSignalWrite, rDebugStats::HistFileWrite, rDebugStats::HistQDebugWrite };
+  const int FirstBucket = 9; // smaller latencies than 1us are just summed up in the first "le"
+
+
+  void appendLabelValue( QByteArray& Out, const char* Value )
+  {
+    Out += '"';
+    for( const char* p = (Value) ? Value : "" ; *p ; ++p )
+    {
+      switch( *p )
+      {
+        case '\\': Out += "\\\\"; break;
+        case '"' : Out += "\\\""; break;
+        case '\n': Out += "\\n";  break;
+        default  : Out += *p;     break;
+      }
+    }
+    Out += '"';
+  }
+
+
+  void appendHeader( QByteArray& Out, const char* Name, const char* Type, const char* Help )
+  {
+    Out += "# HELP "; Out += Name; Out += ' '; Out += Help; Out += '\n';
+    Out += "# TYPE "; Out += Name; Out += ' '; Out += Type; Out += '\n';
+  }
+
+
+  void appendSample( QByteArray& Out, const char* Name, const char* LabelName, const char* LabelValue, quint64 Value )
+  {
+    Out += Name;
+    if( LabelName )
+    { Out += '{'; Out += LabelName; Out += '='; appendLabelValue( Out, LabelValue ); Out += '}';
+    }
+    Out += ' ';
+    Out += QByteArray::number( Value );
+    Out += '\n';
+  }
+
+
+  // the rDebugStats buckets are log2 of ns, "le" is the upper bound in seconds
+  void appendHistogram( QByteArray& Out, const char* Name, const char* LabelName, const char* LabelValue, const rDebugStats::Snapshot& Stats, rDebugStats::Histogram Hist )
+  {
+    QByteArray Labels;
+    if( LabelName )
+    { Labels += LabelName; Labels += '='; appendLabelValue( Labels, LabelValue ); Labels += ',';
+    }
+
+    quint64 Cumulated = 0;
+    for( int b=0 ; b<rDebugStats::Buckets-1 ; ++b )
+    {
+      Cumulated += Stats.mHist[Hist][b];
+      if( b < FirstBucket )
+        continue;
+      Out += Name; Out += "_bucket{"; Out += Labels; Out += "le=\"";
+      Out += QByteArray::number( static_cast<double>( Q_UINT64_C(1) << (b+1) ) * 1e-9, 'g', 6 );
+      Out += "\"} "; Out += QByteArray::number( Cumulated ); Out += '\n';
+    }
+    const quint64 Count = Stats.count( Hist );
+    Out += Name; Out += "_bucket{"; Out += Labels; Out += "le=\"+Inf\"} "; Out += QByteArray::number( Count ); Out += '\n';
+
+    if( LabelName )
+      Labels.chop(1); // the ','
+    Out += Name; Out += "_sum";
+    if( LabelName ) { Out += '{'; Out += Labels; Out += '}'; }
+    Out += ' '; Out += QByteArray::number( static_cast<double>( Stats.mHistSumNs[Hist] ) * 1e-9, 'g', 12 ); Out += '\n';
+    Out += Name; Out += "_count";
+    if( LabelName ) { Out += '{'; Out += Labels; Out += '}'; }
+    Out += ' '; Out += QByteArray::number( Count ); Out += '\n';
+  }
+
+
+#if defined(QT_NETWORK_LIB)
+  // one HTTP/1.0 request, one response, then the caller closes the connection
+  template<class Socket>
+  void serve( Socket& Client, int TopCallSites )
+  {
+    QByteArray Request;
+    while( !Request.contains( "\r\n\r\n" ) && !Request.contains( "\n\n" ) && Request.size() < 8192 )
+    {
+      if( !Client.waitForReadyRead( 2000 ) )
+        break;
+      Request += Client.readAll();
+    }
+
+    const QList<QByteArray> RequestLine = Request.left( Request.indexOf( '\n' ) ).trimmed().split( ' ' );
+    const QByteArray Method = ( RequestLine.size() > 1 ) ? RequestLine.at(0) : QByteArray();
+    QByteArray Path         = ( RequestLine.size() > 1 ) ? RequestLine.at(1) : QByteArray();
+    if( Path.contains( '?' ) )
+      Path.truncate( Path.indexOf( '?' ) );
+
+    QByteArray Status = "200 OK";
+    QByteArray Body;
+    if( Method != "GET" && Method != "HEAD" )
+    { Status = "405 Method Not Allowed";
+      Body   = "only GET is supported\n";
+    }
+    else if( Path != "/metrics" && Path != "/" )
+    { Status = "404 Not Found";
+      Body   = "try /metrics\n";
+    }
+    else
+    { Body = rDebug_MetricsExporter::prometheusText( TopCallSites );
+    }
+
+    QByteArray Response;
+    Response.reserve( Body.size() + 160 );
+    Response += "HTTP/1.0 "; Response += Status; Response += "\r\n";
+    Response += "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+    Response += "Content-Length: "; Response += QByteArray::number( Body.size() ); Response += "\r\n";
+    Response += "Connection: close\r\n\r\n";
+    if( Method != "HEAD" )
+      Response += Body;
+    Client.write( Response );
+    Client.waitForBytesWritten( 2000 );
+  }
+#endif
+}
+
+
+QByteArray rDebug_MetricsExporter::prometheusText( int TopCallSites )
+{
+  const rDebugStats::Snapshot Stats( rDebugStats::snapshot() );
+  QByteArray Out;
+  Out.reserve( 16384 );
+
+  appendHeader( Out, "rdebug_lines_total", "counter", "Log lines passing the global level, per level." );
+  for( int l=0 ; l<rDebugStats::Levels ; ++l )
+    appendSample( Out, "rdebug_lines_total", "level", rDebugBase::getLevelKey( static_cast<rDebugLevel::rMsgType>(l) ), Stats.mEmitted[l] );
+
+  appendHeader( Out, "rdebug_lines_filtered_total", "counter", "Log lines dropped by the global level, per level." );
+  for( int l=0 ; l<rDebugStats::Levels ; ++l )
+    appendSample( Out, "rdebug_lines_filtered_total", "level", rDebugBase::getLevelKey( static_cast<rDebugLevel::rMsgType>(l) ), Stats.mFiltered[l] );
+
+  appendHeader( Out, "rdebug_sink_lines_total", "counter", "Log lines written by a sink." );
+  for( int k=0 ; k<rDebugStats::SinkCount ; ++k )
+    appendSample( Out, "rdebug_sink_lines_total", "sink", SinkLabel[k], Stats.mSinkLines[k] );
+
+  appendHeader( Out, "rdebug_sink_filtered_total", "counter", "Log lines dropped by the level of a sink." );
+  for( int k=0 ; k<rDebugStats::SinkCount ; ++k )
+    appendSample( Out, "rdebug_sink_filtered_total", "sink", SinkLabel[k], Stats.mSinkFiltered[k] );
+
+  appendHeader( Out, "rdebug_file_bytes_total", "counter", "Bytes written to the logfile." );
+  appendSample( Out, "rdebug_file_bytes_total", nullptr, nullptr, Stats.mBytesWritten );
+  appendHeader( Out, "rdebug_file_flushes_total", "counter", "Flushes of the logfile." );
+  appendSample( Out, "rdebug_file_flushes_total", nullptr, nullptr, Stats.mFlushes );
+  appendHeader( Out, "rdebug_file_syncs_total", "counter", "Syncs of the logfile to disk (fdatasync() per group commit, O_DSYNC writes)." );
+  appendSample( Out, "rdebug_file_syncs_total", nullptr, nullptr, Stats.mSyncs );
+  appendHeader( Out, "rdebug_file_rotations_total", "counter", "Rotations of the logfile." );
+  appendSample( Out, "rdebug_file_rotations_total", nullptr, nullptr, Stats.mRotations );
+
+  appendHeader( Out, "rdebug_queue_depth", "gauge", "Lines waiting in the rDebug_AsyncWriter queue." );
+  appendSample( Out, "rdebug_queue_depth", nullptr, nullptr, Stats.mQueueDepth );
+  appendHeader( Out, "rdebug_queue_depth_max", "gauge", "High water mark of the rDebug_AsyncWriter queue." );
+  appendSample( Out, "rdebug_queue_depth_max", nullptr, nullptr, Stats.mQueueDepthMax );
+  appendHeader( Out, "rdebug_queue_dropped_total", "counter", "Lines dropped by a full rDebug_AsyncWriter queue." );
+  appendSample( Out, "rdebug_queue_dropped_total", nullptr, nullptr, Stats.mDropped );
+
+  appendHeader( Out, "rdebug_callsite_lines_total", "counter", "Log lines passing the global level, per call site (top N by lines)." );
+  const QVector<rDebugStats::CallSite> Sites( rDebugStats::topCallSites( TopCallSites ) );
+  for( int i=0 ; i<Sites.size() ; ++i )
+  {
+    const rDebugStats::CallSite& Site = Sites.at(i);
+    Out += "rdebug_callsite_lines_total{file=";
+    appendLabelValue( Out, Site.mFile );
+    Out += ",line=\""; Out += QByteArray::number( Site.mLine );
+    Out += "\",level=\""; Out += rDebugBase::getLevelKey( Site.mLevel );
+    Out += "\"} "; Out += QByteArray::number( Site.mCount ); Out += '\n';
+  }
+  appendHeader( Out, "rdebug_callsite_other_lines_total", "counter", "Log lines of call sites, which did not fit into the call site table." );
+  appendSample( Out, "rdebug_callsite_other_lines_total", nullptr, nullptr, Stats.mCallSitesOther );
+
+  appendHeader( Out, "rdebug_sink_write_seconds", "histogram", "Time to hand one line to a sink." );
+  for( int k=0 ; k<rDebugStats::SinkCount ; ++k )
+    appendHistogram( Out, "rdebug_sink_write_seconds", "sink", SinkLabel[k], Stats, SinkHist[k] );
+
+  appendHeader( Out, "rdebug_enqueue_to_write_seconds", "histogram", "Time from queueing a line in rDebug_AsyncWriter until all sinks got it." );
+  appendHistogram( Out, "rdebug_enqueue_to_write_seconds", nullptr, nullptr, Stats, rDebugStats::HistEnqueueToWrite );
+
+  return Out;
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+rDebug_MetricsExporter::rDebug_MetricsExporter( Target Kind, const QString& Where, int IntervalMs, int TopCallSites )
+  : mKind(Kind)
+  , mWhere(Where)
+  , mIntervalMs( qMax( IntervalMs, 100 ) )
+  , mTopCallSites(TopCallSites)
+  , mStopping(false)
+  , mWorker(this)
+{
+  mWorker.start();
+}
+
+
+rDebug_MetricsExporter::~rDebug_MetricsExporter()
+{
+  {
+    QMutexLocker Lock( &mLock );
+    mStopping = true;
+    mWakeup.wakeAll();
+  }
+  mWorker.wait();
+}
+
+
+bool rDebug_MetricsExporter::stopping()
+{
+  QMutexLocker Lock( &mLock );
+  return mStopping;
+}
+
+
+void rDebug_MetricsExporter::run()
+{
+  switch( mKind )
+  {
+    case File      : runFile();       break;
+    case Http      : runHttp();       break;
+    case UnixSocket: runUnixSocket(); break;
+  }
+}
+
+
+// written aside and renamed, so a reader gets either the old or the new file
+bool rDebug_MetricsExporter::writeFile()
+{
+  const QByteArray Text( prometheusText( mTopCallSites ) );
+#if (QT_VERSION >= 0x050100)
+  QSaveFile Out( mWhere );
+  if( !Out.open( QIODevice::WriteOnly ) )
+    return false;
+  Out.write( Text );
+  return Out.commit();
+#else
+  const QString Temp( mWhere + ".tmp" );
+  {
+    QFile Out( Temp );
+    if( !Out.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+      return false;
+    if( Out.write( Text ) != Text.size() )
+      return false;
+  }
+  QFile::remove( mWhere );
+  return QFile::rename( Temp, mWhere );
+#endif
+}
+
+
+void rDebug_MetricsExporter::runFile()
+{
+  bool Failed = false;
+  QMutexLocker Lock( &mLock );
+  for(;;)
+  {
+    const bool Last = mStopping;
+    Lock.unlock();
+    const bool Ok = writeFile();
+    if( !Ok && !Failed )
+      rError() << "rDebug_MetricsExporter: can not write" << mWhere; // once, not every interval
+    Failed = !Ok;
+    Lock.relock();
+    if( Last )
+      break;
+    if( !mStopping )
+      mWakeup.wait( &mLock, static_cast<unsigned long>( mIntervalMs ) );
+  }
+}
+
+
+void rDebug_MetricsExporter::runHttp()
+{
+#if defined(QT_NETWORK_LIB)
+  QHostAddress Address( QHostAddress::LocalHost );
+  QString Port( mWhere );
+  const int Colon = mWhere.lastIndexOf( ':' );
+  if( Colon >= 0 )
+  { Address.setAddress( mWhere.left( Colon ) );
+    Port = mWhere.mid( Colon+1 );
+  }
+
+  QTcpServer Server;
+  if( !Server.listen( Address, static_cast<quint16>( Port.toUInt() ) ) )
+  { rError() << "rDebug_MetricsExporter: can not listen on" << mWhere << Server.errorString();
+    return;
+  }
+  while( !stopping() )
+  {
+    if( !Server.waitForNewConnection( 250 ) )
+      continue;
+    QTcpSocket* pClient = Server.nextPendingConnection();
+    if( !pClient )
+      continue;
+    serve( *pClient, mTopCallSites );
+    pClient->disconnectFromHost();
+    if( pClient->state() != QAbstractSocket::UnconnectedState )
+      pClient->waitForDisconnected( 1000 );
+    delete pClient;
+  }
+#else
+  rError() << "rDebug_MetricsExporter: Http needs QT += network, nothing exported on" << mWhere;
+#endif
+}
+
+
+void rDebug_MetricsExporter::runUnixSocket()
+{
+#if defined(QT_NETWORK_LIB)
+  QLocalServer::removeServer( mWhere ); // a stale one of a crashed run
+  QLocalServer Server;
+  if( !Server.listen( mWhere ) )
+  { rError() << "rDebug_MetricsExporter: can not listen on" << mWhere << Server.errorString();
+    return;
+  }
+  while( !stopping() )
+  {
+    if( !Server.waitForNewConnection( 250 ) )
+      continue;
+    QLocalSocket* pClient = Server.nextPendingConnection();
+    if( !pClient )
+      continue;
+    serve( *pClient, mTopCallSites );
+    pClient->disconnectFromServer();
+    if( pClient->state() != QLocalSocket::UnconnectedState )
+      pClient->waitForDisconnected( 1000 );
+    delete pClient;
+  }
+#else
+  rError() << "rDebug_MetricsExporter: UnixSocket needs QT += network, nothing exported on" << mWhere;
+#endif
+}
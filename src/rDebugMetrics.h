@@ -0,0 +1,95 @@
+#ifndef RDEBUGMETRICS_H
+#define RDEBUGMETRICS_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugMetrics.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+#include <QByteArray>
+
+
+// -----------------------
+// exports the rDebugStats counters in the Prometheus text format (version 0.0.4):
+// lines per level, the top call sites (__FILE__:__LINE__) by lines, sink write and enqueue-to-write latency.
+// usage:
+//    rDebug_MetricsExporter rLogMetrics( rDebug_MetricsExporter::File, "/var/lib/node_exporter/myapp.prom", 15000 );
+//    rDebug_MetricsExporter rLogMetrics( rDebug_MetricsExporter::Http, "9464" );              // curl http://127.0.0.1:9464/metrics
+//    rDebug_MetricsExporter rLogMetrics( rDebug_MetricsExporter::Http, "0.0.0.0:9464" );      // all interfaces
+//    rDebug_MetricsExporter rLogMetrics( rDebug_MetricsExporter::UnixSocket, "/tmp/myapp.metrics" );
+//                                                                   // curl --unix-socket /tmp/myapp.metrics http://x/metrics
+//    QByteArray Text = rDebug_MetricsExporter::prometheusText();    // or just take the text yourself
+// note:
+//    - File rewrites the file every IntervalMs (and at the end) as a whole, a reader never sees a half one.
+//      made for the textfile collector of the node_exporter.
+//    - Http and UnixSocket need QT += network in the .pro file, without it they log an error and do nothing.
+//      a background thread serves one request after the other with blocking calls, no event loop needed.
+// -----------------------
+class rDebug_MetricsExporter
+{
+public:
+  enum Target { File, Http, UnixSocket };
+
+  rDebug_MetricsExporter( Target Kind, const QString& Where, int IntervalMs=15000, int TopCallSites=20 );
+  virtual ~rDebug_MetricsExporter();
+
+  static QByteArray prometheusText( int TopCallSites=20 );
+
+private:
+  bool stopping();
+  void run();
+  void runFile();
+  void runHttp();
+  void runUnixSocket();
+  bool writeFile();
+
+  class Worker : public QThread
+  {
+  public:
+    explicit Worker( rDebug_MetricsExporter* pOwner ) : mpOwner(pOwner) {}
+  protected:
+    virtual void run() { mpOwner->run(); }
+  private:
+    rDebug_MetricsExporter* mpOwner;
+  };
+
+private:
+  const Target   mKind;
+  const QString  mWhere;
+  const int      mIntervalMs;
+  const int      mTopCallSites;
+  QMutex         mLock;
+  QWaitCondition mWakeup;
+  bool           mStopping;
+  Worker         mWorker;
+};
+
+#endif // RDEBUGMETRICS_H
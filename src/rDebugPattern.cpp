@@ -0,0 +1,162 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugPattern.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QCoreApplication>
+#include <QObject>
+
+#include "rDebugPattern.h"
+#include "rDebug.h"
+
+
+rDebugPattern::Op::Op( OpCode Code, const QString& Text )
+  : mCode(Code)
+  , mText(Text)
+{
+  rDebugArgs::appendString( mUtf8, Text );
+}
+
+
+rDebugPattern::rDebugPattern()
+{}
+
+
+rDebugPattern::rDebugPattern( const QString& Pattern )
+{
+  compile( Pattern );
+}
+
+
+QString rDebugPattern::fromEnvironment()
+{
+  return QString::fromLocal8Bit( qgetenv( "QT_MESSAGE_PATTERN" ) );
+}
+
+
+void rDebugPattern::compile( const QString& Pattern )
+{
+  mPattern = Pattern;
+  mOps.clear();
+
+  for( int lvl=0 ; lvl<8 ; ++lvl )
+  { mLevelNames[lvl].clear();
+    rDebugArgs::appendString( mLevelNames[lvl], rDebugBase::getLevelName( static_cast<rDebugLevel::rMsgType>(lvl) ) );
+  }
+
+  QString Text; // pending literal
+  int pos = 0;
+  while( pos < Pattern.length() )
+  {
+    const int start = Pattern.indexOf( "%{", pos );
+    const int end   = (start<0) ? -1 : Pattern.indexOf( QChar('}'), start+2 );
+    if( start<0 || end<0 )
+    { Text += Pattern.mid( pos );
+      break;
+    }
+    Text += Pattern.mid( pos, start-pos );
+    const QString Key( Pattern.mid( start+2, end-start-2 ) );
+    pos = end+1;
+
+    Op Next;
+    if( Key == "message" )
+      Next = Op( OpMessage );
+    else if( Key == "type" )
+      Next = Op( OpLevel );
+    else if( Key == "time" || Key.startsWith( "time " ) )
+    { const QString Format( ( Key == "time" ) ? QObject::tr("yyyy-MM-dd HH:mm:ss,zzz","local date time format for logging") : Key.mid( 5 ).trimmed() );
+      Next = Op( ( Format == QLatin1String( "yyyy-MM-dd HH:mm:ss,zzz" ) ) ? OpTimeClassic : OpTime, Format );
+    }
+    else if( Key == "file" )
+      Next = Op( OpFile );
+    else if( Key == "line" )
+      Next = Op( OpLine );
+    else if( Key == "function" )
+      Next = Op( OpFunction );
+    else if( Key == "threadid" )
+      Next = Op( OpThreadId );
+    else if( Key == "threadname" )
+      Next = Op( OpThreadName );
+    else if( Key == "seq" )
+      Next = Op( OpSeq );
+    else if( Key == "logid" )
+      Next = Op( OpLogId );
+    else if( Key == "appname" )
+    { Text += QCoreApplication::applicationName();
+      continue;
+    }
+    else if( Key == "pid" )
+    { Text += QString::number( QCoreApplication::applicationPid() );
+      continue;
+    }
+    else
+    { Text += Pattern.mid( start, end-start+1 ); // unknown, keep it visible
+      continue;
+    }
+
+    if( !Text.isEmpty() )
+    { mOps.push_back( Op( OpLiteral, Text ) );
+      Text.clear();
+    }
+    mOps.push_back( Next );
+  }
+
+  if( !Text.isEmpty() )
+    mOps.push_back( Op( OpLiteral, Text ) );
+}
+
+
+const std::string& rDebugPattern::levelName( rDebugLevel::rMsgType Level ) const
+{
+  if( Level < rDebugLevel::rMsgType::Emergency || Level > rDebugLevel::rMsgType::Debug )
+    return mLevelNames[rDebugLevel::rMsgType::Emergency];
+  return mLevelNames[Level];
+}
+
+
+void rDebugPattern::render( std::string& Out, const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span Msg ) const
+{
+  for( std::vector<Op>::const_iterator it = mOps.begin() ; it != mOps.end() ; ++it )
+  {
+    switch( it->mCode )
+    {
+      case OpLiteral : Out += it->mUtf8; break;
+      case OpTime    : rDebugArgs::appendString( Out, QDateTime::fromMSecsSinceEpoch( Time ).toString( it->mText ) ); break;
+      case OpTimeClassic: rDebugCore::appendTime( Out, Time ); break;
+      case OpLevel   : Out += levelName( Level ); break;
+      case OpFile    : Out += ( CodeLocation.mFile ? CodeLocation.mFile : "file" ); break;
+      case OpLine    : rDebugArgs::appendInt( Out, CodeLocation.mLine, 10 ); break;
+      case OpFunction: Out += ( CodeLocation.mFunc ? CodeLocation.mFunc : "func" ); break;
+      case OpThreadId: rDebugArgs::appendUInt( Out, CodeLocation.mThreadId, 10 ); break;
+      case OpThreadName: { char Tmp[rDebugThread::NameChars];
+                           rDebugCore::append( Out, rDebugThread::nameOf( CodeLocation.mThreadName, CodeLocation.mThreadId, Tmp ) ); } break;
+      case OpSeq     : rDebugArgs::appendUInt( Out, CodeLocation.mSeq, 10 ); break;
+      case OpLogId   : rDebugArgs::appendUInt( Out, LogId, 10 ); break;
+      case OpMessage : rDebugCore::append( Out, Msg ); break;
+    }
+  }
+}
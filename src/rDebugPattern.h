@@ -0,0 +1,98 @@
+#ifndef RDEBUGPATTERN_H
+#define RDEBUGPATTERN_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugPattern.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QString>
+#include <QDateTime>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "rDebugLevel.h"
+#include "rDebugCodeloc.h"
+#include "rDebugCore.h"
+
+
+// -----------------------
+// a QT_MESSAGE_PATTERN alike line layout, compiled once into a list of opcodes.
+// usage:
+//    rDebugPattern Layout( "[%{type}] %{appname} (%{file}:%{line}) - %{message}" );
+//    std::string line;
+//    Layout.render( line, CodeLocation, Time, Level, LogId, Msg ); // UTF-8 in, UTF-8 out
+// supported placeholders:
+//    %{time} %{time <QDateTime format>} %{type} %{appname} %{pid} %{file} %{line} %{function}
+//    %{threadid} %{threadname} %{seq} %{logid} %{message}
+// unknown placeholders are kept as literal text, so typos are visible in the log.
+// %{threadid} is the rDebugThread::id() of the logging thread (not the one of the OS), so it is
+// the same in all sinks and also with rDebug_AsyncWriter.
+// note:
+//    compile() is the Qt side (QString, translations, QCoreApplication), render() the plain one:
+//    rendering just walks the opcodes and appends into the given line. There is no parsing
+//    and no QString::arg() per line, level names, appname and pid are resolved while compiling
+//    (appname and pid simply become part of the surrounding literal). Literals and level names are
+//    kept as UTF-8, so they are just byte copies. %{time} in the default format is written by
+//    rDebugCore::formatTime(), only an own format needs a QDateTime per line.
+// -----------------------
+class rDebugPattern
+{
+public:
+  enum OpCode { OpLiteral, OpTime, OpTimeClassic, OpLevel, OpFile, OpLine, OpFunction, OpThreadId, OpThreadName, OpSeq, OpLogId, OpMessage };
+
+  rDebugPattern();
+  explicit rDebugPattern( const QString& Pattern );
+
+  void compile( const QString& Pattern );
+  bool isEmpty() const { return mOps.empty(); }
+  const QString& pattern() const { return mPattern; }
+
+  void render( std::string& Out, const FileLineFunc_t& CodeLocation, rDebugCore::TimeMs Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span Msg ) const;
+  void render( std::string& Out, const FileLineFunc_t& CodeLocation, const QDateTime& Time, rDebugLevel::rMsgType Level, uint64_t LogId, rDebugCore::Span Msg ) const
+  { render( Out, CodeLocation, Time.toMSecsSinceEpoch(), Level, LogId, Msg ); }
+
+  static QString fromEnvironment(); // content of QT_MESSAGE_PATTERN, or empty
+
+private:
+  struct Op
+  {
+    Op() : mCode(OpLiteral) {}
+    Op( OpCode Code, const QString& Text=QString() );
+    OpCode      mCode;
+    QString     mText;  // literal text or time format
+    std::string mUtf8;  // literal text, ready to append
+  };
+
+  const std::string& levelName( rDebugLevel::rMsgType Level ) const;
+
+  QString         mPattern;
+  std::vector<Op> mOps;
+  std::string     mLevelNames[8]; // Emergency(0) .. Debug(7), UTF-8
+};
+
+#endif // RDEBUGPATTERN_H
@@ -0,0 +1,440 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugRecord.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <string.h>  // memcpy
+#include <atomic>
+#include <mutex>
+#include <set>
+
+#include "rDebugRecord.h"
+#include "rDebugFormat.h"
+#include "rDebugUtf8.h"
+
+
+template<class T> static void take( const char*& pos, T& value )
+{
+  memcpy( &value, pos, sizeof(value) );
+  pos += sizeof(value);
+}
+
+
+rDebugArgs::rDebugArgs()
+{}
+
+
+rDebugArgs::rDebugArgs( const rDebugArgs& Other )
+  : mBlob( Other.mBlob )
+  , mHeld( Other.mHeld ? Other.mHeld->clone() : nullptr )
+{}
+
+
+rDebugArgs::rDebugArgs( rDebugArgs&& Other ) noexcept
+  : mBlob( std::move( Other.mBlob ) )
+  , mHeld( std::move( Other.mHeld ) )
+{}
+
+
+rDebugArgs& rDebugArgs::operator=( const rDebugArgs& Other )
+{
+  if( this == &Other )
+    return *this;
+  mBlob = Other.mBlob;
+  assignHeld( Other );
+  return *this;
+}
+
+
+// keeps the own lists, if there are
+void rDebugArgs::assignHeld( const rDebugArgs& Other )
+{
+  if( !Other.mHeld )
+  { if( mHeld )
+      mHeld->clear();
+  }
+  else if( mHeld )
+    mHeld->assign( *Other.mHeld );
+  else
+    mHeld.reset( Other.mHeld->clone() );
+}
+
+
+rDebugArgs& rDebugArgs::operator=( rDebugArgs&& Other ) noexcept
+{
+  mBlob = std::move( Other.mBlob );
+  mHeld = std::move( Other.mHeld );
+  return *this;
+}
+
+
+rDebugArgs::~rDebugArgs()
+{}
+
+
+void rDebugArgs::clear()
+{
+  mBlob.clear();
+  if( mHeld )
+    mHeld->clear();
+}
+
+
+// with the length in front, so render() needs no strlen() and a std::string may have a '\0' inside
+void rDebugArgs::putCStr( const char* str, int len )
+{
+  if( len < 0 )
+    len = static_cast<int>( strlen(str) );
+  put( TagCStr, len );
+  mBlob.append( str, static_cast<size_t>(len) );
+}
+
+
+void rDebugArgs::appendChar( std::string& Out, char ch )
+{
+  if( static_cast<unsigned char>(ch) < 0x80 )
+    Out += ch;
+  else
+    rDebugUtf8::appendLatin1( Out, &ch, 1 );
+}
+
+
+void rDebugArgs::appendString( std::string& Out, const QChar* str, int len )
+{
+  rDebugUtf8::appendUtf16( Out, reinterpret_cast<const uint16_t*>(str), len );
+}
+
+
+void rDebugArgs::appendLatin1( std::string& Out, const char* str, int len )
+{
+  rDebugUtf8::appendLatin1( Out, str, len );
+}
+
+
+void rDebugArgs::appendInt( std::string& Out, int64_t num, int base )
+{
+  char Text[rDebugFormat::MaxChars];
+  Out.append( Text, static_cast<size_t>( rDebugFormat::formatSigned( Text, num, base ) ) );
+}
+
+
+void rDebugArgs::appendUInt( std::string& Out, uint64_t num, int base )
+{
+  char Text[rDebugFormat::MaxChars];
+  Out.append( Text, static_cast<size_t>( rDebugFormat::formatUnsigned( Text, num, base ) ) );
+}
+
+
+void rDebugArgs::appendDouble( std::string& Out, double dbl )
+{
+  char Text[rDebugFormat::MaxChars];
+  Out.append( Text, static_cast<size_t>( rDebugFormat::formatDouble( Text, dbl ) ) );
+}
+
+
+void rDebugArgs::appendPointer( std::string& Out, const void* vptr )
+{
+  char Text[rDebugFormat::MaxChars];
+  Out.append( Text, static_cast<size_t>( rDebugFormat::formatPointer( Text, vptr ) ) );
+}
+
+
+void rDebugArgs::appendPoint( std::string& Out, int x, int y )
+{
+  char Text[2*rDebugFormat::MaxChars];
+  int len = 0;
+  Text[len++] = '@';
+  Text[len++] = '(';
+  len += rDebugFormat::formatSigned( Text+len, x );
+  Text[len++] = ',';
+  len += rDebugFormat::formatSigned( Text+len, y );
+  Text[len++] = ')';
+  Out.append( Text, static_cast<size_t>(len) );
+}
+
+
+void rDebugArgs::appendSize( std::string& Out, int w, int h )
+{
+  char Text[2*rDebugFormat::MaxChars];
+  int len = 0;
+  Text[len++] = '@';
+  Text[len++] = '(';
+  len += rDebugFormat::formatSigned( Text+len, w );
+  Text[len++] = 'x';
+  len += rDebugFormat::formatSigned( Text+len, h );
+  Text[len++] = ')';
+  Out.append( Text, static_cast<size_t>(len) );
+}
+
+
+void rDebugArgs::appendRect( std::string& Out, int x, int y, int w, int h )
+{
+  char Text[4*rDebugFormat::MaxChars];
+  int len = 0;
+  memcpy( Text, "QRect(", 6 );
+  len += 6;
+  len += rDebugFormat::formatSigned( Text+len, x );
+  Text[len++] = ',';
+  len += rDebugFormat::formatSigned( Text+len, y );
+  Text[len++] = '/';
+  len += rDebugFormat::formatSigned( Text+len, w );
+  Text[len++] = 'x';
+  len += rDebugFormat::formatSigned( Text+len, h );
+  Text[len++] = ')';
+  Out.append( Text, static_cast<size_t>(len) );
+}
+
+
+// must stay in sync with the immediate formatting in rDebugBase::operator<<
+void rDebugArgs::render( std::string& Out ) const
+{
+  int StrIdx   = 0;
+  int BytesIdx = 0;
+
+  const char*       pos = mBlob.data();
+  const char* const end = pos + mBlob.size();
+  while( pos < end )
+  {
+    const Tag tag = static_cast<Tag>( *pos++ );
+    switch( tag )
+    {
+      case TagChar   : { char ch;       take( pos, ch );  appendChar( Out, ch ); } break;
+      case TagQChar  : { uint16_t uc;   take( pos, uc );  rDebugUtf8::appendUtf16( Out, &uc, 1 ); } break;
+      case TagBool   : { bool flg;      take( pos, flg ); Out += (flg) ? "true" : "false"; } break;
+      case TagInt    : { int64_t num;   take( pos, num ); appendInt(  Out, num, *pos++ ); } break;
+      case TagUInt   : { uint64_t num;  take( pos, num ); appendUInt( Out, num, *pos++ ); } break;
+      case TagDouble : { double dbl;    take( pos, dbl ); appendDouble( Out, dbl ); } break;
+      case TagPointer: { const void* p; take( pos, p );   appendPointer( Out, p ); } break;
+      case TagPoint  : { int x, y;      take( pos, x ); take( pos, y );
+                         appendPoint( Out, x, y ); } break;
+      case TagSize   : { int w, h;      take( pos, w ); take( pos, h );
+                         appendSize( Out, w, h ); } break;
+      case TagRect   : { int x, y, w, h;
+                         take( pos, x ); take( pos, y ); take( pos, w ); take( pos, h );
+                         appendRect( Out, x, y, w, h ); } break;
+      case TagCStr   : { int len;       take( pos, len );
+                         Out.append( pos, static_cast<size_t>(len) ); pos += len; } break;
+      case TagString : { mHeld->appendString( Out, StrIdx++ ); } break;
+      case TagBytes  : { mHeld->appendBytes( Out, BytesIdx++ ); } break;
+      case TagLiteral: { const char* str; int len; take( pos, str ); take( pos, len );
+                         Out.append( str, static_cast<size_t>(len) ); } break;
+    }
+  }
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+static std::atomic<uint32_t> LastThreadId( 0 );
+static std::atomic<uint64_t> LastSequence( 0 );
+
+struct rDebugThreadInfo
+{
+  rDebugThreadInfo() : mId(0), mName(nullptr), mNamed(false) {}
+  uint32_t    mId;
+  const char* mName;
+  bool        mNamed; // by setName() or the lookup. Else mName is nullptr ("thread-<id>") and asked again
+};
+static thread_local rDebugThreadInfo ThisThread;
+static rDebugThread::NameLookup LookupName = nullptr; // set before main() by rDebugRecordQt.cpp
+
+
+// one copy of each name ever given, intentionally leaked: lines in queues still point to them
+static const char* internName( const std::string& Name )
+{
+  static std::mutex*            pLock  = new std::mutex;
+  static std::set<std::string>* pNames = new std::set<std::string>;
+  std::lock_guard<std::mutex> Lock( *pLock );
+  return pNames->insert( Name ).first->c_str();
+}
+
+
+uint32_t rDebugThread::id()
+{
+  if( !ThisThread.mId )
+    ThisThread.mId = LastThreadId.fetch_add( 1, std::memory_order_relaxed ) + 1;
+  return ThisThread.mId;
+}
+
+
+const char* rDebugThread::name()
+{
+  if( !ThisThread.mNamed )
+  {
+    std::string Name;
+    if( LookupName )
+      LookupName( Name );
+    if( !Name.empty() )
+    { ThisThread.mName  = internName( Name );
+      ThisThread.mNamed = true;
+    }
+    else if( !LookupName )
+      ThisThread.mNamed = true; // no Qt, nobody to ask again
+  }
+  return ThisThread.mName;
+}
+
+
+void rDebugThread::setName( const char* Name )
+{
+  ThisThread.mName  = ( Name && *Name ) ? internName( Name ) : nullptr;
+  ThisThread.mNamed = true;
+}
+
+
+void rDebugThread::setNameLookup( NameLookup Lookup )
+{
+  LookupName = Lookup;
+}
+
+
+rDebugCore::Span rDebugThread::nameOf( const char* Name, uint32_t Id, char* Tmp )
+{
+  if( Name )
+    return rDebugCore::Span::of( Name );
+  memcpy( Tmp, "thread-", 7 );
+  return rDebugCore::Span( Tmp, 7 + static_cast<size_t>( rDebugFormat::formatUnsigned( Tmp + 7, Id ) ) );
+}
+
+
+uint64_t rDebugThread::nextSequence()
+{
+  return LastSequence.fetch_add( 1, std::memory_order_relaxed ) + 1;
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+rDebugRecord::rDebugRecord( const char *file, int line, const char* func, rDebugLevel::rMsgType Level, uint64_t LogId, bool WithLogId )
+  : mFileLineFunc(file,line,func)
+  , mTimeMs( rDebugCore::now() )
+  , mLevel(Level)
+  , mLogId(LogId)
+  , mWithLogId(WithLogId)
+  , mEnqueueNs(0)
+  , mMsg()
+{}
+
+
+void rDebugRecord::finish()
+{
+  if( mArgs.isEmpty() )
+    return;
+  mArgs.render( mMsg );
+  mArgs.clear();
+}
+
+
+static const size_t SpareReserve = 256;      // first capacity of a recycled buffer
+static const size_t SpareKeepMax = 0x10000;  // bigger ones go back to the heap
+static const size_t SlotKeepMax  = 0x400;    // the same for a slot of rDebug_AsyncWriter, there are many of them
+static thread_local std::string SpareMsg;
+static thread_local std::string SpareBlob;
+static thread_local std::string SpareRendered;
+
+
+static void borrowSpare( std::string& Buffer, std::string& Spare )
+{
+  Buffer.swap( Spare ); // Spare is empty then, a nested line of this thread (a sink logging) gets an own one
+  if( Buffer.capacity() < SpareReserve )
+    Buffer.reserve( SpareReserve );
+}
+
+
+static void returnSpare( std::string& Buffer, std::string& Spare )
+{
+  if( Spare.capacity() >= SpareReserve || Buffer.capacity() < SpareReserve || Buffer.capacity() > SpareKeepMax )
+    return; // we have one already, or it is not worth (or too big) to be kept
+  Buffer.clear(); // keeps the capacity
+  Buffer.swap( Spare );
+}
+
+
+static void copyReusing( std::string& To, const std::string& From )
+{
+  if( To.capacity() < SpareReserve && From.size() )
+    To.reserve( SpareReserve );
+  To.assign( From );
+}
+
+
+void rDebugRecord::borrowBuffers( bool Deferred )
+{
+  borrowSpare( mMsg, SpareMsg );
+  if( Deferred )
+    borrowSpare( mArgs.mBlob, SpareBlob );
+}
+
+
+void rDebugRecord::returnBuffers()
+{
+  returnSpare( mMsg, SpareMsg );
+  returnSpare( mArgs.mBlob, SpareBlob );
+}
+
+
+rDebugRendered::rDebugRendered()
+{
+  borrowSpare( mText, SpareRendered );
+  for( int i=0 ; i<Layouts ; ++i )
+  {
+    mBegin[i] = 0;
+    mSize[i]  = -1;
+  }
+}
+
+
+rDebugRendered::~rDebugRendered()
+{
+  returnSpare( mText, SpareRendered );
+}
+
+
+// like operator=, but the message is copied into the buffers of this record
+void rDebugRecord::assignReusing( const rDebugRecord& Other )
+{
+  mFileLineFunc = Other.mFileLineFunc;
+  mTimeMs       = Other.mTimeMs;
+  mLevel        = Other.mLevel;
+  mLogId        = Other.mLogId;
+  mWithLogId    = Other.mWithLogId;
+  mEnqueueNs    = Other.mEnqueueNs;
+  copyReusing( mMsg, Other.mMsg );
+  copyReusing( mArgs.mBlob, Other.mArgs.mBlob );
+  mArgs.assignHeld( Other.mArgs );
+  mFields = Other.mFields;
+}
+
+
+// the line is written: drop the references to the data of other threads, keep the own buffers up to SlotKeepMax
+void rDebugRecord::recycle()
+{
+  mArgs.clear();
+  mFields.clear();
+  if( mMsg.capacity() > SlotKeepMax )
+    std::string().swap( mMsg );
+  if( mArgs.mBlob.capacity() > SlotKeepMax )
+    std::string().swap( mArgs.mBlob );
+}
@@ -0,0 +1,289 @@
+#ifndef RDEBUGRECORD_H
+#define RDEBUGRECORD_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugRecord.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "rDebugLevel.h"
+#include "rDebugCodeloc.h"
+#include "rDebugCore.h"
+
+// the Qt types are adapters only, converted (or kept, see rDebugArgs) in rDebugRecordQt.cpp.
+// A line itself is plain UTF-8 bytes in a std::string, rDebugRecord.cpp does not need QtCore.
+class QString;
+class QByteArray;
+class QChar;
+class QPoint;
+class QSize;
+class QRect;
+class QDateTime;
+
+
+// -----------------------
+// structured key/value fields, attached to a single log line.
+// usage:
+//    rInfo().field( "user", UserName ).field( "ms", Elapsed ) << "request done";
+// the JSON-Lines file sink writes them as own JSON members (numbers unquoted),
+// the text sinks append them as " key=value". Key and value are UTF-8, like the message.
+// -----------------------
+class rDebugField
+{
+public:
+  rDebugField() : mNumeric(false) {}
+  rDebugField( const char* Key, const std::string& Value, bool Numeric )
+    : mKey(Key)
+    , mValue(Value)
+    , mNumeric(Numeric)
+    {}
+  std::string mKey;
+  std::string mValue;
+  bool        mNumeric;
+};
+typedef std::vector<rDebugField> rDebugFields;
+
+
+
+// -----------------------
+// operator<< arguments, captured as raw values with a type tag instead of text.
+// Used by the deferred formatting of rDebug_AsyncWriter: the logging thread only copies
+// the values, the conversion to text is done by render() in the background thread.
+// note:
+//    - render() replays the values with the same append*() helpers rDebugBase::operator<< uses,
+//      so the text is the same in both modes
+//    - QString and QByteArray are kept as implicitly shared copies (temporaries are moved in),
+//      aside of the blob, in a part made on the first of them. C strings are copied with their
+//      length, only literals (putLiteral) are kept by their address
+//    - the append*() helpers are the text conversion of both paths. They write UTF-8 straight
+//      into the message, see rDebugFormat.h for the numbers and rDebugUtf8.h for the strings.
+// -----------------------
+class rDebugArgs
+{
+  friend class rDebugRecord;
+public:
+  enum Tag { TagChar, TagQChar, TagBool, TagInt, TagUInt, TagDouble, TagPointer, TagPoint, TagSize, TagRect, TagCStr, TagString, TagBytes, TagLiteral };
+
+  rDebugArgs();
+  rDebugArgs( const rDebugArgs& Other );
+  rDebugArgs( rDebugArgs&& Other ) noexcept;
+  rDebugArgs& operator=( const rDebugArgs& Other );
+  rDebugArgs& operator=( rDebugArgs&& Other ) noexcept;
+  ~rDebugArgs();
+
+  bool isEmpty() const { return mBlob.empty(); }
+  int  bytes() const   { return static_cast<int>( mBlob.size() ); }
+  void clear();        // keeps the capacity of the blob
+
+  void putChar( char ch )                 { put( TagChar, ch ); }
+  void putQChar( QChar ch );
+  void putBool( bool flg )                { put( TagBool, flg ); }
+  void putInt( int64_t num, int base )    { put( TagInt, num ); mBlob += static_cast<char>(base); }
+  void putUInt( uint64_t num, int base )  { put( TagUInt, num ); mBlob += static_cast<char>(base); }
+  void putDouble( double dbl )            { put( TagDouble, dbl ); }
+  void putPointer( const void* vptr )     { put( TagPointer, vptr ); }
+  void putPoint( const QPoint& d );
+  void putSize( const QSize& d );
+  void putRect( const QRect& d );
+  void putCStr( const char* str, int len=-1 ); // len < 0: up to the '\0'
+  void putLiteral( const char* str, int len ) { put( TagLiteral, str ); raw( len ); } // just the address
+  void putString( const QString& str );
+  void putString( QString&& str );
+  void putBytes( const QByteArray& ba );
+  void putBytes( QByteArray&& ba );
+
+  void render( std::string& Out ) const;
+
+  static void appendChar(    std::string& Out, char ch );  // Latin-1, like QTextStream takes a char
+  static void appendQChar(   std::string& Out, QChar ch );
+  static void appendString(  std::string& Out, const QString& str );
+  static void appendString(  std::string& Out, const QChar* str, int len );
+  static void appendLatin1(  std::string& Out, const char* str, int len );
+  static void appendInt(     std::string& Out, int64_t num, int base );
+  static void appendUInt(    std::string& Out, uint64_t num, int base );
+  static void appendDouble(  std::string& Out, double dbl );
+  static void appendPointer( std::string& Out, const void* vptr );
+  static void appendPoint(   std::string& Out, const QPoint& d );
+  static void appendSize(    std::string& Out, const QSize& d );
+  static void appendRect(    std::string& Out, const QRect& d );
+  static void appendPoint(   std::string& Out, int x, int y );  // the same, without the Qt types
+  static void appendSize(    std::string& Out, int w, int h );
+  static void appendRect(    std::string& Out, int x, int y, int w, int h );
+
+  struct Held // the payload of TagString and TagBytes, in order. Qt types, so QtHeld in rDebugRecordQt.cpp
+  {
+    virtual ~Held() {}
+    virtual Held* clone() const = 0;
+    virtual void  assign( const Held& Other ) = 0;
+    virtual void  clear() = 0; // keeps the lists
+    virtual void  appendString( std::string& Out, int Index ) const = 0;
+    virtual void  appendBytes( std::string& Out, int Index ) const = 0;
+  };
+
+private:
+  template<class T> void put( Tag tag, const T& value )
+  {
+    mBlob += static_cast<char>(tag);
+    raw( value );
+  }
+  template<class T> void raw( const T& value )
+  {
+    mBlob.append( reinterpret_cast<const char*>(&value), sizeof(value) );
+  }
+  void assignHeld( const rDebugArgs& Other );
+
+  struct QtHeld;
+  QtHeld& qtHeld();             // mHeld, made on the first call
+  std::string           mBlob;  // tag + raw value, tag + raw value, ...
+  std::unique_ptr<Held> mHeld;  // made on the first QString or QByteArray, kept by clear()
+};
+
+
+
+// -----------------------
+// the identity of the calling thread, cached on its first log line, and the global line counter.
+// usage:
+//    rDebugThread::setName( "worker-3" ); // else QThread::objectName(), "main" or "thread-<id>"
+// note:
+//    - id() is a small number in order of the first line of each thread (1, 2, 3, ...), the same
+//      in all sinks, also when rDebug_AsyncWriter writes the line from its own thread
+//    - a name is taken once, a later QThread::setObjectName() needs a setName() to be seen.
+//      A thread still without one ("thread-<id>", or the main thread before QCoreApplication exists)
+//      is asked again on each line, so it gets its name as soon as it has one.
+//      The Qt names come from the NameLookup rDebugRecordQt.cpp sets, the rest is plain C++
+//    - names are interned, they live until the end of the process. So a line carries just a pointer,
+//      also into the queue of rDebug_AsyncWriter or a queued Qt signal. A thread without a name has
+//      nullptr, nameOf() makes "thread-<id>" of it where the text is needed
+//    - nextSequence() is one fetch_add, the number of lines passing the global level. A gap in a
+//      sink means a dropped line (or one filtered by the level of that sink)
+// -----------------------
+class rDebugThread
+{
+public:
+  enum { NameChars = 24 }; // the buffer of nameOf()
+  typedef void (*NameLookup)( std::string& Name ); // appends the Qt name of the calling thread, if it has one yet
+
+  static uint32_t id();
+  static const char* name(); // UTF-8, nullptr for "thread-<id>"
+  static void setName( const char* Name );    // for the calling thread, UTF-8
+  static void setName( const QString& Name );
+  static void setNameLookup( NameLookup Lookup );
+  static rDebugCore::Span nameOf( const char* Name, uint32_t Id, char* Tmp ); // Name, or "thread-<Id>" written to Tmp
+  static uint64_t nextSequence();
+};
+
+
+
+// -----------------------
+// the head of a line in the classic layout, "<time> [<Level>] <LogId> [<thread>:<tid> #<seq>], ",
+// rendered once per line for all sinks. rDebugBase::output() has one, rDebugBase::renderClassicHead() fills it.
+// usage:
+//    rDebugBase::renderClassicHead( Heads, rDebugRendered::LogIdPlain, Origin, Time, Level, LogId );
+//    rDebugCore::append( Out, Heads.part( rDebugRendered::Stem ) );
+//    rDebugCore::append( Out, Heads.part( rDebugRendered::LogIdPlain ) );
+// note:
+//    - qDebug() writes the LogId with 8 digits (or none), the file sink as it is. So the Stem "<time> [<Level>] "
+//      is shared by all of them, and each LogId layout is a part of its own, rendered on the first request
+//    - the parts are spans into one buffer: take them after the last renderClassicHead(), it may move the buffer
+//    - the buffer is lent by the calling thread for the life time of the object, so there is no malloc()
+//    - what follows the head (message, fields, code location) is written by each sink itself,
+//      and a sink with a message pattern renders its own line
+// -----------------------
+class rDebugRendered
+{
+public:
+  enum Layout { Stem, LogIdPlain, LogIdPadded, NoLogId, Layouts };
+
+  rDebugRendered();  // borrows the buffer of the calling thread
+  ~rDebugRendered(); // and gives it back
+  rDebugRendered( const rDebugRendered& ) = delete;
+  rDebugRendered& operator=( const rDebugRendered& ) = delete;
+
+  bool has( Layout Part ) const { return mSize[Part] >= 0; }
+  rDebugCore::Span part( Layout Part ) const
+  {
+    return rDebugCore::Span( mText.data() + mBegin[Part], static_cast<size_t>( mSize[Part] ) );
+  }
+  std::string& begin( Layout Part ) { mBegin[Part] = static_cast<int>( mText.size() ); return mText; } // append the part to it,
+  void end( Layout Part ) { mSize[Part] = static_cast<int>( mText.size() ) - mBegin[Part]; }          // then end() it
+
+private:
+  std::string mText;            // all parts rendered so far, one after the other
+  int         mBegin[Layouts];
+  int         mSize[Layouts];   // -1: not rendered
+};
+
+
+
+// -----------------------
+// one log line, with all what the sinks need to know.
+// rDebugBase fills it, the sinks (directly or via rDebug_AsyncWriter) consume it.
+// note:
+//    - the message is UTF-8 from the first operator<< up to the sinks, in a std::string, and the sinks
+//      take it as rDebugCore::Span. Only the Qt signal needs a QString, so text() converts it on demand,
+//      once per line and only if connected. The same for the time: msecs since epoch (see rDebugCore),
+//      time() makes a QDateTime of it.
+//    - buffers are recycled, so a line normally does not call malloc():
+//      borrowBuffers()/returnBuffers() lend the record of rDebugBase the spare buffers of its thread,
+//      assignReusing() copies a line into the buffers a slot of rDebug_AsyncWriter already has,
+//      recycle() lets such a slot forget the line without giving back its buffers,
+//      swapBuffers() trades them with the pool of the SharedQueue mode.
+//      The spare buffers of a thread are kept up to 64 KiB, those of a slot up to 1 KiB (a ring has many).
+// -----------------------
+class rDebugRecord
+{
+public:
+  rDebugRecord( const char *file, int line, const char* func, rDebugLevel::rMsgType Level, uint64_t LogId, bool WithLogId );
+
+  void finish(); // render the deferred arguments, if any, into mMsg
+  int  payloadBytes() const { return static_cast<int>( mMsg.size() ) + mArgs.bytes(); } // the variable part, for memory limits
+  void borrowBuffers( bool Deferred );
+  void returnBuffers();
+  void assignReusing( const rDebugRecord& Other );
+  void recycle();
+  void swapBuffers( std::string& Msg, std::string& Blob ) { mMsg.swap( Msg ); mArgs.mBlob.swap( Blob ); } // with the pool of rDebug_AsyncWriter
+  QString text() const;   // the Qt adapters
+  QDateTime time() const;
+  void chopTrailingSpace() { if( mMsg.size()>1 && mMsg[mMsg.size()-1] == ' ' ) mMsg.resize( mMsg.size()-1 ); }
+
+  FileLineFunc_t        mFileLineFunc; // including thread and sequence number
+  rDebugCore::TimeMs    mTimeMs;
+  rDebugLevel::rMsgType mLevel;
+  uint64_t              mLogId;
+  bool                  mWithLogId;
+  uint64_t              mEnqueueNs; // rDebugStats::now() when queued for rDebug_AsyncWriter, 0 = not timed
+  std::string           mMsg;   // UTF-8
+  rDebugArgs            mArgs;
+  rDebugFields          mFields;
+};
+
+#endif // RDEBUGRECORD_H
@@ -0,0 +1,207 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugRecordQt.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QThread>
+#include <QCoreApplication>
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QChar>
+#include <QPoint>
+#include <QSize>
+#include <QRect>
+
+#include "rDebugRecord.h"
+
+
+// the Qt adapters of rDebugRecord.cpp: what takes or gives a Qt type, and the names of QThread.
+// The core there is plain C++, it only knows rDebugArgs::Held and rDebugThread::NameLookup.
+
+
+struct rDebugArgs::QtHeld : public rDebugArgs::Held
+{
+  Held* clone() const               { return new QtHeld( *this ); }
+  void  assign( const Held& Other ) { *this = static_cast<const QtHeld&>( Other ); } // Other is a QtHeld, there is no other Held
+  void  clear()                     { mStrings.clear(); mBytes.clear(); }
+  void  appendString( std::string& Out, int Index ) const
+  {
+    rDebugArgs::appendString( Out, mStrings.at( Index ) );
+  }
+  void  appendBytes( std::string& Out, int Index ) const
+  {
+    const QByteArray& ba = mBytes.at( Index );
+    Out.append( ba.constData(), static_cast<size_t>( ba.size() ) );
+  }
+
+  QList<QString>    mStrings;  // payload of TagString, in order
+  QList<QByteArray> mBytes;    // payload of TagBytes, in order
+};
+
+
+rDebugArgs::QtHeld& rDebugArgs::qtHeld()
+{
+  if( !mHeld )
+    mHeld.reset( new QtHeld );
+  return static_cast<QtHeld&>( *mHeld );
+}
+
+
+void rDebugArgs::putQChar( QChar ch )
+{
+  put( TagQChar, ch.unicode() );
+}
+
+
+void rDebugArgs::putPoint( const QPoint& d )
+{
+  put( TagPoint, d.x() );
+  raw( d.y() );
+}
+
+
+void rDebugArgs::putSize( const QSize& d )
+{
+  put( TagSize, d.width() );
+  raw( d.height() );
+}
+
+
+void rDebugArgs::putRect( const QRect& d )
+{
+  put( TagRect, d.x() );
+  raw( d.y() );
+  raw( d.width() );
+  raw( d.height() );
+}
+
+
+void rDebugArgs::putString( const QString& str )
+{
+  mBlob += static_cast<char>(TagString);
+  qtHeld().mStrings.append( str );
+}
+
+
+// swap() instead of a shared copy: no reference counting, the temporary is left empty
+void rDebugArgs::putString( QString&& str )
+{
+  mBlob += static_cast<char>(TagString);
+  QList<QString>& Strings = qtHeld().mStrings;
+  Strings.append( QString() );
+  Strings.last().swap( str );
+}
+
+
+void rDebugArgs::putBytes( const QByteArray& ba )
+{
+  mBlob += static_cast<char>(TagBytes);
+  qtHeld().mBytes.append( ba );
+}
+
+
+void rDebugArgs::putBytes( QByteArray&& ba )
+{
+  mBlob += static_cast<char>(TagBytes);
+  QList<QByteArray>& Bytes = qtHeld().mBytes;
+  Bytes.append( QByteArray() );
+  Bytes.last().swap( ba );
+}
+
+
+void rDebugArgs::appendQChar( std::string& Out, QChar ch )
+{
+  appendString( Out, &ch, 1 );
+}
+
+
+void rDebugArgs::appendString( std::string& Out, const QString& str )
+{
+  appendString( Out, str.unicode(), str.size() );
+}
+
+
+void rDebugArgs::appendPoint( std::string& Out, const QPoint& d )
+{
+  appendPoint( Out, d.x(), d.y() );
+}
+
+
+void rDebugArgs::appendSize( std::string& Out, const QSize& d )
+{
+  appendSize( Out, d.width(), d.height() );
+}
+
+
+void rDebugArgs::appendRect( std::string& Out, const QRect& d )
+{
+  appendRect( Out, d.x(), d.y(), d.width(), d.height() );
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+// QThread::objectName(), else "main" for the thread of QCoreApplication.
+// Nothing as long as there is neither, rDebugThread::name() asks again on the next line
+static void qtThreadName( std::string& Name )
+{
+  QThread* pThread = QThread::currentThread();
+  if( pThread && !pThread->objectName().isEmpty() )
+    rDebugArgs::appendString( Name, pThread->objectName() );
+  else if( QCoreApplication::instance() && pThread == QCoreApplication::instance()->thread() )
+    Name = "main";
+}
+
+
+struct rDebugQtNameLookup
+{
+  rDebugQtNameLookup() { rDebugThread::setNameLookup( &qtThreadName ); }
+};
+static rDebugQtNameLookup RegisterQtNameLookup;
+
+
+void rDebugThread::setName( const QString& Name )
+{
+  std::string Utf8;
+  rDebugArgs::appendString( Utf8, Name );
+  setName( Utf8.c_str() );
+}
+
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+QString rDebugRecord::text() const
+{
+  return QString::fromUtf8( mMsg.data(), static_cast<int>( mMsg.size() ) );
+}
+
+
+QDateTime rDebugRecord::time() const
+{
+  return QDateTime::fromMSecsSinceEpoch( mTimeMs );
+}
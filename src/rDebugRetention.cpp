@@ -0,0 +1,303 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugRetention.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "rDebugRetention.h"
+#include "rDebugSeekIndex.h"
+
+
+// a logfile goes together with its rDebugSeekIndex, if it has one
+static bool renameLog( const QString& From, const QString& To )
+{
+  if( !QFile::rename( From, To ) )
+    return false;
+  QFile::rename( rDebugSeekIndex::indexName( From ), rDebugSeekIndex::indexName( To ) );
+  return true;
+}
+
+
+static void removeLog( const QString& Path )
+{
+  QFile::remove( Path );
+  QFile::remove( rDebugSeekIndex::indexName( Path ) );
+}
+
+
+rDebugRetention::rDebugRetention()
+  : mLastSeq(-1)
+  , mStopping(false)
+  , mRemover(this)
+{
+}
+
+
+rDebugRetention::~rDebugRetention()
+{
+  {
+    QMutexLocker Lock( &mRemoveLock );
+    mStopping = true;
+    mRemoveWanted.wakeAll();
+  }
+  mRemover.wait(); // returns at once, if it never ran
+}
+
+
+/* the part between base name and suffix:
+ *   <n>                              Numbered
+ *   yyyy-MM-dd[-<n>]                 Daily
+ *   yyyy-MM-dd_HH[-<n>]              Hourly
+ */
+static bool parseMiddle( const QString& Middle, QString& Stamp, int& Index )
+{
+  bool Ok = false;
+  Index = Middle.toInt( &Ok );
+  if( Ok )
+  { Stamp.clear();
+    return Index > 0;
+  }
+
+  const int Len = ( Middle.size() >= 13 && Middle.at(10) == QChar('_') ) ? 13 : 10;
+  if( Middle.size() < Len )
+    return false;
+  for( int i=0 ; i<Len ; ++i )
+  {
+    const QChar c = Middle.at(i);
+    const bool Separator = ( i==4 || i==7 || i==10 );
+    if( Separator ? !( c == QChar('-') || c == QChar('_') ) : !c.isDigit() )
+      return false;
+  }
+  Stamp = Middle.left( Len );
+  Index = 0;
+  if( Middle.size() == Len )
+    return true;
+  if( Middle.at(Len) != QChar('-') )
+    return false;
+  Index = Middle.mid( Len+1 ).toInt( &Ok );
+  return Ok && Index > 0;
+}
+
+
+// one read of the directory, the backups are sorted by their age then
+void rDebugRetention::scan( const QString& FileName )
+{
+  const QFileInfo fi( FileName );
+  mFileName = FileName;
+  mBase     = fi.path() + '/' + fi.completeBaseName();
+  mSuffix   = '.' + fi.suffix();
+  mBackups.clear();
+  mLastStamp.clear();
+  mLastSeq  = -1;
+
+  const QString Prefix = fi.completeBaseName() + '.';
+  const QFileInfoList Found = QDir( fi.path() ).entryInfoList( QStringList() << ( Prefix + '*' + mSuffix ), QDir::Files );
+  QList<qint64> Ages;
+  for( int i=0 ; i<Found.size() ; ++i )
+  {
+    const QString Name   = Found.at(i).fileName();
+    const QString Middle = Name.mid( Prefix.size(), Name.size() - Prefix.size() - mSuffix.size() );
+    Backup Old;
+    if( Middle.isEmpty() || !parseMiddle( Middle, Old.mStamp, Old.mIndex ) )
+      continue; // not one of ours
+    Old.mPath = nameOf( Middle );
+    Old.mSize = Found.at(i).size();
+
+    const qint64 Age = Found.at(i).lastModified().toMSecsSinceEpoch();
+    int Pos = Ages.size();
+    while( Pos > 0 && Ages.at(Pos-1) > Age )
+      --Pos;
+    Ages.insert( Pos, Age );
+    mBackups.insert( Pos, Old );
+  }
+}
+
+
+QString rDebugRetention::nameOf( const QString& Middle ) const
+{
+  return mBase + '.' + Middle + mSuffix;
+}
+
+
+qint64 rDebugRetention::backupBytes() const
+{
+  qint64 Bytes = 0;
+  for( int i=0 ; i<mBackups.size() ; ++i )
+    Bytes += mBackups.at(i).mSize;
+  return Bytes;
+}
+
+
+void rDebugRetention::rotate( Rotation Mode, int MaxBackups, const QString& Stamp, qint64 Size )
+{
+  if( Mode == Numbered || Stamp.isEmpty() )
+    rotateNumbered( MaxBackups, Size );
+  else
+    rotateStamped( Stamp, Size );
+}
+
+
+// app.log -> app.1.log, app.1.log -> app.2.log ...
+void rDebugRetention::rotateNumbered( int MaxBackups, qint64 Size )
+{
+  const int Keep = qMax( MaxBackups, 1 );
+  int Highest = 0;
+  for( int i=0 ; i<mBackups.size() ; )
+  {
+    const Backup& Old = mBackups.at(i);
+    if( Old.mStamp.isEmpty() && Old.mIndex >= Keep )
+    { removeLog( Old.mPath ); // would be pushed out, and its name is needed right now
+      mBackups.removeAt( i );
+      continue;
+    }
+    if( Old.mStamp.isEmpty() )
+      Highest = qMax( Highest, Old.mIndex );
+    ++i;
+  }
+
+  for( int Index=Highest ; Index>=1 ; --Index ) // the oldest first, so the new name is always free
+  {
+    for( int i=0 ; i<mBackups.size() ; ++i )
+    {
+      Backup& Old = mBackups[i];
+      if( !Old.mStamp.isEmpty() || Old.mIndex != Index )
+        continue;
+      const QString Free = nameOf( QString::number( Index+1 ) );
+      renameLog( Old.mPath, Free );
+      Old.mPath  = Free;
+      Old.mIndex = Index+1;
+      break;
+    }
+  }
+
+  Backup Newest;
+  Newest.mPath  = nameOf( "1" );
+  Newest.mSize  = Size;
+  Newest.mIndex = 1;
+  if( renameLog( mFileName, Newest.mPath ) )
+    mBackups.append( Newest );
+}
+
+
+// app.log -> app.2026-10-18.log, or app.2026-10-18-<n>.log if rotated by size within the period
+void rDebugRetention::rotateStamped( const QString& Stamp, qint64 Size )
+{
+  if( Stamp != mLastStamp )
+  {
+    mLastStamp = Stamp;
+    mLastSeq   = -1;
+    for( int i=0 ; i<mBackups.size() ; ++i )
+      if( mBackups.at(i).mStamp == Stamp )
+        mLastSeq = qMax( mLastSeq, mBackups.at(i).mIndex );
+  }
+
+  for( int Tries=0 ; Tries<100 ; ++Tries ) // only a name taken behind our back costs another try
+  {
+    ++mLastSeq;
+    Backup Newest;
+    Newest.mStamp = Stamp;
+    Newest.mIndex = mLastSeq;
+    Newest.mSize  = Size;
+    Newest.mPath  = nameOf( mLastSeq ? Stamp + '-' + QString::number( mLastSeq ) : Stamp );
+    if( renameLog( mFileName, Newest.mPath ) )
+    { mBackups.append( Newest );
+      return;
+    }
+    if( !QFile::exists( mFileName ) )
+      return;
+  }
+}
+
+
+void rDebugRetention::enforce( qint64 CurrentSize, qint64 Budget, int MaxCount )
+{
+  qint64 Total = CurrentSize + backupBytes();
+  while( !mBackups.isEmpty()
+      && ( ( Budget > 0 && Total > Budget ) || ( MaxCount > 0 && mBackups.size() > MaxCount ) ) )
+  {
+    const Backup Oldest = mBackups.takeFirst();
+    Total -= Oldest.mSize;
+    remove( Oldest );
+  }
+}
+
+
+void rDebugRetention::remove( const Backup& Old )
+{
+  if( Old.mStamp.isEmpty() )
+  { removeLog( Old.mPath );
+    return;
+  }
+  QMutexLocker Lock( &mRemoveLock );
+  mToRemove.append( Old.mPath );
+  if( !mRemover.isRunning() )
+    mRemover.start();
+  mRemoveWanted.wakeOne();
+}
+
+
+void rDebugRetention::runRemover()
+{
+  QMutexLocker Lock( &mRemoveLock );
+  for(;;)
+  {
+    while( mToRemove.isEmpty() && !mStopping )
+      mRemoveWanted.wait( &mRemoveLock );
+    if( mToRemove.isEmpty() )
+      return;
+    const QString Path = mToRemove.takeFirst();
+    Lock.unlock();
+    removeLog( Path );
+    Lock.relock();
+  }
+}
+
+
+QString rDebugRetention::stamp( Rotation Mode, const QDateTime& Time )
+{
+  switch( Mode )
+  {
+    case Daily : return Time.toString( "yyyy-MM-dd" );
+    case Hourly: return Time.toString( "yyyy-MM-dd_HH" );
+    default    : return QString();
+  }
+}
+
+
+// local time, as the names are
+QDateTime rDebugRetention::periodEnd( Rotation Mode, const QDateTime& Time )
+{
+  switch( Mode )
+  {
+    case Daily : return QDateTime( Time.date().addDays( 1 ), QTime( 0, 0 ) );
+    case Hourly: return QDateTime( Time.date(), QTime( Time.time().hour(), 0 ) ).addSecs( 3600 );
+    default    : return QDateTime();
+  }
+}
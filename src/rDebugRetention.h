@@ -0,0 +1,124 @@
+#ifndef RDEBUGRETENTION_H
+#define RDEBUGRETENTION_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugRetention.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QDateTime>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+
+
+// -----------------------
+// the rotated files of rDebug_Filewriter: their names, the one scan of the directory and the retention.
+// usage:
+//    rDebugRetention Backups;
+//    Backups.scan( "/var/log/app.log" );        // once, finds app.<n>.log and app.<date>.log
+//    ...                                        // app.log closed
+//    Backups.rotate( rDebugRetention::Daily, 0, "2026-10-18", Size ); // app.log is app.2026-10-18.log now
+//    Backups.enforce( CurrentSize, 0x40000000, 0 );                  // the oldest ones over 1 GiB go
+// note:
+//    - Numbered: app.1.log is the newest, app.<MaxBackups>.log the oldest. Each rotation renames all of them,
+//      the classic scheme of rDebug_Filewriter.
+//    - Daily, Hourly: the closed file is named after the period its lines belong to, app.2026-10-18.log or
+//      app.2026-10-18_14.log. Rotated by size within a period, it becomes app.2026-10-18-1.log, -2 and so on.
+//      A file is renamed once, no chain of renames.
+//    - the directory is read once by scan(), after that the list is kept by rotate() and enforce().
+//      No file is probed per rotation.
+//    - enforce() removes the oldest backups, until they fit together with the current file into Budget
+//      bytes (and, if MaxCount > 0, their number into MaxCount). The current file is never removed.
+//      Timestamped backups are removed by a background thread, so the logging thread does not wait for
+//      the file system. Numbered ones right away, as their names are used again by the next rotation.
+//    - the rDebugSeekIndex of a file ("app.log.idx") is renamed and removed together with it
+//    - not thread-safe, rDebug_Filewriter calls it with its mutex held
+// -----------------------
+class rDebugRetention
+{
+public:
+  enum Rotation { Numbered, Daily, Hourly };
+
+  rDebugRetention();
+  ~rDebugRetention(); // after the removals queued
+
+  void scan( const QString& FileName );
+  void rotate( Rotation Mode, int MaxBackups, const QString& Stamp, qint64 Size ); // the file is closed
+  void enforce( qint64 CurrentSize, qint64 Budget, int MaxCount );
+  int backups() const { return mBackups.size(); }
+  qint64 backupBytes() const;
+
+  static QString stamp( Rotation Mode, const QDateTime& Time );        // of the period Time belongs to
+  static QDateTime periodEnd( Rotation Mode, const QDateTime& Time );
+
+private:
+  rDebugRetention( const rDebugRetention& );
+  rDebugRetention& operator=( const rDebugRetention& );
+
+  struct Backup
+  {
+    QString mPath;
+    qint64  mSize;
+    QString mStamp;   // empty for Numbered
+    int     mIndex;   // Numbered: <n> of app.<n>.log, else the -<n> after the stamp (0 without)
+  };
+
+  QString nameOf( const QString& Middle ) const;
+  void rotateNumbered( int MaxBackups, qint64 Size );
+  void rotateStamped( const QString& Stamp, qint64 Size );
+  void remove( const Backup& Old );
+  void runRemover();
+
+  class Remover : public QThread
+  {
+  public:
+    explicit Remover( rDebugRetention* pOwner ) : mpOwner(pOwner) {}
+  protected:
+    virtual void run() { mpOwner->runRemover(); }
+  private:
+    rDebugRetention* mpOwner;
+  };
+
+private:
+  QString        mFileName;
+  QString        mBase;        // path and complete base name of mFileName
+  QString        mSuffix;      // with the dot
+  QList<Backup>  mBackups;     // oldest first
+  QString        mLastStamp;   // the stamp of the last rotation and its -<n>, so no name is used twice
+  int            mLastSeq;
+  QMutex         mRemoveLock;  // guards the three below
+  QWaitCondition mRemoveWanted;
+  QStringList    mToRemove;
+  bool           mStopping;
+  Remover        mRemover;     // started with the first removal
+};
+
+#endif // RDEBUGRETENTION_H
@@ -0,0 +1,170 @@
+#ifndef RDEBUGRING_H
+#define RDEBUGRING_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugRing.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <cstdint>
+#include <algorithm>    // std::min
+#include <atomic>
+#include <new>          // placement new
+#include <type_traits>  // std::aligned_storage
+
+
+// -----------------------
+// bounded single producer / single consumer ring, lock free.
+// One thread push()es, one other thread front()/pop()s, nobody else.
+// usage:
+//    rDebugRing<rDebugRecord> Ring( 1024, Empty ); // producer:  if( !Ring.push( Record ) ) ... full
+//                                                 // consumer:  while( rDebugRecord* p = Ring.front() ) { use(*p); Ring.pop(); }
+// note:
+//    - the capacity is rounded up to a power of 2, the positions are free running 32 bit counters
+//    - head and tail are on own cache lines, and each side caches the position of the other one,
+//      so a push/pop normally touches no cache line written by the other thread
+//    - all slots are copies of Init for the whole life of the ring, push() assigns, pop() does not destroy.
+//      So a slot keeps its buffers from one round to the next, back()/commit() let the producer
+//      fill a slot in place to make use of that (see rDebugRecord::assignReusing)
+//    - the slots come in chunks of 64, allocated and built by the producer when it gets there the first
+//      time. So a ring of 16384 lines, which never holds more than a few, costs a few slots only
+// -----------------------
+template<class T> class rDebugRing
+{
+public:
+  explicit rDebugRing( int Capacity, const T& Init = T() )
+    : mHead(0)
+    , mTailCache(0)
+    , mTail(0)
+    , mHeadCache(0)
+    , mMask( roundUp( Capacity ) - 1 )
+    , mChunkMask( std::min<uint32_t>( mMask, ChunkSize - 1 ) )
+    , mBuilt(0)
+    , mppChunks( new Slot*[ chunkOf( mMask ) + 1 ]() )
+    , mInit( Init )
+  {}
+
+  ~rDebugRing()
+  {
+    for( uint32_t i=0 ; i<mBuilt ; ++i )
+      slot( i )->~T();
+    for( uint32_t c=0 ; c<=chunkOf( mMask ) ; ++c )
+      delete [] mppChunks[c];
+    delete [] mppChunks;
+  }
+
+  // producer
+  bool push( const T& Item )
+  {
+    T* pSlot = back();
+    if( !pSlot )
+      return false; // full
+    *pSlot = Item;
+    commit();
+    return true;
+  }
+
+  // producer, in place: the next free slot (nullptr = full), handed to the consumer by commit()
+  T* back()
+  {
+    const uint32_t Head = mHead.load( std::memory_order_relaxed );
+    if( Head - mTailCache > mMask )
+    {
+      mTailCache = mTail.load( std::memory_order_acquire );
+      if( Head - mTailCache > mMask )
+        return nullptr;
+    }
+    if( Head == mBuilt && Head <= mMask ) // the first round, the consumer sees the chunk by commit()
+    {
+      if( !( Head & mChunkMask ) )
+        mppChunks[ chunkOf( Head ) ] = new Slot[ mChunkMask + 1 ];
+      new ( slot( Head ) ) T( mInit );
+      ++mBuilt;
+    }
+    return slot( Head );
+  }
+
+  void commit()
+  {
+    mHead.store( mHead.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+  }
+
+  // consumer
+  T* front()
+  {
+    const uint32_t Tail = mTail.load( std::memory_order_relaxed );
+    if( Tail == mHeadCache )
+    {
+      mHeadCache = mHead.load( std::memory_order_acquire );
+      if( Tail == mHeadCache )
+        return nullptr; // empty
+    }
+    return slot( Tail );
+  }
+
+  void pop() // the slot is free for the producer again, its object stays
+  {
+    mTail.store( mTail.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+  }
+
+  // any thread, a snapshot only
+  uint32_t head() const { return mHead.load( std::memory_order_acquire ); } // number of pushes so far
+  uint32_t tail() const { return mTail.load( std::memory_order_acquire ); } // number of pops so far
+  int size() const     { return static_cast<int>( head() - tail() ); }
+  int capacity() const { return static_cast<int>( mMask + 1 ); }
+
+private:
+  rDebugRing( const rDebugRing& );
+  rDebugRing& operator=( const rDebugRing& );
+
+  static uint32_t roundUp( int Capacity )
+  {
+    uint32_t Size = 2;
+    while( Size < static_cast<uint32_t>( Capacity ) && Size < 0x40000000u )
+      Size <<= 1;
+    return Size;
+  }
+
+  typedef typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type Slot;
+  enum { CacheLine = 64, ChunkBits = 6, ChunkSize = 1 << ChunkBits };
+
+  uint32_t chunkOf( uint32_t Index ) const { return ( Index & mMask ) >> ChunkBits; }
+  T* slot( uint32_t Index ) const { return reinterpret_cast<T*>( &mppChunks[ chunkOf( Index ) ][ Index & mChunkMask ] ); }
+
+  std::atomic<uint32_t> mHead;        // written by the producer
+  uint32_t              mTailCache;   // producer side copy of mTail
+  char                  mPadHead[ CacheLine - sizeof(std::atomic<uint32_t>) - sizeof(uint32_t) ];
+  std::atomic<uint32_t> mTail;        // written by the consumer
+  uint32_t              mHeadCache;   // consumer side copy of mHead
+  char                  mPadTail[ CacheLine - sizeof(std::atomic<uint32_t>) - sizeof(uint32_t) ];
+  const uint32_t        mMask;
+  const uint32_t        mChunkMask;  // ChunkSize - 1, or less for a small ring
+  uint32_t              mBuilt;      // producer side: the slots constructed so far, in order
+  Slot** const          mppChunks;   // (mMask >> ChunkBits) + 1 of them, nullptr until needed
+  const T               mInit;
+};
+
+#endif // RDEBUGRING_H
@@ -0,0 +1,264 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugSeekIndex.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QFileInfo>
+#include <string.h>  // memcpy, memset
+#include <limits>
+
+#include "rDebugSeekIndex.h"
+
+
+static const char   IndexMagic[8] = { 'r', 'D', 'b', 'g', 'I', 'd', 'x', '1' };
+static const qint64 HeaderSize    = 16; // magic, entry size, block size
+
+static_assert( sizeof( rDebugSeekIndex::Entry ) == rDebugSeekIndex::EntrySize, "the entries are written as they are" );
+
+
+rDebugSeekIndex::Query::Query()
+  : mFromMs( std::numeric_limits<qint64>::min() )
+  , mToMs( std::numeric_limits<qint64>::max() )
+  , mMaxLevel( 7 ) // Debug
+  , mByLogId( false )
+  , mLogId( 0 )
+{
+}
+
+
+rDebugSeekIndex::rDebugSeekIndex()
+  : mBlockSize( DefaultBlockSize )
+{
+  memset( &mBlock, 0, sizeof(mBlock) );
+}
+
+
+rDebugSeekIndex::~rDebugSeekIndex()
+{
+  close();
+}
+
+
+/* an index of an other format starts again from here on. A torn last entry is cut off,
+ * as well as entries behind the end of the log.
+ */
+bool rDebugSeekIndex::open( const QString& LogFile, qint64 LogSize, int BlockSize )
+{
+  close();
+  mBlockSize = qMax( BlockSize, 0x1000 );
+  mIndex.setFileName( indexName( LogFile ) );
+  if( !mIndex.open( QIODevice::ReadWrite ) )
+    return false;
+
+  bool Valid = false;
+  qint64 Size = mIndex.size();
+  if( Size >= HeaderSize )
+  {
+    char Header[HeaderSize];
+    quint32 EntryBytes = 0;
+    mIndex.read( Header, HeaderSize );
+    memcpy( &EntryBytes, Header + 8, 4 );
+    Valid = ( 0 == memcmp( Header, IndexMagic, 8 ) ) && ( EntryBytes == EntrySize );
+    Size -= ( Size - HeaderSize ) % EntrySize;
+    while( Valid && Size > HeaderSize )
+    {
+      Entry Last;
+      mIndex.seek( Size - EntrySize );
+      Valid = ( mIndex.read( reinterpret_cast<char*>( &Last ), EntrySize ) == EntrySize );
+      if( Last.mEnd <= LogSize )
+        break;
+      Size -= EntrySize; // bytes the log did not get (a crash before they were written), or an other log
+    }
+  }
+  if( !Valid )
+  {
+    mIndex.resize( 0 );
+    mIndex.seek( 0 );
+    const quint32 Sizes[2] = { EntrySize, static_cast<quint32>( mBlockSize ) };
+    mIndex.write( IndexMagic, 8 );
+    mIndex.write( reinterpret_cast<const char*>( Sizes ), 8 );
+    mIndex.flush();
+  }
+  else
+  {
+    mIndex.resize( Size );
+    mIndex.seek( Size );
+  }
+  startBlock( LogSize );
+  return true;
+}
+
+
+void rDebugSeekIndex::close()
+{
+  if( !mIndex.isOpen() )
+    return;
+  if( mBlock.mLines )
+    writeBlock( mBlock.mEnd );
+  mIndex.close();
+}
+
+
+void rDebugSeekIndex::line( qint64 End, qint64 TimeMs, int Level, quint64 LogId )
+{
+  if( !mBlock.mLines )
+    mBlock.mMinMs = mBlock.mMaxMs = TimeMs;
+  else if( TimeMs < mBlock.mMinMs )
+    mBlock.mMinMs = TimeMs;
+  else if( TimeMs > mBlock.mMaxMs )
+    mBlock.mMaxMs = TimeMs;
+  ++mBlock.mLines;
+  mBlock.mLevels |= static_cast<quint8>( 1u << qBound( 0, Level, 7 ) );
+  addLogId( mBlock.mBloom, LogId );
+  mBlock.mEnd = End;
+
+  if( End - mBlock.mBegin >= mBlockSize )
+  { writeBlock( End );
+    startBlock( End );
+  }
+}
+
+
+void rDebugSeekIndex::startBlock( qint64 Begin )
+{
+  memset( &mBlock, 0, sizeof(mBlock) );
+  mBlock.mBegin = mBlock.mEnd = Begin;
+}
+
+
+// one small write per block, flushed, so a reader sees it at once
+void rDebugSeekIndex::writeBlock( qint64 End )
+{
+  mBlock.mEnd = End;
+  mIndex.write( reinterpret_cast<const char*>( &mBlock ), EntrySize );
+  mIndex.flush();
+}
+
+
+static quint64 mixLogId( quint64 LogId )
+{
+  quint64 h = LogId + 0x9E3779B97F4A7C15ull; // splitmix64
+  h = ( h ^ ( h >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+  h = ( h ^ ( h >> 27 ) ) * 0x94D049BB133111EBull;
+  return h ^ ( h >> 31 );
+}
+
+
+// 3 bits out of 256 per LogId
+void rDebugSeekIndex::addLogId( quint8* Bloom, quint64 LogId )
+{
+  const quint64 h = mixLogId( LogId );
+  for( int k=0 ; k<3 ; ++k )
+  {
+    const unsigned Bit = static_cast<unsigned>( h >> ( k * 8 ) ) & 0xFF;
+    Bloom[Bit >> 3] |= static_cast<quint8>( 1u << ( Bit & 7 ) );
+  }
+}
+
+
+bool rDebugSeekIndex::mayContain( const quint8* Bloom, quint64 LogId )
+{
+  const quint64 h = mixLogId( LogId );
+  for( int k=0 ; k<3 ; ++k )
+  {
+    const unsigned Bit = static_cast<unsigned>( h >> ( k * 8 ) ) & 0xFF;
+    if( !( Bloom[Bit >> 3] & ( 1u << ( Bit & 7 ) ) ) )
+      return false;
+  }
+  return true;
+}
+
+
+QVector<rDebugSeekIndex::Entry> rDebugSeekIndex::read( const QString& LogFile )
+{
+  QVector<Entry> Entries;
+  QFile Index( indexName( LogFile ) );
+  if( !Index.open( QIODevice::ReadOnly ) )
+    return Entries;
+  const QByteArray All = Index.readAll();
+  quint32 EntryBytes = 0;
+  if( All.size() < HeaderSize || 0 != memcmp( All.constData(), IndexMagic, 8 ) )
+    return Entries;
+  memcpy( &EntryBytes, All.constData() + 8, 4 );
+  if( EntryBytes != EntrySize )
+    return Entries;
+
+  const int Count = static_cast<int>( ( All.size() - HeaderSize ) / EntrySize );
+  if( Count <= 0 )
+    return Entries;
+  Entries.resize( Count );
+  memcpy( Entries.data(), All.constData() + HeaderSize, static_cast<size_t>( Count ) * EntrySize );
+  return Entries;
+}
+
+
+bool rDebugSeekIndex::matches( const Entry& Block, const Query& Q )
+{
+  if( Block.mMaxMs < Q.mFromMs || Block.mMinMs > Q.mToMs )
+    return false;
+  const unsigned Wanted = ( Q.mMaxLevel >= 7 ) ? 0xFFu : ( ( 2u << qMax( Q.mMaxLevel, 0 ) ) - 1 );
+  if( !( Block.mLevels & Wanted ) )
+    return false;
+  if( Q.mByLogId && !mayContain( Block.mBloom, Q.mLogId ) )
+    return false;
+  return true;
+}
+
+
+static void addRange( QVector<rDebugSeekIndex::Range>& Ranges, qint64 Begin, qint64 End )
+{
+  if( End <= Begin )
+    return;
+  if( !Ranges.isEmpty() && Ranges.last().mEnd == Begin )
+  { Ranges.last().mEnd = End;
+    return;
+  }
+  const rDebugSeekIndex::Range R = { Begin, End };
+  Ranges.append( R );
+}
+
+
+QVector<rDebugSeekIndex::Range> rDebugSeekIndex::ranges( const QString& LogFile, const Query& Q )
+{
+  QVector<Range> Ranges;
+  const qint64 LogSize = QFileInfo( LogFile ).size();
+  const QVector<Entry> Entries = read( LogFile );
+
+  qint64 Pos = 0;
+  for( int i=0 ; i<Entries.size() && Pos<LogSize ; ++i )
+  {
+    const Entry& Block = Entries.at(i);
+    if( Block.mEnd <= Pos )
+      continue;                                  // not in order, was covered already
+    addRange( Ranges, Pos, qMin( Block.mBegin, LogSize ) );  // a gap without entry
+    if( matches( Block, Q ) )
+      addRange( Ranges, qMax( Block.mBegin, Pos ), qMin( Block.mEnd, LogSize ) );
+    Pos = qMax( Pos, Block.mEnd );
+  }
+  addRange( Ranges, Pos, LogSize );              // the lines since the last entry
+  return Ranges;
+}
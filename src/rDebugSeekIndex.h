@@ -0,0 +1,121 @@
+#ifndef RDEBUGSEEKINDEX_H
+#define RDEBUGSEEKINDEX_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugSeekIndex.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+#include <QFile>
+
+
+// -----------------------
+// a sparse index beside a logfile of rDebug_Filewriter ("app.log.idx"), so a search for a time window,
+// a level or a LogId reads only the blocks, which may hold such lines, instead of the whole file.
+// usage:
+//    rLogFile.setSeekIndex( 0x10000 );                    // writer: one entry per 64 KiB of log
+//    ...
+//    rDebugSeekIndex::Query Q;                            // reader, any time later
+//    Q.mFromMs = From.toMSecsSinceEpoch();  Q.mToMs = To.toMSecsSinceEpoch();
+//    Q.mMaxLevel = rDebugLevel::rMsgType::Warning;
+//    Q.mByLogId = true;  Q.mLogId = 4711;
+//    QVector<rDebugSeekIndex::Range> Where = rDebugSeekIndex::ranges( "app.1.log", Q );
+// note:
+//    - an entry per block: byte range, the oldest and newest time stamp, a bitmap of the levels and a
+//      bloom filter of the LogIds of its lines. 72 bytes per block, in host byte order
+//    - the bloom filter has 256 bits, it fits LogIds shared by many lines (a session, a module, a request),
+//      with hundreds of different LogIds per block it says "maybe" to nearly all
+//    - parts of the logfile without an entry (no index yet, the lines since the last entry, a crash)
+//      are always part of the result of ranges(), so nothing is missed. Without an index, it is the whole file.
+//    - the time range is checked against the oldest and newest line of a block, lines written slightly out
+//      of order (several threads) are found as well
+//    - rDebugRetention renames and removes the index together with its logfile
+//    - writing is not thread-safe, rDebug_Filewriter calls it with its mutex held
+// -----------------------
+class rDebugSeekIndex
+{
+public:
+  enum { EntrySize = 72, BloomBytes = 32, DefaultBlockSize = 0x10000 };
+
+  struct Entry
+  {
+    qint64  mBegin;                // byte range of the block in the logfile
+    qint64  mEnd;
+    qint64  mMinMs;                // msecs since epoch
+    qint64  mMaxMs;
+    quint32 mLines;
+    quint8  mLevels;               // bit n: a line of level n
+    quint8  mReserved[3];
+    quint8  mBloom[BloomBytes];
+  };
+
+  struct Query
+  {
+    Query();
+    qint64  mFromMs;               // both included
+    qint64  mToMs;
+    int     mMaxLevel;             // lines of this level and more severe ones
+    bool    mByLogId;
+    quint64 mLogId;
+  };
+
+  struct Range
+  {
+    qint64  mBegin;
+    qint64  mEnd;
+  };
+
+  rDebugSeekIndex();
+  ~rDebugSeekIndex();
+
+  bool open( const QString& LogFile, qint64 LogSize, int BlockSize ); // appends to the index of LogFile
+  void close();                                                      // with the entry of the last block
+  bool isOpen() const { return mIndex.isOpen(); }
+  void line( qint64 End, qint64 TimeMs, int Level, quint64 LogId ); // a line written up to End
+
+  static QString indexName( const QString& LogFile ) { return LogFile + ".idx"; }
+  static QVector<Entry> read( const QString& LogFile );
+  static bool matches( const Entry& Block, const Query& Q );
+  static QVector<Range> ranges( const QString& LogFile, const Query& Q ); // sorted, adjacent ones merged
+  static bool mayContain( const quint8* Bloom, quint64 LogId );
+
+private:
+  rDebugSeekIndex( const rDebugSeekIndex& );
+  rDebugSeekIndex& operator=( const rDebugSeekIndex& );
+
+  void startBlock( qint64 Begin );
+  void writeBlock( qint64 End );
+  static void addLogId( quint8* Bloom, quint64 LogId );
+
+  QFile   mIndex;
+  int     mBlockSize;
+  Entry   mBlock;                  // the one being filled
+};
+
+#endif // RDEBUGSEEKINDEX_H
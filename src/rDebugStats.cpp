@@ -0,0 +1,337 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugStats.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QVector>
+#include <QMutexLocker>
+#include <new>       // placement new
+#include <string.h>  // memset, strcmp
+#include <algorithm> // std::sort
+
+#include "rDebugStats.h"
+#include "rDebug.h"
+
+
+std::atomic<bool> rDebugStats::mEnabled( true );
+
+
+/* all shards ever created, plus the ones of finished threads, waiting for a new thread.
+ * intentionally leaked: thread_local destructors of late threads may still come after static destruction.
+ */
+namespace
+{
+  struct ShardRegistry
+  {
+    QMutex         mLock;
+    QVector<void*> mAll;
+    QVector<void*> mFree;
+  };
+
+  ShardRegistry& registry()
+  {
+    static ShardRegistry* pRegistry = new ShardRegistry;
+    return *pRegistry;
+  }
+
+  const size_t CacheLine = 64;
+
+  unsigned callSiteHash( const char* File, int Line )
+  {
+    const quintptr Key = reinterpret_cast<quintptr>(File) ^ ( static_cast<quintptr>( static_cast<unsigned>(Line) ) << 16 );
+    return static_cast<unsigned>( ( Key * 0x9E3779B1u ) >> 7 ) & ( rDebugStats::CallSiteSlots - 1 );
+  }
+
+  bool moreLines( const rDebugStats::CallSite& a, const rDebugStats::CallSite& b )
+  {
+    return a.mCount > b.mCount;
+  }
+}
+
+
+class rDebugStats::ShardHolder
+{
+public:
+  ShardHolder()
+    : mpShard(nullptr)
+  {
+    ShardRegistry& Reg = registry();
+    QMutexLocker Lock( &Reg.mLock );
+    if( !Reg.mFree.isEmpty() )
+    { mpShard = static_cast<Shard*>( Reg.mFree.last() );
+      Reg.mFree.resize( Reg.mFree.size()-1 );
+      return;
+    }
+    void* Mem = qMallocAligned( sizeof(Shard), CacheLine ); // own cache line(s), no false sharing with other threads
+    if( !Mem )
+      throw std::bad_alloc();
+    mpShard = new (Mem) Shard(); // value initialized, all counters 0
+    Reg.mAll.append( mpShard );
+  }
+
+  ~ShardHolder()
+  {
+    ShardRegistry& Reg = registry();
+    QMutexLocker Lock( &Reg.mLock );
+    Reg.mFree.append( mpShard ); // keeps its counts, the next new thread continues with it
+  }
+
+  Shard* mpShard;
+};
+
+
+rDebugStats::Shard& rDebugStats::shard()
+{
+  static thread_local ShardHolder Holder;
+  return *Holder.mpShard;
+}
+
+
+// open addressing in the table of the thread, keyed by the __FILE__ pointer and the line. never removed,
+// the block of an ended thread keeps its sites for the next one.
+void rDebugStats::countCallSite( const char* File, int Line, rDebugLevel::rMsgType Level )
+{
+  if( !File )
+    File = "";
+  Shard& s = shard();
+  const unsigned Start = callSiteHash( File, Line );
+  for( unsigned Probe=0 ; Probe<16 ; ++Probe )
+  {
+    CallSiteCount& Slot = s.mCallSites[ (Start + Probe) & (CallSiteSlots - 1) ];
+    const char* Key = Slot.mFile.load( std::memory_order_relaxed );
+    if( !Key )
+    {
+      Slot.mLine  = Line;
+      Slot.mLevel = Level;
+      Slot.mFile.store( File, std::memory_order_release );
+      add( Slot.mCount );
+      return;
+    }
+    if( Key == File && Slot.mLine == Line )
+    {
+      add( Slot.mCount );
+      return;
+    }
+  }
+  add( s.mCallSitesOther );
+}
+
+
+QVector<rDebugStats::CallSite> rDebugStats::topCallSites( int Count )
+{
+  QVector<CallSite> Sites;
+  ShardRegistry& Reg = registry();
+  QMutexLocker Lock( &Reg.mLock );
+  for( int n=0 ; n<Reg.mAll.size() ; ++n )
+  {
+    const Shard& s = *static_cast<const Shard*>( Reg.mAll.at(n) );
+    for( int i=0 ; i<CallSiteSlots ; ++i )
+    {
+      const CallSiteCount& Slot = s.mCallSites[i];
+      const char* File = Slot.mFile.load( std::memory_order_acquire );
+      if( !File )
+        continue;
+      CallSite Site;
+      Site.mFile  = File;
+      Site.mLine  = Slot.mLine;
+      Site.mLevel = static_cast<rDebugLevel::rMsgType>( Slot.mLevel );
+      Site.mCount = Slot.mCount.load( std::memory_order_relaxed );
+
+      // the same site from other threads, or the same __FILE__ at different addresses in different
+      // translation units (inline code in headers)
+      bool merged = false;
+      for( int k=0 ; k<Sites.size() && !merged ; ++k )
+      {
+        if( Sites[k].mLine == Site.mLine && ( Sites[k].mFile == Site.mFile || !strcmp( Sites[k].mFile, Site.mFile ) ) )
+        { Sites[k].mCount += Site.mCount;
+          merged = true;
+        }
+      }
+      if( !merged )
+        Sites.append( Site );
+    }
+  }
+  Lock.unlock();
+  std::sort( Sites.begin(), Sites.end(), moreLines );
+  if( Count >= 0 && Sites.size() > Count )
+    Sites.resize( Count );
+  return Sites;
+}
+
+
+rDebugStats::Snapshot rDebugStats::snapshot()
+{
+  Snapshot Stats;
+  memset( &Stats, 0, sizeof(Stats) );
+
+  {
+    ShardRegistry& Reg = registry();
+    QMutexLocker Lock( &Reg.mLock );
+    for( int i=0 ; i<Reg.mAll.size() ; ++i )
+    {
+      const Shard& s = *static_cast<const Shard*>( Reg.mAll.at(i) );
+      for( int l=0 ; l<Levels ; ++l )
+      { Stats.mEmitted[l]  += s.mEmitted[l].load( std::memory_order_relaxed );
+        Stats.mFiltered[l] += s.mFiltered[l].load( std::memory_order_relaxed );
+      }
+      for( int k=0 ; k<SinkCount ; ++k )
+      { Stats.mSinkLines[k]    += s.mSinkLines[k].load( std::memory_order_relaxed );
+        Stats.mSinkFiltered[k] += s.mSinkFiltered[k].load( std::memory_order_relaxed );
+      }
+      Stats.mBytesWritten += s.mBytesWritten.load( std::memory_order_relaxed );
+      Stats.mFlushes      += s.mFlushes.load( std::memory_order_relaxed );
+      Stats.mRotations    += s.mRotations.load( std::memory_order_relaxed );
+      Stats.mSyncs        += s.mSyncs.load( std::memory_order_relaxed );
+      Stats.mCallSitesOther += s.mCallSitesOther.load( std::memory_order_relaxed );
+      for( int h=0 ; h<HistCount ; ++h )
+      { for( int b=0 ; b<Buckets ; ++b )
+          Stats.mHist[h][b] += s.mHist[h][b].load( std::memory_order_relaxed );
+        Stats.mHistSumNs[h] += s.mHistSumNs[h].load( std::memory_order_relaxed );
+      }
+    }
+  }
+
+  rDebug_SinkSlot<rDebug_AsyncWriter>::Use pAsync( rDebug_AsyncWriter::pAsyncWriter );
+  if( pAsync )
+  {
+    Stats.mQueueDepth    = pAsync->queued();
+    Stats.mQueueDepthMax = pAsync->queuedMax();
+    Stats.mDropped       = pAsync->dropped();
+  }
+  return Stats;
+}
+
+
+quint64 rDebugStats::Snapshot::emitted() const
+{
+  quint64 Sum = 0;
+  for( int l=0 ; l<Levels ; ++l )
+    Sum += mEmitted[l];
+  return Sum;
+}
+
+
+quint64 rDebugStats::Snapshot::filtered() const
+{
+  quint64 Sum = 0;
+  for( int l=0 ; l<Levels ; ++l )
+    Sum += mFiltered[l];
+  return Sum;
+}
+
+
+quint64 rDebugStats::Snapshot::count( Histogram Hist ) const
+{
+  quint64 Sum = 0;
+  for( int b=0 ; b<Buckets ; ++b )
+    Sum += mHist[Hist][b];
+  return Sum;
+}
+
+
+quint64 rDebugStats::Snapshot::percentile( Histogram Hist, double Fraction ) const
+{
+  const quint64 Total = count( Hist );
+  if( !Total )
+    return 0;
+  quint64 Target = static_cast<quint64>( Fraction * static_cast<double>(Total) + 0.5 );
+  if( Target < 1 )     Target = 1;
+  if( Target > Total ) Target = Total;
+
+  quint64 Seen = 0;
+  for( int b=0 ; b<Buckets ; ++b )
+  {
+    Seen += mHist[Hist][b];
+    if( Seen >= Target )
+      return Q_UINT64_C(1) << (b+1);
+  }
+  return Q_UINT64_C(1) << Buckets;
+}
+
+
+QString rDebugStats::toText( const Snapshot& Stats )
+{
+  QString Text = QString( "rDebug stats: lines %1, filtered %2 (" ).arg( Stats.emitted() ).arg( Stats.filtered() );
+  for( int l=0 ; l<Levels ; ++l )
+    Text += QString( "%1%2 %3" ).arg( (l) ? ", " : "" ).arg( rDebugBase::getLevelKey( static_cast<rDebugLevel::rMsgType>(l) ) ).arg( Stats.mEmitted[l] );
+  Text += QString( "), signal %1/%2, file %3/%4, qdebug %5/%6 (written/filtered)" )
+            .arg( Stats.mSinkLines[SinkSignal] ).arg( Stats.mSinkFiltered[SinkSignal] )
+            .arg( Stats.mSinkLines[SinkFile]   ).arg( Stats.mSinkFiltered[SinkFile]   )
+            .arg( Stats.mSinkLines[SinkQDebug] ).arg( Stats.mSinkFiltered[SinkQDebug] );
+  Text += QString( ", file %1 bytes %2 flushes %3 syncs %4 rotations" ).arg( Stats.mBytesWritten ).arg( Stats.mFlushes ).arg( Stats.mSyncs ).arg( Stats.mRotations );
+  Text += QString( ", queue %1 (max %2) dropped %3" ).arg( Stats.mQueueDepth ).arg( Stats.mQueueDepthMax ).arg( Stats.mDropped );
+  if( Stats.count( HistEnqueueToWrite ) )
+    Text += QString( ", enqueue->write p50 %1ns p99 %2ns" ).arg( Stats.percentile( HistEnqueueToWrite, 0.50 ) ).arg( Stats.percentile( HistEnqueueToWrite, 0.99 ) );
+  if( Stats.count( HistFileWrite ) )
+    Text += QString( ", file write p50 %1ns p99 %2ns" ).arg( Stats.percentile( HistFileWrite, 0.50 ) ).arg( Stats.percentile( HistFileWrite, 0.99 ) );
+  return Text;
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+rDebug_StatsDumper::rDebug_StatsDumper( int IntervalMs, rDebugLevel::rMsgType Level )
+  : mIntervalMs( qMax( IntervalMs, 100 ) )
+  , mLevel(Level)
+  , mStopping(false)
+  , mWorker(this)
+{
+  mWorker.start();
+}
+
+
+rDebug_StatsDumper::~rDebug_StatsDumper()
+{
+  {
+    QMutexLocker Lock( &mLock );
+    mStopping = true;
+    mWakeup.wakeAll();
+  }
+  mWorker.wait();
+}
+
+
+void rDebug_StatsDumper::dump()
+{
+  const QString Text( rDebugStats::toText( rDebugStats::snapshot() ) );
+  rDebugBase( __FILE__, __LINE__, __PRETTY_FUNCTION__, mLevel ) << Text;
+}
+
+
+void rDebug_StatsDumper::run()
+{
+  QMutexLocker Lock( &mLock );
+  while( !mStopping )
+  {
+    mWakeup.wait( &mLock, static_cast<unsigned long>( mIntervalMs ) );
+    if( mStopping )
+      break;
+    Lock.unlock();
+    dump();
+    Lock.relock();
+  }
+}
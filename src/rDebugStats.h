@@ -0,0 +1,250 @@
+#ifndef RDEBUGSTATS_H
+#define RDEBUGSTATS_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugStats.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+
+#include "rDebugLevel.h"
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+
+// -----------------------
+// counters of the logging pipeline itself: what is logged, what is filtered, what the sinks
+// are doing, and how long it takes. So it can be seen, when logging becomes the bottleneck.
+// usage:
+//    rDebugStats::Snapshot Now = rDebugStats::snapshot();
+//    quint64 Warnings = Now.mEmitted[ rDebugLevel::rMsgType::Warning ];
+//    quint64 p99ns    = Now.percentile( rDebugStats::HistEnqueueToWrite, 0.99 );
+//    ...
+//    rDebug_StatsDumper rLogStats( 60000 ); // a line "rDebug stats: ..." every minute
+// note:
+//    - each thread counts into its own cache line aligned block (no lock, no shared cache line),
+//      snapshot() sums up all blocks. The block of a finished thread is taken over by the next new
+//      thread, so its counts are not lost and the number of blocks stays at the max. thread count.
+//    - latencies are log2 histograms in nanoseconds, bucket i counts [2^i .. 2^(i+1)) ns
+//    - queue depth and drops are read from rDebug_AsyncWriter at snapshot() time
+//    - lines passing the global level are also counted per call site (__FILE__:__LINE__), see topCallSites().
+//      in the block of the thread as well, a table of CallSiteSlots entries, more sites go to "other".
+//      topCallSites() merges the tables of all blocks.
+//    - setEnabled(false) stops counting, then only a relaxed atomic load per line is left
+// -----------------------
+class rDebugStats
+{
+public:
+  enum Sink      { SinkSignal, SinkFile, SinkQDebug, SinkCount };
+  enum Histogram { HistEnqueueToWrite, HistSignalWrite, HistFileWrite, HistQDebugWrite, HistCount };
+  enum { Levels = 8, Buckets = 40, CallSiteSlots = 1024 };
+
+  struct Snapshot
+  {
+    quint64 mEmitted[Levels];           // passed the global level
+    quint64 mFiltered[Levels];          // dropped by the global level
+    quint64 mSinkLines[SinkCount];      // written by the sink
+    quint64 mSinkFiltered[SinkCount];   // dropped by the MaxLevel of the sink
+    quint64 mBytesWritten;              // file sink
+    quint64 mFlushes;                   // file sink
+    quint64 mRotations;                 // file sink
+    quint64 mSyncs;                     // file sink, fdatasync() calls (one per group commit)
+    quint64 mQueueDepth;                // rDebug_AsyncWriter, now
+    quint64 mQueueDepthMax;             // rDebug_AsyncWriter, max. since its start
+    quint64 mDropped;                   // rDebug_AsyncWriter, OverflowPolicy Drop
+    quint64 mHist[HistCount][Buckets];
+    quint64 mHistSumNs[HistCount];
+    quint64 mCallSitesOther;            // lines of call sites, which did not fit into the table of their thread
+
+    quint64 emitted() const;
+    quint64 filtered() const;
+    quint64 count( Histogram Hist ) const;
+    quint64 percentile( Histogram Hist, double Fraction ) const; // upper bound of the bucket, in ns
+  };
+
+  struct CallSite
+  {
+    const char*           mFile;
+    int                   mLine;
+    rDebugLevel::rMsgType mLevel;
+    quint64               mCount;
+  };
+
+  static Snapshot snapshot();
+  static QVector<CallSite> topCallSites( int Count ); // most lines first
+  static QString  toText( const Snapshot& Stats ); // one line, as used by rDebug_StatsDumper
+
+  static void setEnabled( bool enable ) { mEnabled.store( enable, std::memory_order_relaxed ); }
+  static bool enabled()                 { return mEnabled.load( std::memory_order_relaxed ); }
+
+  static quint64 now() // monotonic ns
+  {
+    return static_cast<quint64>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+  }
+
+  // -- recording, called by the pipeline
+  static void countLine( rDebugLevel::rMsgType Level, bool Filtered )
+  {
+    if( !enabled() ) return;
+    Shard& s = shard();
+    add( Filtered ? s.mFiltered[ levelIndex(Level) ] : s.mEmitted[ levelIndex(Level) ] );
+  }
+  static void countCallSite( const char* File, int Line, rDebugLevel::rMsgType Level ); // enabled() is checked by the caller
+  static void countSink( Sink Which, bool Filtered )
+  {
+    if( !enabled() ) return;
+    Shard& s = shard();
+    add( Filtered ? s.mSinkFiltered[Which] : s.mSinkLines[Which] );
+  }
+  static void countFileWrite( quint64 Bytes, bool Flushed )
+  {
+    if( !enabled() ) return;
+    Shard& s = shard();
+    add( s.mBytesWritten, Bytes );
+    if( Flushed )
+      add( s.mFlushes );
+  }
+  static void countRotation()
+  {
+    if( !enabled() ) return;
+    add( shard().mRotations );
+  }
+  static void countSync()
+  {
+    if( !enabled() ) return;
+    add( shard().mSyncs );
+  }
+  static void countLatency( Histogram Hist, quint64 StartNs )
+  {
+    if( !enabled() || !StartNs ) return;
+    const quint64 Now = now();
+    const quint64 Ns  = (Now > StartNs) ? Now - StartNs : 0;
+    Shard& s = shard();
+    add( s.mHist[Hist][ bucket( Ns ) ] );
+    add( s.mHistSumNs[Hist], Ns );
+  }
+  static quint64 startTimer() { return enabled() ? now() : 0; } // 0 = not timed
+
+private:
+  // only the owning thread writes it. mFile is set last, so a reader, who sees it, sees mLine and mLevel too
+  struct CallSiteCount
+  {
+    std::atomic<const char*> mFile;
+    int                      mLine;
+    int                      mLevel;
+    std::atomic<quint64>     mCount;
+  };
+  struct Shard
+  {
+    std::atomic<quint64> mEmitted[Levels];
+    std::atomic<quint64> mFiltered[Levels];
+    std::atomic<quint64> mSinkLines[SinkCount];
+    std::atomic<quint64> mSinkFiltered[SinkCount];
+    std::atomic<quint64> mBytesWritten;
+    std::atomic<quint64> mFlushes;
+    std::atomic<quint64> mRotations;
+    std::atomic<quint64> mSyncs;
+    std::atomic<quint64> mHist[HistCount][Buckets];
+    std::atomic<quint64> mHistSumNs[HistCount];
+    CallSiteCount        mCallSites[CallSiteSlots];
+    std::atomic<quint64> mCallSitesOther;
+  };
+  class ShardHolder;
+
+  // only the owning thread writes a shard, so no locked add is needed
+  static void add( std::atomic<quint64>& Counter, quint64 Delta=1 )
+  {
+    Counter.store( Counter.load( std::memory_order_relaxed ) + Delta, std::memory_order_relaxed );
+  }
+  static int levelIndex( rDebugLevel::rMsgType Level )
+  {
+    return ( Level < rDebugLevel::rMsgType::Emergency || Level > rDebugLevel::rMsgType::Debug ) ? rDebugLevel::rMsgType::Debug : Level;
+  }
+  static int bucket( quint64 Ns )
+  {
+    if( !Ns )
+      return 0;
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanReverse64( &idx, Ns );
+    const int Log2 = static_cast<int>(idx);
+#else
+    const int Log2 = 63 - __builtin_clzll( Ns );
+#endif
+    return ( Log2 < Buckets ) ? Log2 : Buckets-1;
+  }
+  static Shard& shard();
+
+  static std::atomic<bool> mEnabled;
+};
+
+
+
+// -----------------------
+// writes rDebugStats::toText() periodically as a log line, through all sinks
+// usage:
+//    rDebug_StatsDumper rLogStats( 60000, rDebugLevel::rMsgType::Informational );
+// -----------------------
+class rDebug_StatsDumper
+{
+public:
+  explicit rDebug_StatsDumper( int IntervalMs=60000, rDebugLevel::rMsgType Level=rDebugLevel::rMsgType::Informational );
+  virtual ~rDebug_StatsDumper();
+  void dump(); // now, additionally
+
+private:
+  void run();
+
+  class Worker : public QThread
+  {
+  public:
+    explicit Worker( rDebug_StatsDumper* pOwner ) : mpOwner(pOwner) {}
+  protected:
+    virtual void run() { mpOwner->run(); }
+  private:
+    rDebug_StatsDumper* mpOwner;
+  };
+
+private:
+  const int                   mIntervalMs;
+  const rDebugLevel::rMsgType mLevel;
+  QMutex                      mLock;
+  QWaitCondition              mWakeup;
+  bool                        mStopping;
+  Worker                      mWorker;
+};
+
+#endif // RDEBUGSTATS_H
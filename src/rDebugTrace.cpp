@@ -0,0 +1,178 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebugTrace.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutexLocker>
+#include <atomic>
+
+#include "rDebugTrace.h"
+#include "rDebugJson.h"
+
+
+thread_local int rDebugTraceScope::mDepthThisThread = 0;
+
+
+void rDebugTraceScope::end()
+{
+  const quint64 EndNs = rDebugStats::now();
+  --mDepthThisThread;
+
+  if( mTrace )
+  {
+    rDebug_SinkSlot<rDebug_TraceRecorder>::Use pRecorder( rDebug_TraceRecorder::pTraceRecorder );
+    if( pRecorder )
+    {
+      const rDebug_TraceRecorder::Span Done = { mName, mLocation.mFile, mLocation.mLine, mLocation.mFunc, rDebugThread::id(), mDepth, mBeginNs, EndNs };
+      char Tmp[rDebugThread::NameChars];
+      pRecorder->add( Done, rDebugThread::nameOf( rDebugThread::name(), Done.mThreadId, Tmp ) );
+    }
+  }
+
+  if( mLog )
+  {
+    rDebugBase( mLocation.mFile, mLocation.mLine, mLocation.mFunc, mLevel ).field( "duration_ns", static_cast<quint64>( EndNs - mBeginNs ) )
+                                                                           .field( "depth", mDepth ) << "timed" << mName;
+  }
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+rDebug_SinkSlot<rDebug_TraceRecorder> rDebug_TraceRecorder::pTraceRecorder;
+
+
+rDebug_TraceRecorder::rDebug_TraceRecorder( const QString& FileName, int MaxSpans )
+  : mFileName(FileName)
+  , mMaxSpans( qMax( MaxSpans, 16 ) )
+  , mOriginNs( rDebugStats::now() )
+  , mLost(0)
+{
+  mSpans.reserve( qMin( mMaxSpans, 0x10000 ) );
+  rDebug_TraceRecorder::pTraceRecorder.set( this );
+}
+
+
+rDebug_TraceRecorder::~rDebug_TraceRecorder()
+{
+  rDebug_TraceRecorder::pTraceRecorder.reset( this ); // first, so no other thread is adding anymore
+  write();
+}
+
+
+void rDebug_TraceRecorder::add( const Span& Done, rDebugCore::Span ThreadName )
+{
+  QMutexLocker Lock( &mLock );
+  if( !mThreadNames.contains( Done.mThreadId ) )
+    mThreadNames.insert( Done.mThreadId, QByteArray( ThreadName.data(), static_cast<int>( ThreadName.size() ) ) );
+  if( mSpans.size() >= mMaxSpans )
+  { ++mLost;
+    return;
+  }
+  mSpans.append( Done );
+}
+
+
+// ts and dur are in us for the trace viewers, with ns resolution
+static void appendMicroseconds( QByteArray& Out, quint64 Ns )
+{
+  Out += QByteArray::number( Ns / 1000 );
+  Out += '.';
+  const unsigned Frac = static_cast<unsigned>( Ns % 1000 );
+  Out += static_cast<char>( '0' + Frac / 100 );
+  Out += static_cast<char>( '0' + Frac / 10 % 10 );
+  Out += static_cast<char>( '0' + Frac % 10 );
+}
+
+
+bool rDebug_TraceRecorder::write()
+{
+  QVector<Span>              Spans;
+  QHash<quint32, QByteArray> ThreadNames;
+  quint64                    Lost;
+  {
+    QMutexLocker Lock( &mLock );
+    Spans       = mSpans;
+    ThreadNames = mThreadNames;
+    Lost        = mLost;
+  }
+
+  const QByteArray Pid( QByteArray::number( static_cast<qint64>( QCoreApplication::applicationPid() ) ) );
+  QByteArray Json;
+  Json.reserve( Spans.size() * 200 + 128 );
+  Json += "{\"traceEvents\":[\n";
+  bool First = true;
+  for( QHash<quint32, QByteArray>::const_iterator it = ThreadNames.constBegin() ; it != ThreadNames.constEnd() ; ++it )
+  {
+    if( !First )
+      Json += ",\n";
+    First = false;
+    Json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":";
+    Json += Pid;
+    Json += ",\"tid\":";
+    Json += QByteArray::number( it.key() );
+    Json += ",\"args\":{\"name\":";
+    rDebugJson::appendString( Json, it.value().constData(), static_cast<size_t>( it.value().size() ) );
+    Json += "}}";
+  }
+  for( int i=0 ; i<Spans.size() ; ++i )
+  {
+    const Span& s = Spans.at(i);
+    if( !First )
+      Json += ",\n";
+    First = false;
+    Json += "{\"name\":";
+    rDebugJson::appendString( Json, s.mName, s.mName ? qstrlen( s.mName ) : 0 );
+    Json += ",\"cat\":\"rDebug\",\"ph\":\"X\",\"ts\":";
+    appendMicroseconds( Json, ( s.mBeginNs > mOriginNs ) ? s.mBeginNs - mOriginNs : 0 );
+    Json += ",\"dur\":";
+    appendMicroseconds( Json, s.mEndNs - s.mBeginNs );
+    Json += ",\"pid\":";
+    Json += Pid;
+    Json += ",\"tid\":";
+    Json += QByteArray::number( s.mThreadId );
+    Json += ",\"args\":{\"file\":";
+    rDebugJson::appendString( Json, s.mFile, s.mFile ? qstrlen( s.mFile ) : 0 );
+    Json += ",\"line\":";
+    Json += QByteArray::number( s.mLine );
+    Json += ",\"func\":";
+    rDebugJson::appendString( Json, s.mFunc, s.mFunc ? qstrlen( s.mFunc ) : 0 );
+    Json += ",\"depth\":";
+    Json += QByteArray::number( s.mDepth );
+    Json += "}}";
+  }
+  Json += "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"lost_spans\":";
+  Json += QByteArray::number( Lost );
+  Json += "}}\n";
+
+  QFile Out( mFileName );
+  if( !Out.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    return false;
+  return Out.write( Json ) == Json.size();
+}
@@ -0,0 +1,169 @@
+#ifndef RDEBUGTRACE_H
+#define RDEBUGTRACE_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugTrace.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+
+#include "rDebugLevel.h"
+#include "rDebugCodeloc.h"
+#include "rDebugStats.h"
+#include "rDebug.h"
+
+
+// -----------------------
+// scoped timing and tracing, RAII: the span begins at the declaration and ends with the scope.
+// usage:
+//    void Job::load()
+//    {
+//      rTimed( rDebugLevel::rMsgType::Debug );   // at the end a Debug line "timed void Job::load() duration_ns=1234567 depth=0"
+//      ...
+//      { rTraceScope( "parse" );                 // a span for the trace viewer only, nested into load()
+//        ...
+//      }
+//    }
+//    ...
+//    rDebug_TraceRecorder rLogTrace( "/tmp/myapp.trace.json" );  // spans go to the file, load it into
+//                                                                // chrome://tracing or ui.perfetto.dev
+// note:
+//    - timestamps are monotonic ns (rDebugStats::now()), not the wall clock of the log lines
+//    - rTraceScope() costs one relaxed atomic load, when there is no rDebug_TraceRecorder.
+//      rTimed() costs the level check of a log line (global level, category and site rules),
+//      when its level is filtered (and there is no recorder).
+//      defining RDEBUG_NO_TRACE removes both completely.
+//    - the Name must live until the recorder is written, so give a string literal
+//    - nesting is tracked per thread, the trace viewer shows the spans of a thread as a stack,
+//      threads are the rDebugThread::id() and name(), like in the log lines
+// -----------------------
+class rDebugTraceScope
+{
+public:
+  rDebugTraceScope( const char *file, int line, const char* func, const char* Name, rDebugLevel::rMsgType Level=rDebugLevel::rMsgType::Silent );
+  ~rDebugTraceScope()
+  {
+    if( mBeginNs )
+      end();
+  }
+
+private:
+  rDebugTraceScope( const rDebugTraceScope& );
+  rDebugTraceScope& operator=( const rDebugTraceScope& );
+  void end();
+
+  static thread_local int mDepthThisThread;
+  FileLineFunc_t        mLocation;
+  const char*           mName;
+  rDebugLevel::rMsgType mLevel;    // Silent: trace only, no log line
+  bool                  mLog;
+  bool                  mTrace;
+  int                   mDepth;
+  quint64               mBeginNs;  // 0: nothing to do at the end
+};
+
+
+#if defined(RDEBUG_NO_TRACE)
+#  define rTraceScope(Name)   (void)0
+#  define rTimed(Level)       (void)0
+#else
+#  define RDEBUG_TRACE_CONCAT2(a,b) a##b
+#  define RDEBUG_TRACE_CONCAT(a,b)  RDEBUG_TRACE_CONCAT2(a,b)
+#  define rTraceScope(Name)   rDebugTraceScope RDEBUG_TRACE_CONCAT( rTraceScope_, __LINE__ )( __FILE__, __LINE__, __PRETTY_FUNCTION__, Name )
+#  define rTimed(Level)       rDebugTraceScope RDEBUG_TRACE_CONCAT( rTimed_,      __LINE__ )( __FILE__, __LINE__, __PRETTY_FUNCTION__, __PRETTY_FUNCTION__, Level )
+#endif
+
+
+
+// -----------------------
+// the trace sink: collects the spans of rTraceScope()/rTimed() and writes them as
+// Chrome Trace Event JSON ("traceEvents" with complete "X" events), readable by Perfetto as well.
+// usage:
+//    rDebug_TraceRecorder rLogTrace( "/tmp/myapp.trace.json" );  // written by the DTor
+//    ...
+//    rLogTrace.write();                                          // or now, additionally
+// note:
+//    at most MaxSpans are kept, the ones after are counted in "otherData" as lost_spans
+// -----------------------
+class rDebug_TraceRecorder
+{
+  friend class rDebugTraceScope;
+public:
+  struct Span
+  {
+    const char* mName;
+    const char* mFile;
+    int         mLine;
+    const char* mFunc;
+    quint32     mThreadId;
+    int         mDepth;
+    quint64     mBeginNs;
+    quint64     mEndNs;
+  };
+
+  explicit rDebug_TraceRecorder( const QString& FileName, int MaxSpans=0x100000 );
+  virtual ~rDebug_TraceRecorder();
+  bool write();
+  static bool active() { return pTraceRecorder.isSet(); }
+
+private:
+  void add( const Span& Done, rDebugCore::Span ThreadName );
+
+private:
+  static rDebug_SinkSlot<rDebug_TraceRecorder> pTraceRecorder;
+  const QString  mFileName;
+  const int      mMaxSpans;
+  const quint64  mOriginNs;
+  QMutex         mLock;
+  QVector<Span>  mSpans;
+  QHash<quint32, QByteArray> mThreadNames; // rDebugThread::id() -> name, for the "thread_name" metadata
+  quint64        mLost;
+};
+
+
+inline rDebugTraceScope::rDebugTraceScope( const char *file, int line, const char* func, const char* Name, rDebugLevel::rMsgType Level )
+  : mLocation( file, line, func )
+  , mName( Name )
+  , mLevel( Level )
+  , mLog( Level > rDebugLevel::rMsgType::Silent && rDebug_GlobalLevel::passes( file, line, Level ) )
+  , mTrace( rDebug_TraceRecorder::active() )
+  , mDepth( 0 )
+  , mBeginNs( 0 )
+{
+  if( mLog || mTrace )
+  {
+    mDepth   = mDepthThisThread++;
+    mBeginNs = rDebugStats::now();
+  }
+}
+
+#endif // RDEBUGTRACE_H
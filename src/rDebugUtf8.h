@@ -0,0 +1,155 @@
+#ifndef RDEBUGUTF8_H
+#define RDEBUGUTF8_H
+/**
+ * Project "rDebug"
+ *
+ * rDebugUtf8.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && (_M_IX86_FP>=2) )
+#  include <emmintrin.h>
+#  define RDEBUG_UTF8_SSE2 1
+#endif
+
+
+// -----------------------
+// UTF-16 / Latin-1 to UTF-8 encoder, used to bring QString arguments once into the UTF-8 message
+// of rDebugRecord. From there on, all sinks work on these bytes, only the Qt signal gets a QString.
+// The Buffer needs size(), resize( int ) and a writable data() (see writableData()), so std::string or QByteArray will do.
+// usage:
+//    std::string msg;
+//    rDebugUtf8::appendUtf16( msg, str.utf16(), str.size() );
+// note:
+//    - pure ASCII runs are copied 8 (UTF-16) or 16 (Latin-1) chars at once with SSE2,
+//      the others go through the scalar loop
+//    - unpaired surrogates become U+FFFD, like QString::toUtf8() does it
+// -----------------------
+namespace rDebugUtf8
+{
+  // std::string::data() is const up to C++17, and QByteArray::operator[] gives a QByteRef
+  inline char* writableData( std::string& Buffer ) { return &Buffer[0]; }
+  template<class Buffer> char* writableData( Buffer& out ) { return out.data(); }
+
+
+  template<class Buffer>
+  void appendUtf16( Buffer& out, const uint16_t* src, int len )
+  {
+    if( len <= 0 )
+      return;
+    const int old = static_cast<int>( out.size() );
+    out.resize( old + 3*len ); // worst case, a surrogate pair (2 units) becomes 4 bytes only
+    unsigned char* const dst0 = reinterpret_cast<unsigned char*>( writableData( out ) );
+    unsigned char*       dst = dst0 + old;
+    const uint16_t* const end = src + len;
+
+    while( src < end )
+    {
+#if defined(RDEBUG_UTF8_SSE2)
+      const __m128i nonAscii = _mm_set1_epi16( static_cast<short>(0xFF80) );
+      while( end - src >= 8 )
+      {
+        const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>(src) );
+        if( _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_and_si128( chunk, nonAscii ), _mm_setzero_si128() ) ) != 0xFFFF )
+          break;
+        _mm_storel_epi64( reinterpret_cast<__m128i*>(dst), _mm_packus_epi16( chunk, chunk ) );
+        src += 8;
+        dst += 8;
+      }
+      if( src >= end )
+        break;
+#endif
+      const unsigned uc = *src++;
+      if( uc < 0x80 )
+      { *dst++ = static_cast<unsigned char>( uc );
+      }
+      else if( uc < 0x800 )
+      { *dst++ = static_cast<unsigned char>( 0xC0 | (uc >> 6) );
+        *dst++ = static_cast<unsigned char>( 0x80 | (uc & 0x3F) );
+      }
+      else if( uc >= 0xD800 && uc < 0xDC00 && src < end && *src >= 0xDC00 && *src < 0xE000 )
+      { const unsigned cp = 0x10000 + ( (uc - 0xD800) << 10 ) + ( *src++ - 0xDC00 );
+        *dst++ = static_cast<unsigned char>( 0xF0 | (cp >> 18) );
+        *dst++ = static_cast<unsigned char>( 0x80 | ((cp >> 12) & 0x3F) );
+        *dst++ = static_cast<unsigned char>( 0x80 | ((cp >> 6) & 0x3F) );
+        *dst++ = static_cast<unsigned char>( 0x80 | (cp & 0x3F) );
+      }
+      else
+      { const unsigned cp = ( uc >= 0xD800 && uc < 0xE000 ) ? 0xFFFD : uc; // unpaired surrogate
+        *dst++ = static_cast<unsigned char>( 0xE0 | (cp >> 12) );
+        *dst++ = static_cast<unsigned char>( 0x80 | ((cp >> 6) & 0x3F) );
+        *dst++ = static_cast<unsigned char>( 0x80 | (cp & 0x3F) );
+      }
+    }
+    out.resize( static_cast<int>( dst - dst0 ) );
+  }
+
+
+  template<class Buffer>
+  void appendLatin1( Buffer& out, const char* src, int len )
+  {
+    if( len <= 0 )
+      return;
+    const int old = static_cast<int>( out.size() );
+    out.resize( old + 2*len );
+    unsigned char* const dst0 = reinterpret_cast<unsigned char*>( writableData( out ) );
+    unsigned char*       dst = dst0 + old;
+    const unsigned char*       pos = reinterpret_cast<const unsigned char*>( src );
+    const unsigned char* const end = pos + len;
+
+    while( pos < end )
+    {
+#if defined(RDEBUG_UTF8_SSE2)
+      while( end - pos >= 16 )
+      {
+        const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pos) );
+        if( _mm_movemask_epi8( chunk ) ) // any byte >= 0x80
+          break;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(dst), chunk );
+        pos += 16;
+        dst += 16;
+      }
+      if( pos >= end )
+        break;
+#endif
+      const unsigned ch = *pos++;
+      if( ch < 0x80 )
+      { *dst++ = static_cast<unsigned char>( ch );
+      }
+      else
+      { *dst++ = static_cast<unsigned char>( 0xC0 | (ch >> 6) );
+        *dst++ = static_cast<unsigned char>( 0x80 | (ch & 0x3F) );
+      }
+    }
+    out.resize( static_cast<int>( dst - dst0 ) );
+  }
+
+} // namespace rDebugUtf8
+
+#endif // RDEBUGUTF8_H
@@ -0,0 +1,9 @@
+# gzip frames of the file sink (rDebugFileIo::Gzip) need zlib, "qmake CONFIG+=nozlib" builds without.
+# zlib is linked only where pkg-config finds it, else RDEBUG_NO_ZLIB is set, so the link line and
+# rDebugFileIo.cpp (which looks for <zlib.h> on its own) always agree.
+nozlib|win32|!packagesExist(zlib) {
+    DEFINES += RDEBUG_NO_ZLIB
+} else {
+    CONFIG    += link_pkgconfig
+    PKGCONFIG += zlib
+}
@@ -0,0 +1,146 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_FormatTest.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// checks the number to text conversion of rDebugFormat against a table of the texts std::to_chars
+// gives (C++17). Built as C++11 it checks the hand made fallback of formatDouble(), built as C++17
+// (where <charconv> has it) to_chars itself, so both are known to write the same.
+// The fallback is checked in the "C" locale and in one with a ',' as decimal point, if there is one.
+// usage:
+//    rDebug_FormatTest            returns non-zero on any mismatch
+
+#include <stdio.h>
+#include <string.h>
+#include <locale.h>
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "../src/rDebugFormat.h"
+
+
+struct DoubleCase
+{
+  double      mValue;
+  const char* mText;
+};
+
+static const DoubleCase DoubleCases[] =
+{ { 0.0,                       "0" }
+, { -0.0,                      "-0" }
+, { 1.0,                       "1" }
+, { -1.0,                      "-1" }
+, { 100.0,                     "100" }
+, { 1e15,                      "1e+15" }                    // integral, but the exponent is shorter
+, { 1e16,                      "1e+16" }
+, { 1e22,                      "1e+22" }
+, { 1e23,                      "1e+23" }
+, { 123456789012345680000.0,   "123456789012345683968" }    // fixed beyond 2^53: the exact digits
+, { 9007199254740992.0,        "9007199254740992" }         // 2^53
+, { 9007199254740994.0,        "9007199254740994" }
+, { 18446744073709551616.0,    "18446744073709551616" }     // 2^64
+, { 0.1,                       "0.1" }
+, { 0.3,                       "0.3" }
+, { 1.0/3,                     "0.3333333333333333" }
+, { 2.0/3,                     "0.6666666666666666" }
+, { -1.5,                      "-1.5" }
+, { 123456.789,                "123456.789" }
+, { 0.001,                     "0.001" }                    // a tie: fixed
+, { 1e-5,                      "1e-05" }
+, { 1.25e-7,                   "1.25e-07" }
+, { 5e-324,                    "5e-324" }                   // the smallest subnormal
+, { 1.5e-323,                  "1.5e-323" }
+, { DBL_MIN,                   "2.2250738585072014e-308" }
+, { DBL_MAX,                   "1.7976931348623157e+308" }
+, { 1e300,                     "1e+300" }
+, { HUGE_VAL,                  "inf" }
+, { -HUGE_VAL,                 "-inf" }
+, { NAN,                       "nan" }
+};
+
+
+static int checkTable( const char* Locale )
+{
+  int Failed = 0;
+  for( size_t i=0 ; i<sizeof(DoubleCases)/sizeof(DoubleCases[0]) ; ++i )
+  {
+    char Text[rDebugFormat::MaxChars];
+    const int Len = rDebugFormat::formatDouble( Text, DoubleCases[i].mValue );
+    if( Len != static_cast<int>( strlen( DoubleCases[i].mText ) ) || memcmp( Text, DoubleCases[i].mText, static_cast<size_t>(Len) ) )
+    {
+      printf( "  %s: %.17g gives \"%.*s\", expected \"%s\"\n", Locale, DoubleCases[i].mValue, Len, Text, DoubleCases[i].mText );
+      ++Failed;
+    }
+  }
+  return Failed;
+}
+
+
+// random bit patterns: the text must read back to the same double (in the "C" locale)
+static int checkRoundTrip( int Count )
+{
+  int Failed = 0;
+  uint64_t State = 0x9E3779B97F4A7C15ull;
+  for( int i=0 ; i<Count ; ++i )
+  {
+    State ^= State << 13;  State ^= State >> 7;  State ^= State << 17; // xorshift64
+    double Value;
+    memcpy( &Value, &State, sizeof(Value) );
+    if( Value != Value || Value == HUGE_VAL || Value == -HUGE_VAL )
+      continue;
+    char Text[rDebugFormat::MaxChars + 1];
+    Text[ rDebugFormat::formatDouble( Text, Value ) ] = '\0';
+    if( strtod( Text, nullptr ) != Value )
+    {
+      if( ++Failed <= 10 )
+        printf( "  round trip: %.17g gives \"%s\"\n", Value, Text );
+    }
+  }
+  return Failed;
+}
+
+
+int main()
+{
+  int Failed = checkTable( "C" );
+  Failed += checkRoundTrip( 1000000 );
+
+  static const char* const CommaLocales[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "German_Germany" };
+  for( size_t i=0 ; i<sizeof(CommaLocales)/sizeof(CommaLocales[0]) ; ++i )
+  {
+    if( setlocale( LC_NUMERIC, CommaLocales[i] ) )
+    {
+      Failed += checkTable( CommaLocales[i] );
+      setlocale( LC_NUMERIC, "C" );
+      break;
+    }
+  }
+
+  printf( "%s\n", Failed ? "FAILED" : "PASSED" );
+  return Failed ? 1 : 0;
+}
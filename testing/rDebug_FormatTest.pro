@@ -0,0 +1,18 @@
+QT -= gui core
+
+CONFIG += c++11 console
+CONFIG -= app_bundle qt
+
+# checks rDebugFormat against a table of std::to_chars texts, plain C++, no Qt.
+# C++11 checks the fallback of formatDouble(), "qmake CONFIG+=cxx17" checks to_chars itself:
+#    qmake rDebug_FormatTest.pro && make && make check
+cxx17: CONFIG += c++1z
+
+unix: check.commands = ./rDebug_FormatTest
+else: check.commands = rDebug_FormatTest
+QMAKE_EXTRA_TARGETS += check
+
+SOURCES += rDebug_FormatTest.cpp
+
+HEADERS += \
+    ../src/rDebugFormat.h
@@ -0,0 +1,286 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_StressTest.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// multithreaded stress test: N threads log through all macros, while the main thread changes
+// the levels, moves the log file and forces rotations. Afterwards all log files are read back.
+// Fails, if any line of Warning level or above is lost, doubled or torn (in the files or at the
+// Qt signal), or if the signalled lines of a thread come out of order.
+// Runs 5 phases: direct sinks, then rDebug_AsyncWriter in both Queueing modes (SharedQueue and
+// PerThreadRings), each without and with deferred formatting.
+// usage:
+//    rDebug_StressTest [threads=8] [lines per thread=10000]
+// build with ThreadSanitizer, see rDebug_StressTest.pro
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QTextStream>
+
+#include "rDebug_StressTest.h"
+
+
+static QByteArray stressPayload( int Thread, int Seq )
+{
+  const int len = 1 + ( Seq*7 + Thread*13 ) % 160;
+  QByteArray Payload( len, 'a' );
+  for( int i=0 ; i<len ; ++i )
+    Payload[i] = static_cast<char>( 'a' + ( Thread + Seq + i ) % 26 );
+  return Payload;
+}
+
+
+// Warning and above, main() never filters these by its level changes, so all of them must arrive
+static bool stressChecked( int Seq )
+{
+  const int Macro = Seq % 10;
+  return ( Macro >= 3 && Macro != 6 );
+}
+
+
+static int stressExpected( int Lines )
+{
+  int Count = 0;
+  for( int Seq=0 ; Seq<Lines ; ++Seq )
+    Count += stressChecked( Seq ) ? 1 : 0;
+  return Count;
+}
+
+
+// "... stress <thread> <seq> <payload> end", false if the line is torn or mixed with another one
+static bool stressParse( const QByteArray& Line, int& Thread, int& Seq )
+{
+  const int pos = Line.indexOf( "stress " );
+  if( pos < 0 )
+    return false;
+  const QList<QByteArray> Parts = Line.mid( pos ).split( ' ' );
+  if( Parts.size() != 5 || Parts.at(4) != "end" )
+    return false;
+  bool okThread = false, okSeq = false;
+  Thread = Parts.at(1).toInt( &okThread );
+  Seq    = Parts.at(2).toInt( &okSeq );
+  return okThread && okSeq && Thread >= 0 && Seq >= 0 && Parts.at(3) == stressPayload( Thread, Seq );
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+void StressWorker::run()
+{
+  rDebug_AsyncWriter::setDeferredFormatting( mDeferred );
+  for( int Seq=0 ; Seq<mLines ; ++Seq )
+  {
+    const QByteArray  Payload( stressPayload( mThread, Seq ) );
+    const char* const p = Payload.constData();
+    switch( Seq % 10 )
+    {
+      case 0: rDebug()    << "stress" << mThread << Seq << Payload << "end"; break;
+      case 1: rInfo(         "stress %d %d %s end", mThread, Seq, p ); break;
+      case 2: rNote()     << "stress" << mThread << Seq << p << "end"; break;
+      case 3: rWarning()  << "stress" << mThread << Seq << QString::fromLatin1( p ) << "end"; break;
+      case 4: rError(        "stress %d %d %s end", mThread, Seq, p ); break;
+      case 5: rCritical() << rLiteral( "stress" ) << mThread << Seq << Payload << "end"; break;
+      case 6: qDebug()    << "stress" << mThread << Seq << Payload << "end"; break;
+      case 7: qWarning(      "stress %d %d %s end", mThread, Seq, p ); break;
+      case 8: qCritical() << "stress" << mThread << Seq << p << "end"; break;
+      case 9: rSystem(       "stress %d %d %s end", mThread, Seq, p ); break;
+    }
+  }
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+StressReceiver::StressReceiver( int Threads )
+  : mLastSeq( Threads, -1 )
+  , mChecked( Threads, 0 )
+  , mErrors(0)
+{}
+
+
+int StressReceiver::errors() const
+{
+  QMutexLocker Lock( &mLock );
+  return mErrors;
+}
+
+
+int StressReceiver::checkedLines( int Thread ) const
+{
+  QMutexLocker Lock( &mLock );
+  return mChecked.at( Thread );
+}
+
+
+void StressReceiver::on_logline( const FileLineFunc_t& CodeLocation, const QDateTime& Time, int Level, uint64_t LogId, const QString& line )
+{
+  Q_UNUSED(CodeLocation); Q_UNUSED(Time); Q_UNUSED(Level); Q_UNUSED(LogId);
+
+  int Thread = -1, Seq = -1;
+  const bool Parsed = stressParse( line.toUtf8(), Thread, Seq ) && Thread < mLastSeq.size();
+
+  QMutexLocker Lock( &mLock );
+  if( !Parsed )
+  { ++mErrors;
+    return;
+  }
+  if( Seq <= mLastSeq.at( Thread ) ) // doubled or out of order
+    ++mErrors;
+  mLastSeq[Thread] = Seq;
+  if( stressChecked( Seq ) )
+    ++mChecked[Thread];
+}
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+static int runPhase( const char* Name, int Threads, int Lines, bool Async, rDebug_AsyncWriter::Queueing Mode, bool Deferred )
+{
+  QTextStream out( stdout );
+  QDir Dir( QDir::tempPath() + "/rDebug_StressTest" );
+  Dir.mkpath( "." );
+  const QStringList OldFiles( Dir.entryList( QDir::Files ) );
+  for( int i=0 ; i<OldFiles.size() ; ++i )
+    Dir.remove( OldFiles.at(i) );
+  const QString FileA( Dir.filePath( "stress_a.log" ) );
+  const QString FileB( Dir.filePath( "stress_b.log" ) );
+
+  rDebug_GlobalLevel::set( rDebugLevel::rMsgType::All );
+  rDebugBase::setMaxLevel( rDebugLevel::rMsgType::Silent ); // keep the console quiet
+  StressReceiver Receiver( Threads );
+  QElapsedTimer  Timer;
+  int            Rounds = 0;
+  Timer.start();
+  {
+    rDebug_Signaller rLogSignalSlot( rDebugLevel::rMsgType::All );
+    QObject::connect( &rLogSignalSlot, SIGNAL(sig_logline(const FileLineFunc_t&,const QDateTime&,int,uint64_t,const QString&)),
+                      &Receiver,       SLOT(   on_logline(const FileLineFunc_t&,const QDateTime&,int,uint64_t,const QString&)),
+                      Qt::DirectConnection );
+    rDebug_Filewriter rLogFile( FileA, rDebugLevel::rMsgType::All, 30000/*Max Backups, none shall get lost*/, 0x10000 );
+    QScopedPointer<rDebug_AsyncWriter> pAsync( (Async) ? new rDebug_AsyncWriter( 0x1000, rDebug_AsyncWriter::Block, Mode ) : nullptr );
+
+    QList<StressWorker*> Workers;
+    for( int Thread=0 ; Thread<Threads ; ++Thread )
+    {
+      Workers.append( new StressWorker( Thread, Lines, Deferred ) );
+      Workers.last()->start();
+    }
+
+    // meanwhile, the main thread changes whatever can be changed at runtime
+    static const rDebugLevel::rMsgType Levels[3] = { rDebugLevel::rMsgType::Warning, rDebugLevel::rMsgType::Debug, rDebugLevel::rMsgType::All };
+    for(;;)
+    {
+      bool Running = false;
+      for( int i=0 ; i<Workers.size() ; ++i )
+        Running = Running || Workers.at(i)->isRunning();
+      if( !Running )
+        break;
+
+      ++Rounds;
+      rDebug_GlobalLevel::set(         Levels[ Rounds % 3 ] );
+      rDebug_Filewriter::setMaxLevel(  Levels[ (Rounds/3) % 3 ] );
+      rDebug_Signaller::setMaxLevel(   Levels[ (Rounds/5) % 3 ] );
+      rDebugBase::setMaxLevel( (Rounds & 1) ? rDebugLevel::rMsgType::Silent : rDebugLevel::rMsgType::Emergency );
+      if( !(Rounds % 7) )
+        rLogFile.setMaxSize( (Rounds & 8) ? 0x10000 : 0x18000 );
+      if( !(Rounds % 50) )
+        rLogFile.move( ((Rounds/50) & 1) ? FileB : FileA );
+      QThread::msleep( 1 );
+    }
+
+    for( int i=0 ; i<Workers.size() ; ++i )
+    {
+      Workers.at(i)->wait();
+      delete Workers.at(i);
+    }
+    if( pAsync )
+      pAsync->flush();
+    pAsync.reset();
+  } // all sinks closed here
+  const qint64 Elapsed = Timer.elapsed();
+
+  // read back all log files, including the rotated and moved ones
+  QVector< QVector<char> > Seen( Threads, QVector<char>( Lines, 0 ) );
+  int FileLines = 0, Torn = 0, Doubled = 0, Lost = 0, SignalLost = 0;
+  const QStringList LogFiles( Dir.entryList( QDir::Files ) );
+  for( int f=0 ; f<LogFiles.size() ; ++f )
+  {
+    QFile LogFile( Dir.filePath( LogFiles.at(f) ) );
+    if( !LogFile.open( QIODevice::ReadOnly ) )
+      continue;
+    const QList<QByteArray> RawLines( LogFile.readAll().split( '\n' ) );
+    for( int l=0 ; l<RawLines.size() ; ++l )
+    {
+      const QByteArray Line( RawLines.at(l).trimmed() );
+      if( Line.indexOf( "stress " ) < 0 ) // BOM, open/close/rotate/move notes
+        continue;
+      ++FileLines;
+      int Thread = -1, Seq = -1;
+      if( !stressParse( Line, Thread, Seq ) || Thread >= Threads || Seq >= Lines )
+      { ++Torn;
+        continue;
+      }
+      if( Seen[Thread][Seq]++ )
+        ++Doubled;
+    }
+  }
+  for( int Thread=0 ; Thread<Threads ; ++Thread )
+  {
+    for( int Seq=0 ; Seq<Lines ; ++Seq )
+      if( stressChecked( Seq ) && !Seen[Thread][Seq] )
+        ++Lost;
+    SignalLost += stressExpected( Lines ) - Receiver.checkedLines( Thread );
+  }
+
+  const bool Failed = ( Torn || Doubled || Lost || SignalLost || Receiver.errors() );
+  out << Name << ": " << Threads << " threads x " << Lines << " lines, " << Elapsed << " ms, " << Rounds << " rounds of changes" << endl
+      << "  file  : " << FileLines << " lines in " << LogFiles.size() << " files, "
+      << Torn << " torn, " << Doubled << " doubled, " << Lost << " lost" << endl
+      << "  signal: " << Receiver.errors() << " torn/out of order, " << SignalLost << " lost" << endl
+      << "  " << ( Failed ? "FAILED" : "passed" ) << endl;
+  return Failed ? 1 : 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  const QStringList Args( a.arguments() );
+  const int Threads = qMax( 1, (Args.size() > 1) ? Args.at(1).toInt() : 8 );
+  const int Lines   = qMax( 10, (Args.size() > 2) ? Args.at(2).toInt() : 10000 );
+
+  int Failed = 0;
+  Failed += runPhase( "direct",               Threads, Lines, false, rDebug_AsyncWriter::SharedQueue,    false );
+  Failed += runPhase( "async queue",          Threads, Lines, true,  rDebug_AsyncWriter::SharedQueue,    false );
+  Failed += runPhase( "async queue deferred", Threads, Lines, true,  rDebug_AsyncWriter::SharedQueue,    true  );
+  Failed += runPhase( "async rings",          Threads, Lines, true,  rDebug_AsyncWriter::PerThreadRings, false );
+  Failed += runPhase( "async rings deferred", Threads, Lines, true,  rDebug_AsyncWriter::PerThreadRings, true  );
+
+  QTextStream( stdout ) << ( Failed ? "FAILED" : "PASSED" ) << endl;
+  return Failed ? 1 : 0;
+}
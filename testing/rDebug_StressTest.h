@@ -0,0 +1,89 @@
+#ifndef RDEBUG_STRESSTEST_H
+#define RDEBUG_STRESSTEST_H
+/**
+ * Project "rDebug"
+ *
+ * rDebug_StressTest.h
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+#include <QDebug>   // before rDebug.h, so q*() get redirected also
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QByteArray>
+
+#include "../src/rDebug.h"
+
+
+// -----------------------
+// one of the N logging threads: writes Lines lines "stress <thread> <seq> <payload> end",
+// rotating through all log macros (printf and stream style, r* and q*)
+// -----------------------
+class StressWorker : public QThread
+{
+public:
+  StressWorker( int Thread, int Lines, bool Deferred )
+    : mThread(Thread)
+    , mLines(Lines)
+    , mDeferred(Deferred)
+    {}
+
+protected:
+  virtual void run();
+
+private:
+  const int  mThread;
+  const int  mLines;
+  const bool mDeferred;
+};
+
+
+
+// -----------------------
+// the slot for rDebug_Signaller, connected direct, so it runs in the logging threads
+// (or in the one of rDebug_AsyncWriter). Checks each line, and that the lines of each
+// thread come in their order.
+// -----------------------
+class StressReceiver : public QObject
+{
+  Q_OBJECT
+public:
+  explicit StressReceiver( int Threads );
+  int errors() const;
+  int checkedLines( int Thread ) const;
+
+public slots:
+  void on_logline( const FileLineFunc_t& CodeLocation, const QDateTime& Time, int Level, uint64_t LogId, const QString& line );
+
+private:
+  mutable QMutex mLock;
+  QVector<int>   mLastSeq;  // per thread
+  QVector<int>   mChecked;  // per thread
+  int            mErrors;
+};
+
+#endif // RDEBUG_STRESSTEST_H
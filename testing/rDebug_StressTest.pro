@@ -0,0 +1,59 @@
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which as been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# ThreadSanitizer build (gcc/clang):
+#    qmake CONFIG+=tsan rDebug_StressTest.pro && make && make check
+tsan {
+    QMAKE_CXXFLAGS += -fsanitize=thread -g -O1
+    QMAKE_LFLAGS   += -fsanitize=thread
+}
+
+# "make check" runs the stress test, returns non-zero on any lost/torn line or TSan report
+unix: check.commands = TSAN_OPTIONS=\"halt_on_error=1 suppressions=$$PWD/rDebug_StressTest.tsan.supp\" ./rDebug_StressTest 8 10000
+else: check.commands = rDebug_StressTest 8 10000
+QMAKE_EXTRA_TARGETS += check
+
+include( ../src/rDebugZlib.pri ) # gzip frames of the file sink, "qmake CONFIG+=nozlib" builds without
+
+SOURCES += rDebug_StressTest.cpp \
+    ../src/rDebug.cpp \
+    ../src/rDebugPattern.cpp \
+    ../src/rDebugRecord.cpp \
+    ../src/rDebugRecordQt.cpp \
+    ../src/rDebugStats.cpp \
+    ../src/rDebugMetrics.cpp \
+    ../src/rDebugTrace.cpp \
+    ../src/rDebugConfig.cpp \
+    ../src/rDebugFileIo.cpp \
+    ../src/rDebugRetention.cpp \
+    ../src/rDebugSeekIndex.cpp \
+    ../src/rDebugCore.cpp
+
+HEADERS += \
+    rDebug_StressTest.h \
+    ../src/rDebug.h \
+    ../src/rDebugCodeloc.h \
+    ../src/rDebugLevel.h \
+    ../src/rDebugJson.h \
+    ../src/rDebugPattern.h \
+    ../src/rDebugRecord.h \
+    ../src/rDebugFormat.h \
+    ../src/rDebugUtf8.h \
+    ../src/rDebugStats.h \
+    ../src/rDebugMetrics.h \
+    ../src/rDebugTrace.h \
+    ../src/rDebugConfig.h \
+    ../src/rDebugRing.h \
+    ../src/rDebugFileIo.h \
+    ../src/rDebugRetention.h \
+    ../src/rDebugSeekIndex.h \
+    ../src/rDebugCore.h \
+    ../src/rDebugFmt.h
@@ -0,0 +1,520 @@
+/**
+ * Project "rDebug"
+ *
+ * rDebug_Grep.cpp
+ *
+ * Loving qDebug? But missing some things?
+ * Just want to see your debugs/logs in a QtWidget, like QListView?
+ * But got crashes with qInstallMsgHandler (4.x) / qInstallMessageHandler (5.x)?
+ * Missing file name, line numbers with qDebug 4.x?
+ *
+ * You are welcome, here we go!
+ *
+ * This is mostly a simplified re-implementation, which under the hood also uses parts of qDebug().
+ * You can use
+ *    qDebug( "printf mask %s","is worse");
+ * or
+ *    qDebug() << "streams" << "are more safe";
+ * or a mix of both. You can select between all 7 BSD-Syslog levels (plus "Silent" and "All").
+ * A two-liner can send Qt SIGNAL with the data, time stamp, location and level to your QListWidget (or whatever).
+ * Another two-liner can write to file and use different log level filtering.
+ * For the start, some features of Qt5, like
+ *    qDebug( &stream_device ) << "are not supported"; // and may never come.
+ *
+ * copyright 2019 Sergeant Kolja, GERMANY
+ *
+ * distributed under the terms of the 2-clause license also known as "Simplified BSD License" or "FreeBSD License"
+ * License is compatible with GPL and LGPL
+ */
+
+// rdebug-grep: searches the logfiles of rDebug_Filewriter (classic layout) and all their rotated backups,
+// by level, time range, LogId and text, in parallel, and prints the lines found in time order.
+// usage:
+//    rdebug-grep [options] [pattern] logfile...
+//    rdebug-grep --level Warn --from "2026-10-18 14:00" --to "2026-10-18 14:30" /var/log/app.log
+//    rdebug-grep --logid 4711 -H "timeout" app.log
+// see about_this_tool.txt
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QRegExp>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/rDebugSeekIndex.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && (_M_IX86_FP>=2) )
+#  include <emmintrin.h>
+#  define RDEBUG_GREP_SSE2 1
+#endif
+
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+// "2026-10-18 14:00:00,123 [Warn] 4711 [main:1234 #17], message {from func in file:42}"
+enum { TimeLen = 23, ChunkSize = 0x400000 };
+
+static const char* const LevelNames[8] = { "Emrg", "Alrt", "Crit", "Err!", "Warn", "Note", "Info", "Debg" };
+
+
+struct LogFile
+{
+  QString     mName;
+  QFile*      mpFile;
+  const char* mpData;   // mapped
+  qint64      mSize;
+};
+
+struct Chunk
+{
+  int         mFile;
+  qint64      mBegin;
+  qint64      mEnd;
+};
+
+struct Match
+{
+  const char* mpLine;
+  int         mLen;
+  const char* mpTime;   // of the line, or of the last line before with a time stamp (continued messages)
+  int         mFile;
+  qint64      mOffset;
+};
+
+struct Filter
+{
+  Filter() : mMaxLevel(7), mByLogId(false), mLogId(0), mStructured(false), mLiteralOnly(false) {}
+  int         mMaxLevel;
+  QByteArray  mFrom;      // prefixes of the time stamp, "2026-10-18 14" is fine
+  QByteArray  mTo;
+  bool        mByLogId;
+  quint64     mLogId;
+  bool        mStructured;  // any of the above is set, lines without the layout are skipped then
+  QByteArray  mPrefilter;   // each line found contains it, looked up before the line is parsed
+  bool        mLiteralOnly; // the pattern is mPrefilter, no regular expression needed
+  QString     mPattern;
+};
+
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+static const char* nextNewline( const char* p, const char* End )
+{
+#if defined(RDEBUG_GREP_SSE2)
+  const __m128i Nl = _mm_set1_epi8( '\n' );
+  for( ; p + 16 <= End ; p += 16 )
+  {
+    const unsigned Mask = static_cast<unsigned>( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) ), Nl ) ) );
+    if( Mask )
+    {
+#  if defined(_MSC_VER)
+      unsigned long Bit;
+      _BitScanForward( &Bit, Mask );
+      return p + Bit;
+#  else
+      return p + __builtin_ctz( Mask );
+#  endif
+    }
+  }
+#endif
+  const void* Hit = memchr( p, '\n', static_cast<size_t>( End - p ) );
+  return Hit ? static_cast<const char*>( Hit ) : End;
+}
+
+
+static const char* lineStart( const char* Limit, const char* p )
+{
+  while( p > Limit && p[-1] != '\n' )
+    --p;
+  return p;
+}
+
+
+// memchr() for the first byte, then compare the rest
+static const char* findLiteral( const char* p, const char* End, const QByteArray& Literal )
+{
+  const char   First = Literal.at(0);
+  const size_t Rest  = static_cast<size_t>( Literal.size() - 1 );
+  while( End - p > static_cast<qint64>( Rest ) )
+  {
+    const char* Hit = static_cast<const char*>( memchr( p, First, static_cast<size_t>( End - p ) - Rest ) );
+    if( !Hit )
+      return nullptr;
+    if( 0 == memcmp( Hit + 1, Literal.constData() + 1, Rest ) )
+      return Hit;
+    p = Hit + 1;
+  }
+  return nullptr;
+}
+
+
+static bool isTimeStamp( const char* p, const char* End )
+{
+  return ( End - p >= TimeLen ) && p[4]=='-' && p[7]=='-' && p[10]==' ' && p[13]==':' && p[16]==':'
+      && p[0]>='0' && p[0]<='9';
+}
+
+
+// the time stamp of a continued message is the one of the line it continues
+static const char* stampOf( const char* Data, const char* Line, const char* Eol )
+{
+  for( int Lines=0 ; Lines<1000 ; ++Lines )
+  {
+    if( isTimeStamp( Line, Eol ) )
+      return Line;
+    if( Line == Data )
+      return nullptr;
+    Eol  = Line - 1;
+    Line = lineStart( Data, Eol );
+  }
+  return nullptr;
+}
+
+
+static int levelOf( const char* p )
+{
+  for( int i=0 ; i<8 ; ++i )
+    if( 0 == memcmp( p, LevelNames[i], 4 ) )
+      return i;
+  return -1;
+}
+
+
+// the time stamp, [Levl] and LogId of the classic layout
+static bool parseLine( const char* p, const char* End, int& Level, quint64& LogId )
+{
+  if( End - p < TimeLen + 9 || !isTimeStamp( p, End ) )
+    return false;
+  const char* q = p + TimeLen;
+  if( q[0] != ' ' || q[1] != '[' || q[6] != ']' || q[7] != ' ' )
+    return false;
+  Level = levelOf( q + 2 );
+  if( Level < 0 )
+    return false;
+  LogId = 0;
+  for( q += 8 ; q < End && *q >= '0' && *q <= '9' ; ++q )
+    LogId = LogId * 10 + static_cast<quint64>( *q - '0' );
+  return true;
+}
+
+
+static bool lineMatches( const char* p, const char* End, const Filter& Flt, QRegExp* pRx )
+{
+  if( Flt.mStructured )
+  {
+    int Level;
+    quint64 LogId;
+    if( !parseLine( p, End, Level, LogId ) )
+      return false;
+    if( Level > Flt.mMaxLevel )
+      return false;
+    if( Flt.mByLogId && LogId != Flt.mLogId )
+      return false;
+    if( !Flt.mFrom.isEmpty() && memcmp( p, Flt.mFrom.constData(), static_cast<size_t>( Flt.mFrom.size() ) ) < 0 )
+      return false;
+    if( !Flt.mTo.isEmpty() && memcmp( p, Flt.mTo.constData(), static_cast<size_t>( Flt.mTo.size() ) ) > 0 )
+      return false;
+  }
+  if( Flt.mLiteralOnly && !findLiteral( p, End, Flt.mPrefilter ) )
+    return false;
+  if( pRx && pRx->indexIn( QString::fromUtf8( p, static_cast<int>( End - p ) ) ) < 0 )
+    return false;
+  return true;
+}
+
+
+// the lines starting in [Begin,End) of the chunk, a line may go on behind End
+static void scanChunk( const LogFile& File, const Chunk& C, const Filter& Flt, QRegExp* pRx, QVector<Match>& Out )
+{
+  const char* const Data    = File.mpData;
+  const char* const FileEnd = Data + File.mSize;
+  const char*       p       = Data + C.mBegin;
+  const char* const End     = Data + C.mEnd;
+  // the end of the last line starting in the chunk, the prefilter does not search beyond
+  const char* const LastEol = ( End > p && End < FileEnd ) ? nextNewline( End-1, FileEnd ) : FileEnd;
+
+  if( p > Data && p[-1] != '\n' ) // the line started in the chunk before
+    p = qMin( nextNewline( p, FileEnd ) + 1, FileEnd );
+
+  while( p < End )
+  {
+    const char* Line = p;
+    if( !Flt.mPrefilter.isEmpty() )
+    {
+      const char* Hit = findLiteral( p, LastEol, Flt.mPrefilter );
+      if( !Hit )
+        break;
+      Line = lineStart( p, Hit );
+      if( Line >= End )
+        break;
+    }
+    const char* Eol = nextNewline( Line, FileEnd );
+    if( lineMatches( Line, Eol, Flt, pRx ) )
+    {
+      const Match M = { Line, static_cast<int>( Eol - Line ), stampOf( Data, Line, Eol ), C.mFile, Line - Data };
+      Out.append( M );
+    }
+    p = Eol + 1;
+  }
+}
+
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+class Searcher : public QThread
+{
+public:
+  Searcher( const QVector<LogFile>& Files, const QVector<Chunk>& Chunks, const Filter& Flt,
+            std::atomic<int>& Next, QVector< QVector<Match> >& Results )
+    : mFiles(Files), mChunks(Chunks), mFlt(Flt), mNext(Next), mResults(Results) {}
+
+protected:
+  virtual void run()
+  {
+    QRegExp Rx( mFlt.mPattern ); // an own one per thread
+    QRegExp* pRx = ( mFlt.mPattern.isEmpty() || mFlt.mLiteralOnly ) ? nullptr : &Rx;
+    for(;;)
+    {
+      const int i = mNext.fetch_add( 1, std::memory_order_relaxed );
+      if( i >= mChunks.size() )
+        return;
+      const Chunk& C = mChunks.at(i);
+      scanChunk( mFiles.at( C.mFile ), C, mFlt, pRx, mResults[i] );
+    }
+  }
+
+private:
+  const QVector<LogFile>&     mFiles;
+  const QVector<Chunk>&       mChunks;
+  const Filter&               mFlt;
+  std::atomic<int>&           mNext;
+  QVector< QVector<Match> >&  mResults;
+};
+
+
+static bool earlier( const Match& a, const Match& b )
+{
+  if( a.mpTime != b.mpTime )
+  {
+    if( !a.mpTime || !b.mpTime )
+      return !a.mpTime;
+    const int c = memcmp( a.mpTime, b.mpTime, TimeLen );
+    if( c )
+      return c < 0;
+  }
+  if( a.mFile != b.mFile )
+    return a.mFile < b.mFile;
+  return a.mOffset < b.mOffset;
+}
+
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- */
+
+// the file and its rotated backups (app.1.log, app.2026-10-18.log, ...), oldest first
+static QStringList withBackups( const QString& FileName )
+{
+  const QFileInfo fi( FileName );
+  const QString Suffix = '.' + fi.suffix();
+  const QFileInfoList Found = QDir( fi.path() ).entryInfoList( QStringList() << ( fi.completeBaseName() + ".*" + Suffix ),
+                                                               QDir::Files, QDir::Time | QDir::Reversed );
+  QStringList Names;
+  for( int i=0 ; i<Found.size() ; ++i )
+    Names << Found.at(i).filePath();
+  if( fi.exists() )
+    Names << FileName;
+  return Names;
+}
+
+
+// "2026-10-18 14:30" as msecs since epoch, Upper: the end of the minute given
+static qint64 timeBound( const QByteArray& Text, bool Upper )
+{
+  static const struct { int mLen; const char* mFormat; qint64 mUnitMs; } Formats[] =
+  { { 23, "yyyy-MM-dd HH:mm:ss,zzz", 1 }, { 19, "yyyy-MM-dd HH:mm:ss", 1000 }, { 16, "yyyy-MM-dd HH:mm", 60000 },
+    { 13, "yyyy-MM-dd HH", 3600000 },   { 10, "yyyy-MM-dd", 86400000 } };
+  for( size_t i=0 ; i<sizeof(Formats)/sizeof(Formats[0]) ; ++i )
+  {
+    if( Text.size() != Formats[i].mLen )
+      continue;
+    const QDateTime Time = QDateTime::fromString( QString::fromLatin1( Text.constData() ), Formats[i].mFormat );
+    if( Time.isValid() )
+      return Time.toMSecsSinceEpoch() + ( Upper ? Formats[i].mUnitMs - 1 : 0 );
+  }
+  return Upper ? rDebugSeekIndex::Query().mToMs : rDebugSeekIndex::Query().mFromMs;
+}
+
+
+static int parseLevel( const QString& Text )
+{
+  bool Ok = false;
+  const int Level = Text.toInt( &Ok );
+  if( Ok )
+    return qBound( 0, Level, 7 );
+  static const char* const LongNames[8] = { "emergency", "alert", "critical", "error", "warning", "notice", "informational", "debug" };
+  for( int i=0 ; i<8 ; ++i )
+    if( Text.compare( QLatin1String( LevelNames[i] ), Qt::CaseInsensitive ) == 0
+     || QString( LongNames[i] ).startsWith( Text.toLower() ) )
+      return i;
+  return -1;
+}
+
+
+static int usage()
+{
+  fprintf( stderr,
+    "usage: rdebug-grep [options] [pattern] logfile...\n"
+    "  pattern          regular expression (QRegExp), a plain word is searched as it is.\n"
+    "                   The first argument, if more than one is left, else give it by -e\n"
+    "  -e <pattern>     the pattern, all other arguments are logfiles then\n"
+    "  -F               the pattern is a plain string\n"
+    "  --level <l>      lines of this level and more severe ones: Warn, warning or 4\n"
+    "  --from <time>    \"yyyy-MM-dd HH:mm:ss,zzz\", or a leading part of it\n"
+    "  --to <time>      included, \"2026-10-18 14\" is up to 14:59:59,999\n"
+    "  --logid <n>      only lines of this LogId\n"
+    "  --no-backups     only the files given, not their rotated backups\n"
+    "  -j <n>           threads (default: cores)\n"
+    "  -H               each line with its file name\n"
+    "  -c               print the count of lines only\n" );
+  return 2;
+}
+
+
+int main( int argc, char* argv[] )
+{
+  QCoreApplication App( argc, argv );
+  const QStringList Args = App.arguments();
+
+  Filter Flt;
+  bool Fixed = false, Backups = true, WithName = false, CountOnly = false;
+  int Threads = QThread::idealThreadCount();
+  QStringList Names;
+  bool HavePattern = false;
+  for( int i=1 ; i<Args.size() ; ++i )
+  {
+    const QString& a = Args.at(i);
+    const bool HasValue = ( i+1 < Args.size() );
+    if(      a == "-F" )                  Fixed = true;
+    else if( a == "-H" )                  WithName = true;
+    else if( a == "-c" )                  CountOnly = true;
+    else if( a == "--no-backups" )        Backups = false;
+    else if( a == "-j" && HasValue )      Threads = qMax( 1, Args.at(++i).toInt() );
+    else if( a == "-e" && HasValue )      { Flt.mPattern = Args.at(++i); HavePattern = true; }
+    else if( a == "--level" && HasValue ) { Flt.mMaxLevel = parseLevel( Args.at(++i) ); Flt.mStructured = true;
+                                            if( Flt.mMaxLevel < 0 ) return usage(); }
+    else if( a == "--from" && HasValue )  { Flt.mFrom = Args.at(++i).toLatin1(); Flt.mStructured = true; }
+    else if( a == "--to" && HasValue )    { Flt.mTo = Args.at(++i).toLatin1(); Flt.mStructured = true; }
+    else if( a == "--logid" && HasValue ) { Flt.mLogId = Args.at(++i).toULongLong(); Flt.mByLogId = Flt.mStructured = true; }
+    else if( a.startsWith( '-' ) && a.size() > 1 ) return usage();
+    else                                  Names << a;
+  }
+  if( !HavePattern && Names.size() > 1 )
+    Flt.mPattern = Names.takeFirst();
+  if( Names.isEmpty() )
+    return usage();
+
+  // a pattern without any special character needs no regular expression, and is the prefilter then.
+  // Else the LogId, as it is written behind the level, prefilters
+  static const char Special[] = ".^$*+?()[]{}|\\";
+  if( !Flt.mPattern.isEmpty() && ( Fixed || strpbrk( Flt.mPattern.toUtf8().constData(), Special ) == nullptr ) )
+  { Flt.mPrefilter   = Flt.mPattern.toUtf8();
+    Flt.mLiteralOnly = true;
+  }
+  else if( Flt.mByLogId )
+  { Flt.mPrefilter  = "] ";
+    Flt.mPrefilter += QByteArray::number( Flt.mLogId );
+    Flt.mPrefilter += ' ';
+  }
+
+  rDebugSeekIndex::Query Q;
+  Q.mFromMs   = Flt.mFrom.isEmpty() ? Q.mFromMs : timeBound( Flt.mFrom, false );
+  Q.mToMs     = Flt.mTo.isEmpty()   ? Q.mToMs   : timeBound( Flt.mTo,   true );
+  Q.mMaxLevel = Flt.mMaxLevel;
+  Q.mByLogId  = Flt.mByLogId;
+  Q.mLogId    = Flt.mLogId;
+
+  // map all files, and cut the parts, the seek index leaves, into chunks
+  QVector<LogFile> Files;
+  QVector<Chunk>   Chunks;
+  for( int n=0 ; n<Names.size() ; ++n )
+  {
+    const QStringList All = Backups ? withBackups( Names.at(n) ) : QStringList( Names.at(n) );
+    for( int k=0 ; k<All.size() ; ++k )
+    {
+      LogFile File;
+      File.mName  = All.at(k);
+      File.mpFile = new QFile( File.mName );
+      File.mSize  = File.mpFile->size();
+      File.mpData = nullptr;
+      if( File.mSize > 0 && File.mpFile->open( QIODevice::ReadOnly ) )
+        File.mpData = reinterpret_cast<const char*>( File.mpFile->map( 0, File.mSize ) );
+      if( !File.mpData )
+      { if( File.mSize > 0 )
+          fprintf( stderr, "rdebug-grep: can not read %s\n", qPrintable( File.mName ) );
+        delete File.mpFile;
+        continue;
+      }
+      const QVector<rDebugSeekIndex::Range> Ranges = rDebugSeekIndex::ranges( File.mName, Q );
+      for( int r=0 ; r<Ranges.size() ; ++r )
+      {
+        for( qint64 Pos = Ranges.at(r).mBegin ; Pos < Ranges.at(r).mEnd ; Pos += ChunkSize )
+        {
+          const Chunk C = { Files.size(), Pos, qMin( Pos + ChunkSize, Ranges.at(r).mEnd ) };
+          Chunks.append( C );
+        }
+      }
+      Files.append( File );
+    }
+  }
+
+  QVector< QVector<Match> > Results( Chunks.size() );
+  std::atomic<int> Next( 0 );
+  QVector<Searcher*> Workers;
+  for( int t=0 ; t<qMin( Threads, Chunks.size() ) ; ++t )
+  {
+    Workers.append( new Searcher( Files, Chunks, Flt, Next, Results ) );
+    Workers.last()->start();
+  }
+  for( int t=0 ; t<Workers.size() ; ++t )
+  {
+    Workers.at(t)->wait();
+    delete Workers.at(t);
+  }
+
+  QVector<Match> Found;
+  for( int i=0 ; i<Results.size() ; ++i )
+    for( int m=0 ; m<Results.at(i).size() ; ++m )
+      Found.append( Results.at(i).at(m) );
+  std::stable_sort( Found.begin(), Found.end(), earlier );
+
+  if( CountOnly )
+  {
+    printf( "%d\n", Found.size() );
+  }
+  else
+  {
+    for( int i=0 ; i<Found.size() ; ++i )
+    {
+      const Match& M = Found.at(i);
+      if( WithName )
+      { const QByteArray Name = Files.at( M.mFile ).mName.toLocal8Bit();
+        fwrite( Name.constData(), 1, static_cast<size_t>( Name.size() ), stdout );
+        fputc( ':', stdout );
+      }
+      fwrite( M.mpLine, 1, static_cast<size_t>( M.mLen ), stdout );
+      fputc( '\n', stdout );
+    }
+  }
+  fflush( stdout );
+
+  for( int i=0 ; i<Files.size() ; ++i )
+    delete Files.at(i).mpFile; // unmaps
+  return Found.isEmpty() ? 1 : 0;
+}
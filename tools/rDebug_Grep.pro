@@ -0,0 +1,18 @@
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = rdebug-grep
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which as been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += rDebug_Grep.cpp \
+    ../src/rDebugSeekIndex.cpp
+
+HEADERS += \
+    ../src/rDebugSeekIndex.h